@@ -0,0 +1,396 @@
+#pragma once
+// Std. Includes
+#include <vector> // Include vector
+#include <thread> // Include thread
+#include <cstring> // Include cstring for memset
+#include <cstdint> // Include fixed width integer types
+#include <cmath> // Include sqrt
+#include <algorithm> // Include min/max
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+
+// CPU encoders for the GPU block-compressed formats used by bake_textures.cpp.
+// Every format stores 4x4 pixel blocks:
+//   BC1 (8 bytes)  - two RGB565 endpoints, 2-bit indices. Opaque color maps.
+//   BC4 (8 bytes)  - two 8-bit endpoints, 3-bit indices. Single-channel maps (height).
+//   BC5 (16 bytes) - two BC4 blocks for red and green. Two-channel maps (normal XY).
+//   BC7 (16 bytes) - mode 6 only: RGBA 7.7.7.7 endpoints plus a p-bit, 4-bit indices. Higher quality color.
+// Endpoints come from the principal axis of the block's colors; BC1 refines them once with a least-squares fit.
+// Images are split into rows of blocks and encoded on every core.
+
+enum BlockFormat {
+	BLOCK_BC1, // GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+	BLOCK_BC4, // GL_COMPRESSED_RED_RGTC1
+	BLOCK_BC5, // GL_COMPRESSED_RG_RGTC2
+	BLOCK_BC7 // GL_COMPRESSED_RGBA_BPTC_UNORM_ARB
+};
+
+// GL internal format of a block format
+inline GLenum BlockFormatInternal(BlockFormat format)
+{
+	switch (format) {
+	case BLOCK_BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BLOCK_BC4: return GL_COMPRESSED_RED_RGTC1;
+	case BLOCK_BC5: return GL_COMPRESSED_RG_RGTC2;
+	case BLOCK_BC7: return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;
+	}
+	return 0;
+}
+
+// GL base format of a block format (what the shader sees)
+inline GLenum BlockFormatBase(BlockFormat format)
+{
+	switch (format) {
+	case BLOCK_BC1: return GL_RGB;
+	case BLOCK_BC4: return GL_RED;
+	case BLOCK_BC5: return GL_RG;
+	case BLOCK_BC7: return GL_RGBA;
+	}
+	return 0;
+}
+
+// Bytes per 4x4 block
+inline int BlockFormatBytes(BlockFormat format)
+{
+	return (format == BLOCK_BC1 || format == BLOCK_BC4) ? 8 : 16;
+}
+
+// Principal axis of count points with the given number of channels, starting from the bounding box diagonal.
+// Writes the mean and the (unnormalized) axis; a flat block returns a zero axis.
+inline void BlockPrincipalAxis(const float (*points)[4], int count, int channels, float mean[4], float axis[4])
+{
+	float low[4] = { 255, 255, 255, 255 }, high[4] = { 0, 0, 0, 0 }; // Bounding box
+	for (int c = 0; c < 4; c++)
+		mean[c] = 0.0f;
+	for (int i = 0; i < count; i++)
+		for (int c = 0; c < channels; c++) {
+			mean[c] += points[i][c] / count;
+			low[c] = min(low[c], points[i][c]);
+			high[c] = max(high[c], points[i][c]);
+		}
+	float covariance[4][4]; // Symmetric covariance matrix
+	memset(covariance, 0, sizeof(covariance));
+	for (int i = 0; i < count; i++)
+		for (int a = 0; a < channels; a++)
+			for (int b = 0; b < channels; b++)
+				covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+	for (int c = 0; c < 4; c++)
+		axis[c] = (c < channels) ? high[c] - low[c] : 0.0f; // Diagonal is a good first guess
+	for (int iteration = 0; iteration < 8; iteration++) // Power iteration converges quickly for 4x4 blocks
+	{
+		float next[4] = { 0, 0, 0, 0 }, length = 0.0f; // Covariance * axis
+		for (int a = 0; a < channels; a++) {
+			for (int b = 0; b < channels; b++)
+				next[a] += covariance[a][b] * axis[b];
+			length = max(length, fabs(next[a]));
+		}
+		if (length < 1e-6f) // Flat (or single color) block: keep the diagonal
+			break;
+		for (int c = 0; c < channels; c++)
+			axis[c] = next[c] / length;
+	}
+}
+
+// Projects the points on the axis and returns the two extremes as endpoints
+inline void BlockAxisEndpoints(const float (*points)[4], int count, int channels, const float mean[4], const float axis[4], float start[4], float end[4])
+{
+	float lowest = 0.0f, highest = 0.0f; // Projection range
+	for (int i = 0; i < count; i++) {
+		float t = 0.0f; // Projection of point i
+		for (int c = 0; c < channels; c++)
+			t += (points[i][c] - mean[c]) * axis[c];
+		lowest = min(lowest, t);
+		highest = max(highest, t);
+	}
+	float lengthSquared = 0.0f; // |axis|^2
+	for (int c = 0; c < channels; c++)
+		lengthSquared += axis[c] * axis[c];
+	if (lengthSquared > 0.0f) {
+		lowest /= lengthSquared;
+		highest /= lengthSquared;
+	}
+	for (int c = 0; c < 4; c++) {
+		start[c] = min(max(mean[c] + axis[c] * lowest, 0.0f), 255.0f);
+		end[c] = min(max(mean[c] + axis[c] * highest, 0.0f), 255.0f);
+	}
+}
+
+// Packs an RGB color (0-255 floats) into RGB565
+inline uint16_t BlockPack565(const float color[4])
+{
+	int r = (int)(color[0] * 31.0f / 255.0f + 0.5f), g = (int)(color[1] * 63.0f / 255.0f + 0.5f), b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (uint16_t)((min(max(r, 0), 31) << 11) | (min(max(g, 0), 63) << 5) | min(max(b, 0), 31));
+}
+
+// Expands RGB565 to 8 bits per channel, the way the hardware does
+inline void BlockUnpack565(uint16_t packed, int color[3])
+{
+	int r = (packed >> 11) & 31, g = (packed >> 5) & 63, b = packed & 31;
+	color[0] = (r << 3) | (r >> 2);
+	color[1] = (g << 2) | (g >> 4);
+	color[2] = (b << 3) | (b >> 2);
+}
+
+// Picks the nearest of the four BC1 palette colors for every pixel, returns the squared error
+inline int BlockBC1Indices(const float (*pixels)[4], uint16_t color0, uint16_t color1, uint32_t& indices)
+{
+	int palette[4][3]; // Decoded palette (4-color mode, color0 > color1)
+	BlockUnpack565(color0, palette[0]);
+	BlockUnpack565(color1, palette[1]);
+	for (int c = 0; c < 3; c++) {
+		palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+		palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+	}
+	int total = 0; // Block error
+	indices = 0;
+	for (int i = 0; i < 16; i++)
+	{
+		int best = 0, bestError = 1 << 30; // Nearest palette entry
+		for (int p = 0; p < 4; p++) {
+			int error = 0;
+			for (int c = 0; c < 3; c++) {
+				int d = (int)pixels[i][c] - palette[p][c];
+				error += d * d;
+			}
+			if (error < bestError) {
+				bestError = error;
+				best = p;
+			}
+		}
+		indices |= (uint32_t)best << (2 * i);
+		total += bestError;
+	}
+	return total;
+}
+
+// Encodes one BC1 block from 16 RGB pixels (row-major, alpha ignored)
+inline void EncodeBC1Block(const float (*pixels)[4], unsigned char* out)
+{
+	float mean[4], axis[4], start[4], end[4]; // Endpoint search
+	BlockPrincipalAxis(pixels, 16, 3, mean, axis);
+	BlockAxisEndpoints(pixels, 16, 3, mean, axis, start, end);
+	uint16_t color0 = BlockPack565(end), color1 = BlockPack565(start); // Endpoints
+	if (color0 < color1)
+		swap(color0, color1); // color0 > color1 selects the 4-color mode
+	uint32_t indices = 0; // 2 bits per pixel
+	if (color0 == color1) { // Flat block: every pixel uses color0
+		memcpy(out, &color0, 2);
+		memcpy(out + 2, &color1, 2);
+		memcpy(out + 4, &indices, 4);
+		return;
+	}
+	int error = BlockBC1Indices(pixels, color0, color1, indices); // Error of the axis fit
+
+	// Least-squares refit of both endpoints for the chosen indices (weights of color0: 1, 0, 2/3, 1/3)
+	const float weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	float aa = 0, ab = 0, bb = 0, ax[3] = { 0, 0, 0 }, bx[3] = { 0, 0, 0 }; // Normal equations
+	for (int i = 0; i < 16; i++) {
+		float a = weights[(indices >> (2 * i)) & 3], b = 1.0f - a; // Weight of color0 / color1
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (int c = 0; c < 3; c++) {
+			ax[c] += a * pixels[i][c];
+			bx[c] += b * pixels[i][c];
+		}
+	}
+	float determinant = aa * bb - ab * ab; // Singular when every pixel picked the same weight
+	if (fabs(determinant) > 1e-6f) {
+		float fitted0[4] = { 0, 0, 0, 0 }, fitted1[4] = { 0, 0, 0, 0 }; // Refined endpoints
+		for (int c = 0; c < 3; c++) {
+			fitted0[c] = min(max((ax[c] * bb - bx[c] * ab) / determinant, 0.0f), 255.0f);
+			fitted1[c] = min(max((bx[c] * aa - ax[c] * ab) / determinant, 0.0f), 255.0f);
+		}
+		uint16_t refit0 = BlockPack565(fitted0), refit1 = BlockPack565(fitted1); // Quantized refit
+		if (refit0 < refit1)
+			swap(refit0, refit1);
+		uint32_t refitIndices = 0; // Indices for the refit
+		if (refit0 != refit1 && BlockBC1Indices(pixels, refit0, refit1, refitIndices) < error) { // Keep whichever is better
+			color0 = refit0;
+			color1 = refit1;
+			indices = refitIndices;
+		}
+	}
+	memcpy(out, &color0, 2); // Little-endian endpoints, then indices
+	memcpy(out + 2, &color1, 2);
+	memcpy(out + 4, &indices, 4);
+}
+
+// Encodes one BC4 block from 16 single-channel values (channel picks which component of the pixels to use)
+inline void EncodeBC4Block(const float (*pixels)[4], int channel, unsigned char* out)
+{
+	int low = 255, high = 0; // Value range
+	for (int i = 0; i < 16; i++) {
+		int value = (int)(pixels[i][channel] + 0.5f);
+		low = min(low, value);
+		high = max(high, value);
+	}
+	int palette[8] = { high, low, 0, 0, 0, 0, 0, 0 }; // 8-value mode (red0 > red1)
+	for (int p = 2; p < 8; p++)
+		palette[p] = ((8 - p) * high + (p - 1) * low) / 7;
+	uint64_t bits = 0; // 3-bit indices
+	if (high > low)
+		for (int i = 0; i < 16; i++)
+		{
+			int best = 0, bestError = 1 << 30; // Nearest palette entry
+			for (int p = 0; p < 8; p++) {
+				int error = abs((int)(pixels[i][channel] + 0.5f) - palette[p]);
+				if (error < bestError) {
+					bestError = error;
+					best = p;
+				}
+			}
+			bits |= (uint64_t)best << (3 * i);
+		}
+	out[0] = (unsigned char)high; // Flat blocks keep every index at 0 (red0)
+	out[1] = (unsigned char)low;
+	for (int i = 0; i < 6; i++)
+		out[2 + i] = (unsigned char)(bits >> (8 * i));
+}
+
+// Encodes one BC5 block: red then green, each as a BC4 block
+inline void EncodeBC5Block(const float (*pixels)[4], unsigned char* out)
+{
+	EncodeBC4Block(pixels, 0, out);
+	EncodeBC4Block(pixels, 1, out + 8);
+}
+
+// Appends count bits of value to a 128-bit BC7 block, LSB first
+inline void BlockWriteBits(unsigned char* out, int& position, uint32_t value, int count)
+{
+	for (int i = 0; i < count; i++, position++)
+		if (value & (1u << i))
+			out[position >> 3] |= (unsigned char)(1 << (position & 7));
+}
+
+// Encodes one BC7 mode 6 block from 16 RGBA pixels
+inline void EncodeBC7Block(const float (*pixels)[4], unsigned char* out)
+{
+	static const int weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 }; // 4-bit interpolation weights
+	float mean[4], axis[4], start[4], end[4]; // Endpoint search
+	BlockPrincipalAxis(pixels, 16, 4, mean, axis);
+	BlockAxisEndpoints(pixels, 16, 4, mean, axis, start, end);
+
+	// Quantize each endpoint to 7 bits per channel plus a shared p-bit, picking the p-bit with the smaller error
+	int quantized[2][4], pbit[2], endpoint[2][4]; // 7-bit values, p-bits and the 8-bit colors they decode to
+	const float* source[2] = { start, end };
+	for (int e = 0; e < 2; e++)
+	{
+		float bestError = 1e30f; // Error of the best p-bit
+		for (int p = 0; p < 2; p++) {
+			int q[4]; // Candidate 7-bit values
+			float error = 0.0f;
+			for (int c = 0; c < 4; c++) {
+				q[c] = min(max((int)((source[e][c] - p) / 2.0f + 0.5f), 0), 127);
+				float d = source[e][c] - (float)((q[c] << 1) | p);
+				error += d * d;
+			}
+			if (error < bestError) {
+				bestError = error;
+				pbit[e] = p;
+				memcpy(quantized[e], q, sizeof(q));
+			}
+		}
+		for (int c = 0; c < 4; c++)
+			endpoint[e][c] = (quantized[e][c] << 1) | pbit[e];
+	}
+
+	int indices[16]; // Nearest of the 16 interpolated colors
+	for (int i = 0; i < 16; i++)
+	{
+		int bestError = 1 << 30;
+		for (int w = 0; w < 16; w++) {
+			int error = 0;
+			for (int c = 0; c < 4; c++) {
+				int value = ((64 - weights[w]) * endpoint[0][c] + weights[w] * endpoint[1][c] + 32) >> 6;
+				int d = (int)(pixels[i][c] + 0.5f) - value;
+				error += d * d;
+			}
+			if (error < bestError) {
+				bestError = error;
+				indices[i] = w;
+			}
+		}
+	}
+	if (indices[0] >= 8) { // The anchor index drops its top bit: swap the endpoints so pixel 0 uses the low half
+		swap(quantized[0], quantized[1]);
+		swap(pbit[0], pbit[1]);
+		for (int i = 0; i < 16; i++)
+			indices[i] = 15 - indices[i];
+	}
+
+	memset(out, 0, 16);
+	int position = 0; // Bit cursor
+	BlockWriteBits(out, position, 1u << 6, 7); // Mode 6
+	for (int c = 0; c < 4; c++) { // R0 R1 G0 G1 B0 B1 A0 A1
+		BlockWriteBits(out, position, quantized[0][c], 7);
+		BlockWriteBits(out, position, quantized[1][c], 7);
+	}
+	BlockWriteBits(out, position, pbit[0], 1);
+	BlockWriteBits(out, position, pbit[1], 1);
+	BlockWriteBits(out, position, indices[0], 3); // Anchor
+	for (int i = 1; i < 16; i++)
+		BlockWriteBits(out, position, indices[i], 4);
+}
+
+// Compresses an 8-bit image with 1 to 4 channels (row-major, rows in the order they should be stored).
+// Missing channels read as 0, missing alpha as 255. Edge blocks repeat the last row/column.
+inline vector<unsigned char> CompressImage(const unsigned char* pixels, int width, int height, int channels, BlockFormat format)
+{
+	int blocksWide = (width + 3) / 4, blocksHigh = (height + 3) / 4; // Block grid
+	int blockBytes = BlockFormatBytes(format); // Output per block
+	vector<unsigned char> out((size_t)blocksWide * blocksHigh * blockBytes); // Compressed image
+
+	// Encodes block rows [firstRow, lastRow)
+	auto encodeRows = [&](int firstRow, int lastRow) {
+		float block[16][4]; // Gathered pixels
+		for (int by = firstRow; by < lastRow; by++)
+			for (int bx = 0; bx < blocksWide; bx++)
+			{
+				for (int i = 0; i < 16; i++) {
+					int x = min(bx * 4 + (i & 3), width - 1), y = min(by * 4 + (i >> 2), height - 1); // Clamp at the edges
+					const unsigned char* pixel = pixels + ((size_t)y * width + x) * channels; // Source pixel
+					for (int c = 0; c < 4; c++)
+						block[i][c] = (c < channels) ? pixel[c] : (c == 3 ? 255.0f : 0.0f);
+				}
+				unsigned char* target = &out[((size_t)by * blocksWide + bx) * blockBytes]; // Destination block
+				switch (format) {
+				case BLOCK_BC1: EncodeBC1Block(block, target); break;
+				case BLOCK_BC4: EncodeBC4Block(block, 0, target); break;
+				case BLOCK_BC5: EncodeBC5Block(block, target); break;
+				case BLOCK_BC7: EncodeBC7Block(block, target); break;
+				}
+			}
+	};
+
+	unsigned count = thread::hardware_concurrency(); // Core count
+	if (count == 0)
+		count = 4; // Unknown: pick a sensible default
+	count = min(count, (unsigned)blocksHigh); // Small mips do not need every core
+	vector<thread> workers; // One slice of block rows each
+	for (unsigned t = 0; t < count; t++)
+		workers.push_back(thread(encodeRows, (int)(t * blocksHigh / count), (int)((t + 1) * blocksHigh / count)));
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+	return out;
+}
+
+// Halves an image with a 2x2 box filter (odd sizes repeat the last row/column), for the next mip level
+inline vector<unsigned char> DownsampleImage(const vector<unsigned char>& pixels, int width, int height, int channels)
+{
+	int halfWidth = max(width / 2, 1), halfHeight = max(height / 2, 1); // Next level size
+	vector<unsigned char> out((size_t)halfWidth * halfHeight * channels); // Next level
+	for (int y = 0; y < halfHeight; y++)
+		for (int x = 0; x < halfWidth; x++)
+		{
+			int x0 = min(2 * x, width - 1), x1 = min(2 * x + 1, width - 1); // Source columns
+			int y0 = min(2 * y, height - 1), y1 = min(2 * y + 1, height - 1); // Source rows
+			for (int c = 0; c < channels; c++) {
+				int sum = pixels[((size_t)y0 * width + x0) * channels + c] + pixels[((size_t)y0 * width + x1) * channels + c] +
+					pixels[((size_t)y1 * width + x0) * channels + c] + pixels[((size_t)y1 * width + x1) * channels + c];
+				out[((size_t)y * halfWidth + x) * channels + c] = (unsigned char)((sum + 2) / 4);
+			}
+		}
+	return out;
+}
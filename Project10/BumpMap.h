@@ -0,0 +1,103 @@
+#pragma once
+// Std. Includes
+#include <vector> // Include vector
+#include <thread> // Include thread
+#include <algorithm> // Include min/max
+#include <cmath> // Include sqrt
+using namespace std; // Use namespace std
+// SIMD Includes
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 intrinsics
+#define BUMP_MAP_SSE 1
+#endif
+
+// Converts a single-channel height map into a bump map the shaders read with one fetch:
+//   R, G - tangent-space normal X and Y (mapped from [-1, 1] to [0, 255]), Z is rebuilt in the shader
+//   B    - the original height
+// Normals come from a 3x3 Sobel filter, wrapping at the edges like the GL_REPEAT sampler did.
+// Rows are split across threads and each row is filtered four pixels at a time with SSE.
+
+const float BUMP_MAP_SCALE = 5.0f; // Height derivative scale, the bumpScale the shaders used per fragment
+const int BUMP_MAP_MIN_ROWS_PER_THREAD = 64; // Below this per thread, threading costs more than it saves
+
+// Writes the encoded normal and height of one pixel. Same operations, in the same order, as the SSE lanes in
+// BumpMapRows (round half up), so a pixel encodes identically whichever path handles its column.
+inline void BumpMapPixel(float dHdU, float dHdV, unsigned char height, unsigned char* out)
+{
+	float inverseLength = 1.0f / sqrt(dHdU * dHdU + dHdV * dHdV + 1.0f); // 1 / length of (-dHdU, -dHdV, 1)
+	const float half = 127.5f; // Maps [-1, 1] to [0, 255]
+	out[0] = (unsigned char)(int)((half - dHdU * inverseLength * half) + 0.5f);
+	out[1] = (unsigned char)(int)((half - dHdV * inverseLength * half) + 0.5f);
+	out[2] = height;
+}
+
+// Filters rows [firstRow, lastRow). Row y + 1 is "up" (+V), the order the image is uploaded in.
+inline void BumpMapRows(const unsigned char* heights, int width, int height, unsigned char* out, int firstRow, int lastRow)
+{
+	// Sobel sums are 4x the central difference; heights are 0-255
+	const float scale = BUMP_MAP_SCALE / (4.0f * 255.0f);
+	vector<float> padded[3]; // Rows y - 1, y, y + 1 as floats with one wrapped pixel on each side
+	for (int i = 0; i < 3; i++)
+		padded[i].resize(width + 2);
+	for (int y = firstRow; y < lastRow; y++)
+	{
+		for (int i = 0; i < 3; i++) {
+			const unsigned char* row = heights + (size_t)((y + i - 1 + height) % height) * width; // Wrapped source row
+			float* dst = padded[i].data(); // Padded copy
+			for (int x = 0; x < width; x++)
+				dst[x + 1] = row[x];
+			dst[0] = row[width - 1]; // Wrap left
+			dst[width + 1] = row[0]; // Wrap right
+		}
+		const float* down = padded[0].data(); // Row y - 1
+		const float* center = padded[1].data(); // Row y
+		const float* up = padded[2].data(); // Row y + 1
+		unsigned char* dst = out + (size_t)y * width * 3; // Output row
+		int x = 0; // Pixel cursor
+#ifdef BUMP_MAP_SSE
+		const __m128 two = _mm_set1_ps(2.0f), vscale = _mm_set1_ps(scale); // Constants
+		for (; x + 4 <= width; x += 4) // Four pixels at a time; padded index x + 1 is pixel x
+		{
+			__m128 left = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(down + x), _mm_loadu_ps(up + x)), _mm_mul_ps(two, _mm_loadu_ps(center + x))); // Column x - 1
+			__m128 right = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(down + x + 2), _mm_loadu_ps(up + x + 2)), _mm_mul_ps(two, _mm_loadu_ps(center + x + 2))); // Column x + 1
+			__m128 above = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(up + x), _mm_loadu_ps(up + x + 2)), _mm_mul_ps(two, _mm_loadu_ps(up + x + 1))); // Row y + 1
+			__m128 below = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(down + x), _mm_loadu_ps(down + x + 2)), _mm_mul_ps(two, _mm_loadu_ps(down + x + 1))); // Row y - 1
+			__m128 dHdU = _mm_mul_ps(_mm_sub_ps(right, left), vscale); // Height derivative along U
+			__m128 dHdV = _mm_mul_ps(_mm_sub_ps(above, below), vscale); // Height derivative along V
+			__m128 inverseLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dHdU, dHdU), _mm_mul_ps(dHdV, dHdV)), _mm_set1_ps(1.0f))));
+			__m128 half = _mm_set1_ps(127.5f), rounding = _mm_set1_ps(0.5f); // Maps [-1, 1] to [0, 255]; round half up like BumpMapPixel
+			__m128i nx = _mm_cvttps_epi32(_mm_add_ps(_mm_sub_ps(half, _mm_mul_ps(_mm_mul_ps(dHdU, inverseLength), half)), rounding)); // Rounded X
+			__m128i ny = _mm_cvttps_epi32(_mm_add_ps(_mm_sub_ps(half, _mm_mul_ps(_mm_mul_ps(dHdV, inverseLength), half)), rounding)); // Rounded Y
+			alignas(16) int xs[4], ys[4]; // Lanes for the interleaved store
+			_mm_store_si128((__m128i*)xs, nx);
+			_mm_store_si128((__m128i*)ys, ny);
+			for (int i = 0; i < 4; i++) {
+				dst[(x + i) * 3 + 0] = (unsigned char)xs[i];
+				dst[(x + i) * 3 + 1] = (unsigned char)ys[i];
+				dst[(x + i) * 3 + 2] = (unsigned char)center[x + i + 1];
+			}
+		}
+#endif
+		for (; x < width; x++) // Remainder (or everything without SSE)
+		{
+			float left = down[x] + 2.0f * center[x] + up[x], right = down[x + 2] + 2.0f * center[x + 2] + up[x + 2]; // Columns x -/+ 1
+			float above = up[x] + 2.0f * up[x + 1] + up[x + 2], below = down[x] + 2.0f * down[x + 1] + down[x + 2]; // Rows y +/- 1
+			BumpMapPixel((right - left) * scale, (above - below) * scale, (unsigned char)center[x + 1], dst + x * 3);
+		}
+	}
+}
+
+// Builds the RGB bump map of a width x height height map into out (width * height * 3 bytes)
+inline void BuildBumpMap(const unsigned char* heights, int width, int height, unsigned char* out)
+{
+	unsigned count = thread::hardware_concurrency(); // Core count
+	if (count == 0)
+		count = 4; // Unknown: pick a sensible default
+	count = max(1u, min(count, (unsigned)(height / BUMP_MAP_MIN_ROWS_PER_THREAD))); // Small maps stay on this thread
+	vector<thread> workers; // One slice of rows each (the first runs here)
+	for (unsigned t = 1; t < count; t++)
+		workers.push_back(thread(BumpMapRows, heights, width, height, out, (int)(t * height / count), (int)((t + 1) * height / count)));
+	BumpMapRows(heights, width, height, out, 0, (int)(height / count));
+	for (size_t t = 0; t < workers.size(); t++)
+		workers[t].join();
+}
@@ -1,143 +1,388 @@
-#ifndef CAMERA_H
-#define CAMERA_H
-
-#include <GL/glew.h> // Glew include
-#include <glm/glm.hpp> // GLM include
-#include <glm/gtc/matrix_transform.hpp> // Matrix transform include
-
-#include <vector> // Include vector
-
-// Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
-enum Camera_Movement {
-	FORWARD, // Allow forward camera movement [z]
-	BACKWARD, // Allow backward camera movement [z]
-	LEFT, // Move along x-axis
-	RIGHT, // Move along x-axis
-	UP, // Move along y-axis
-	DOWN, // Move along y-axis
-	UPPITCH, // Rotate pitch positive
-	DOWNPITCH, // Rotate pitch negative
-	UPYAW, // Rotate yaw positive
-	DOWNYAW, // Rotate yaw negative
-	UPROLL, // Rotate roll positive
-	DOWNROLL // Rotate roll negative
-};
-
-// Default camera values
-const float YAW = -90.0f; // Initialize yaw [flip screen to normal]
-const float PITCH = 0.0f; // Initailize pitch
-const float ROLL = 0.0f; // Initialize roll
-const float SPEED = 2.5f; // Initialize speed
-
-
-// An abstract camera class that processes input and calculates the corresponding Euler Angles, Vectors and Matrices for use in OpenGL
-class Camera
-{
-public:
-	// Camera Attributes
-	glm::vec3 Position; // Position vector
-	glm::vec3 Front; // Front dir vector
-	glm::vec3 Up; // Up dir vector
-	glm::vec3 Right; // Right dir vector
-	glm::vec3 WorldUp; // WorldUp vector
-	// Euler Angles
-	float Yaw; // yaw
-	float Pitch; // pitch
-	float Roll; // roll
-	// Camera options
-	float MovementSpeed; // speed for translation
-
-	// Constructor with vectors
-	Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH, float roll = ROLL) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED)
-	{
-		Position = position; // Set position based on input
-		WorldUp = up; // Set up reference based on input
-		Yaw = yaw; // Set yaw based on input
-		Pitch = pitch; // Set pitch based on input
-		Roll = roll; // Set roll based on input
-		updateCameraVectors(); // Call class method to set front, right, and up vectors
-	}
-	// Constructor with scalar values
-	Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch, float roll) : Front(glm::vec3(0.0f, 0.0f, -1.0f)), MovementSpeed(SPEED)
-	{
-		Position = glm::vec3(posX, posY, posZ); // Set position elements manually from input
-		WorldUp = glm::vec3(upX, upY, upZ); // Set WorldUp elements manually from input
-		Yaw = yaw; // Set yaw based on input
-		Pitch = pitch; // Set pitch based on input
-		Roll = roll; // Set roll based on input
-		updateCameraVectors(); // Call class method to set front, right, and up vectors
-	}
-
-	// Returns the view matrix calculated using Euler Angles and the LookAt Matrix
-	glm::mat4 GetViewMatrix()
-	{
-		return glm::lookAt(Position, Position + Front, Up); // Returns lookAt output using Posiiton, Position + Front, and Up
-	}
-
-	// Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
-	void ProcessKeyboard(Camera_Movement direction, float deltaTime)
-	{
-		// Defines all directions
-		float velocity = MovementSpeed * deltaTime; // Calculate velocity using speed and time
-		if (direction == FORWARD) // If forward direction
-			Position += Front * velocity; // Add front * velocity to position
-		if (direction == BACKWARD) // If backward
-			Position -= Front * velocity; // Subtract front * velocity from position
-		if (direction == LEFT) // If left
-			Position -= Right * velocity; // Subtract Right * velocity from position
-		if (direction == RIGHT) // If right
-			Position += Right * velocity; // Add right * velocity to position
-		if (direction == UP) // If up
-			Position += Up * velocity; // Add up * velocity to position
-		if (direction == DOWN) // If down
-			Position -= Up * velocity; // Subtract up * velocity to position
-		if (direction == UPPITCH) // If up pitch
-			Pitch += 2.0f; // Increment pitch by 2 [degrees]
-			updateCameraVectors(); // Update rotation using callback
-		if (direction == DOWNPITCH) // If down pitch
-			Pitch -= 2.0f; // Decrement pitch by 2 [degrees]
-			updateCameraVectors(); // Update rotation using callback
-		if (direction == UPYAW) // If up yaw
-			Yaw += 2.0f; // Increment yaw by 2 [degrees]
-			updateCameraVectors(); // Update rotation using callback
-		if (direction == DOWNYAW) // If down yaw
-			Yaw -= 2.0f; // Decrement yaw by 2 [degrees]
-			updateCameraVectors(); // Update rotation using callback
-		if (direction == UPROLL) // If up roll
-			Roll += 2.0f; // Increment roll by 2 [degrees]
-			updateCameraVectors(); // Update rotation using callback
-		if (direction == DOWNROLL) // If down roll
-			Roll -= 2.0f; // Decrement roll by 2 [degrees]
-			updateCameraVectors(); // Update rotation using callback
-	}
-
-	// Resets camera position and rotation vectors
-	void ResetCamera() {
-		Position = glm::vec3(0.0f, 0.0f, 0.0f); // Resets position
-		WorldUp = glm::vec3(0.0f, 1.0f, 0.0f); // Resets worldup vector
-		Yaw = YAW; // Resets yaw
-		Pitch = PITCH; // Resets pitch
-		Roll = ROLL; // Resets roll
-		updateCameraVectors(); // Updates rotation with reset values using callback
-	}
-
-private:
-	// Calculates the front vector from the Camera's (updated) Euler Angles
-	void updateCameraVectors()
-	{
-		// Calculate the new Front vector
-		glm::vec3 front; // Initialize front
-		front.x = cos(glm::radians(Yaw)) * cos(glm::radians(Pitch)); // Define x value for front using cos(Yaw) * cos(Pitch)
-		front.y = sin(glm::radians(Pitch));// Define y value for front using sin(pitch)
-		front.z = sin(glm::radians(Yaw)) * cos(glm::radians(Pitch)); // Define z value for front using sin(Yaw) * cos(Pitch)
-		Front = glm::normalize(front); // Normalize vector
-		// // Also re-calculate the Right and Up vector --> normalize right and up and cross product with Front
-		Right = glm::normalize(glm::cross(Front, WorldUp));  // Normalize the vectors, because their length gets closer to 0 the more you look up or down which results in slower movement.
-		Up = glm::normalize(glm::cross(Right, Front)); // Normalize the cross product of Right and Front
-		Up.x = sin(glm::radians(Roll)); // Set x of Up to sin(Roll)
-		Up.y = cos(glm::radians(Roll)); // Set y of Up to cos(Roll)
-		Up = glm::normalize(Up); // Normalize new Up
-		Right = glm::normalize(glm::cross(Front, Up)); // Reset Right to reflect new Up axis vector
-	}
-};
-#endif
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <GL/glew.h> // Glew include
+#include <glm/glm.hpp> // GLM include
+#include <glm/gtc/matrix_transform.hpp> // Matrix transform include
+#include <glm/gtc/quaternion.hpp> // Quaternion include
+
+#include <vector> // Include vector
+#include <string> // Include string
+#include <fstream> // Include file streams
+#include <iostream> // Include cout
+#include <algorithm> // Include upper_bound/min
+
+#include "Frustum.h" // Include frustum planes
+
+// Defines several possible options for camera movement. Used as abstraction to stay away from window-system specific input methods
+enum Camera_Movement {
+	FORWARD, // Allow forward camera movement [z]
+	BACKWARD, // Allow backward camera movement [z]
+	LEFT, // Move along x-axis
+	RIGHT, // Move along x-axis
+	UP, // Move along y-axis
+	DOWN, // Move along y-axis
+	UPPITCH, // Rotate pitch positive
+	DOWNPITCH, // Rotate pitch negative
+	UPYAW, // Rotate yaw positive
+	DOWNYAW, // Rotate yaw negative
+	UPROLL, // Rotate roll positive
+	DOWNROLL // Rotate roll negative
+};
+
+// Keys the camera reacts to, one bit each in a key state (see Camera::Step). Window-system independent like
+// Camera_Movement, so key states can be recorded and replayed.
+enum Camera_Key {
+	CAMERA_KEY_LEFT = 1 << 0, // Left arrow
+	CAMERA_KEY_RIGHT = 1 << 1, // Right arrow
+	CAMERA_KEY_UP = 1 << 2, // Up arrow
+	CAMERA_KEY_DOWN = 1 << 3, // Down arrow
+	CAMERA_KEY_SHIFT = 1 << 4, // Either shift key
+	CAMERA_KEY_CONTROL = 1 << 5, // Either control key
+	CAMERA_KEY_COMMA = 1 << 6, // Comma (roll up with shift)
+	CAMERA_KEY_PERIOD = 1 << 7, // Period (roll down with shift)
+	CAMERA_KEY_RESET = 1 << 8 // R
+};
+
+// Default camera values
+const float YAW = -90.0f; // Initialize yaw [flip screen to normal]
+const float PITCH = 0.0f; // Initailize pitch
+const float ROLL = 0.0f; // Initialize roll
+const float SPEED = 2.5f; // Initialize speed
+const float CAMERA_TICK_RATE = 60.0f; // Fixed simulation steps per second (see CameraSimulation)
+const float CAMERA_TICK = 1.0f / CAMERA_TICK_RATE; // Seconds per step
+const float CAMERA_MAX_FRAME_TIME = 0.25f; // Longest frame simulated in full; a longer stall drops the excess time
+const float CAMERA_TURN_STEP = 2.0f; // Degrees per pitch/yaw/roll input
+const float CAMERA_FOVY = 45.0f; // Passed to glm::perspective as is: 45 radians, about 58 degrees vertically (the project's framing)
+const float CAMERA_NEAR = 0.1f; // Default near plane
+const float CAMERA_FAR = 100.0f; // Default far plane
+
+
+// A camera with a quaternion orientation. Every rotation input turns the camera about one of its own axes, so
+// pitch, yaw and roll compose the same way at any attitude (no gimbal lock near +-90 degrees pitch) and no
+// trig runs per input. The quaternion is renormalized after each turn, and Front/Right/Up are read straight from
+// it. The view matrix is written from that basis, and view, view-projection and frustum planes are cached until
+// the position, orientation or projection changes.
+class Camera
+{
+public:
+	// Camera Attributes
+	glm::vec3 Position; // Position vector (may be set directly, the cached matrices notice)
+	glm::vec3 Front; // Front dir vector (from Orientation, read only)
+	glm::vec3 Up; // Up dir vector (from Orientation, read only)
+	glm::vec3 Right; // Right dir vector (from Orientation, read only)
+	glm::vec3 WorldUp; // WorldUp vector (axis of the starting yaw)
+	glm::quat Orientation; // Rotation from camera space (looking down -z, y up) to world space
+	// Camera options
+	float MovementSpeed; // speed for translation
+
+	// Constructor with vectors
+	Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH, float roll = ROLL) : MovementSpeed(SPEED)
+	{
+		Position = position; // Set position based on input
+		WorldUp = up; // Set up reference based on input
+		SetOrientation(orientationFromAngles(yaw, pitch, roll)); // Starting attitude from the Euler angles
+		SetPerspective(CAMERA_FOVY, 4.0f / 3.0f, CAMERA_NEAR, CAMERA_FAR); // Until the renderer sets its own
+	}
+	// Constructor with scalar values
+	Camera(float posX, float posY, float posZ, float upX, float upY, float upZ, float yaw, float pitch, float roll) : MovementSpeed(SPEED)
+	{
+		Position = glm::vec3(posX, posY, posZ); // Set position elements manually from input
+		WorldUp = glm::vec3(upX, upY, upZ); // Set WorldUp elements manually from input
+		SetOrientation(orientationFromAngles(yaw, pitch, roll)); // Starting attitude from the Euler angles
+		SetPerspective(CAMERA_FOVY, 4.0f / 3.0f, CAMERA_NEAR, CAMERA_FAR); // Until the renderer sets its own
+	}
+
+	// Returns the view matrix, written from the camera basis (rebuilt only after the camera moved)
+	glm::mat4 GetViewMatrix()
+	{
+		updateMatrices(); // No-op while nothing changed
+		return view;
+	}
+
+	// Sets the projection, arguments as for glm::perspective (fovy in radians). Unchanged values keep the cached matrices.
+	void SetPerspective(float fovy, float aspect, float zNear, float zFar)
+	{
+		if (fovy == projectionFovy && aspect == projectionAspect && zNear == projectionNear && zFar == projectionFar)
+			return;
+		projectionFovy = fovy; // Remember the arguments to spot changes
+		projectionAspect = aspect;
+		projectionNear = zNear;
+		projectionFar = zFar;
+		projection = glm::perspective(fovy, aspect, zNear, zFar); // New projection
+		valid = false; // View-projection and frustum follow
+	}
+
+	// Returns the projection matrix set by SetPerspective
+	glm::mat4 GetProjectionMatrix() const
+	{
+		return projection;
+	}
+
+	// Returns projection * view (rebuilt only after the camera moved)
+	glm::mat4 GetViewProjectionMatrix()
+	{
+		updateMatrices(); // No-op while nothing changed
+		return viewProjection;
+	}
+
+	// Returns the world-space frustum planes of the view and projection, for culling (see Frustum.h)
+	const Frustum& GetFrustum()
+	{
+		updateMatrices(); // No-op while nothing changed
+		return frustum;
+	}
+
+	// Sets the orientation (renormalized) and the basis vectors that follow from it
+	void SetOrientation(const glm::quat& orientation)
+	{
+		Orientation = glm::normalize(orientation); // Keep it a pure rotation
+		glm::mat3 basis = glm::mat3_cast(Orientation); // Columns are the camera axes in world space
+		Right = basis[0]; // Camera x
+		Up = basis[1]; // Camera y
+		Front = -basis[2]; // Camera looks down -z
+	}
+
+	// Processes input received from any keyboard-like input system. Accepts input parameter in the form of camera defined ENUM (to abstract it from windowing systems)
+	void ProcessKeyboard(Camera_Movement direction, float deltaTime)
+	{
+		// Defines all directions
+		float velocity = MovementSpeed * deltaTime; // Calculate velocity using speed and time
+		if (direction == FORWARD) // If forward direction
+			Position += Front * velocity; // Add front * velocity to position
+		if (direction == BACKWARD) // If backward
+			Position -= Front * velocity; // Subtract front * velocity from position
+		if (direction == LEFT) // If left
+			Position -= Right * velocity; // Subtract Right * velocity from position
+		if (direction == RIGHT) // If right
+			Position += Right * velocity; // Add right * velocity to position
+		if (direction == UP) // If up
+			Position += Up * velocity; // Add up * velocity to position
+		if (direction == DOWN) // If down
+			Position -= Up * velocity; // Subtract up * velocity to position
+		if (direction == UPPITCH) // If up pitch
+			turn(glm::vec3(1.0f, 0.0f, 0.0f), CAMERA_TURN_STEP); // Tilt front up about the camera's right axis
+		if (direction == DOWNPITCH) // If down pitch
+			turn(glm::vec3(1.0f, 0.0f, 0.0f), -CAMERA_TURN_STEP); // Tilt front down
+		if (direction == UPYAW) // If up yaw
+			turn(glm::vec3(0.0f, 1.0f, 0.0f), -CAMERA_TURN_STEP); // Turn right about the camera's up axis
+		if (direction == DOWNYAW) // If down yaw
+			turn(glm::vec3(0.0f, 1.0f, 0.0f), CAMERA_TURN_STEP); // Turn left
+		if (direction == UPROLL) // If up roll
+			turn(glm::vec3(0.0f, 0.0f, -1.0f), CAMERA_TURN_STEP); // Roll up towards right about the camera's front axis
+		if (direction == DOWNROLL) // If down roll
+			turn(glm::vec3(0.0f, 0.0f, -1.0f), -CAMERA_TURN_STEP); // Roll the other way
+	}
+
+	// Moves the camera for one simulation step with keys (Camera_Key bits) held. Shift + up/down moves forward and
+	// backward, shift + comma/period rolls, control + arrows pitch and yaw, arrows alone translate, R resets.
+	// One movement per step, in that order of priority.
+	void Step(GLuint keys, float deltaTime)
+	{
+		if (keys & CAMERA_KEY_SHIFT) { // If either shift key is held
+			if (keys & CAMERA_KEY_UP) // If up arrow
+				ProcessKeyboard(FORWARD, deltaTime); // Move camera forward
+			else if (keys & CAMERA_KEY_DOWN) // If down arrow
+				ProcessKeyboard(BACKWARD, deltaTime); // Move camera backward
+			else if (keys & CAMERA_KEY_COMMA) // If comma --> less than symbol
+				ProcessKeyboard(UPROLL, deltaTime); // Positive roll
+			else if (keys & CAMERA_KEY_PERIOD) // If period --> greater than symbol
+				ProcessKeyboard(DOWNROLL, deltaTime); // Negative roll
+		}
+		else if (keys & CAMERA_KEY_CONTROL) { // If either control key is held
+			if (keys & CAMERA_KEY_DOWN) // If down arrow
+				ProcessKeyboard(UPPITCH, deltaTime); // Positive pitch
+			else if (keys & CAMERA_KEY_UP) // If up arrow
+				ProcessKeyboard(DOWNPITCH, deltaTime); // Negative pitch
+			else if (keys & CAMERA_KEY_RIGHT) // If right arrow
+				ProcessKeyboard(UPYAW, deltaTime); // Positive yaw
+			else if (keys & CAMERA_KEY_LEFT) // If left arrow
+				ProcessKeyboard(DOWNYAW, deltaTime); // Negative yaw
+		}
+		else if (keys & CAMERA_KEY_RIGHT) // If right arrow
+			ProcessKeyboard(RIGHT, deltaTime); // Translate right
+		else if (keys & CAMERA_KEY_LEFT) // If left arrow
+			ProcessKeyboard(LEFT, deltaTime); // Translate left
+		else if (keys & CAMERA_KEY_UP) // If up arrow
+			ProcessKeyboard(UP, deltaTime); // Translate up
+		else if (keys & CAMERA_KEY_DOWN) // If down arrow
+			ProcessKeyboard(DOWN, deltaTime); // Translate down
+		else if (keys & CAMERA_KEY_RESET) // If r is held
+			ResetCamera(); // Reset camera
+	}
+
+	// Poses this camera part way between two simulation steps (alpha 0 is previous, 1 is current), for rendering
+	// between ticks. A pose that did not change keeps the cached matrices.
+	void Interpolate(const Camera& previous, const Camera& current, float alpha)
+	{
+		MovementSpeed = current.MovementSpeed; // Speed and world up of the latest step
+		WorldUp = current.WorldUp;
+		Position = previous.Position + (current.Position - previous.Position) * alpha; // Blend position (exact when it didn't move)
+		if (previous.Orientation == current.Orientation) // Not turning
+			SetOrientation(current.Orientation);
+		else
+			SetOrientation(glm::slerp(previous.Orientation, current.Orientation, alpha)); // Constant-speed blend along the shorter arc
+	}
+
+	// Resets camera position and rotation vectors
+	void ResetCamera() {
+		Position = glm::vec3(0.0f, 0.0f, 0.0f); // Resets position
+		WorldUp = glm::vec3(0.0f, 1.0f, 0.0f); // Resets worldup vector
+		SetOrientation(orientationFromAngles(YAW, PITCH, ROLL)); // Resets rotation
+	}
+
+private:
+	glm::mat4 view; // Cached view matrix
+	glm::mat4 projection; // Projection from SetPerspective
+	glm::mat4 viewProjection; // Cached projection * view
+	Frustum frustum; // Cached planes of viewProjection
+	glm::vec3 cachedPosition; // Pose the cache was built for
+	glm::quat cachedOrientation;
+	bool valid; // Cache matches the projection
+	float projectionFovy = 0.0f, projectionAspect = 0.0f, projectionNear = 0.0f, projectionFar = 0.0f; // SetPerspective arguments
+
+	// Orientation for Euler angles in degrees, matching the angles the camera used to store: yaw about WorldUp
+	// (YAW looks down -z), then pitch about the turned right axis, then roll about the turned front axis
+	glm::quat orientationFromAngles(float yaw, float pitch, float roll) const
+	{
+		glm::quat yawTurn = glm::angleAxis(glm::radians(YAW - yaw), glm::normalize(WorldUp)); // Heading
+		glm::quat pitchTurn = glm::angleAxis(glm::radians(pitch), glm::vec3(1.0f, 0.0f, 0.0f)); // Elevation
+		glm::quat rollTurn = glm::angleAxis(glm::radians(roll), glm::vec3(0.0f, 0.0f, -1.0f)); // Bank
+		return yawTurn * pitchTurn * rollTurn;
+	}
+
+	// Turns the camera by degrees about axis, given in camera space (so always about its current right, up or front)
+	void turn(const glm::vec3& axis, float degrees)
+	{
+		SetOrientation(Orientation * glm::angleAxis(glm::radians(degrees), axis)); // Renormalized, so rounding never builds up
+	}
+
+	// Rebuilds view, view-projection and frustum if the pose or projection changed since the last build
+	void updateMatrices()
+	{
+		if (valid && Position == cachedPosition && Orientation == cachedOrientation)
+			return;
+		// Rows of the rotation part are the camera axes; the translation moves Position to the origin
+		view = glm::mat4(glm::vec4(Right.x, Up.x, -Front.x, 0.0f),
+			glm::vec4(Right.y, Up.y, -Front.y, 0.0f),
+			glm::vec4(Right.z, Up.z, -Front.z, 0.0f),
+			glm::vec4(-glm::dot(Right, Position), -glm::dot(Up, Position), glm::dot(Front, Position), 1.0f));
+		viewProjection = projection * view;
+		frustum = Frustum::FromMatrix(viewProjection);
+		cachedPosition = Position;
+		cachedOrientation = Orientation;
+		valid = true;
+	}
+};
+
+
+// Key states of a camera flythrough by simulation tick. Recording stores only the transitions, one "tick keys" line
+// each, so a saved file replays through KeysAt to exactly the same camera path (the simulation runs at a fixed
+// step from the default camera, and floats come out the same every run).
+class CameraInputLog
+{
+public:
+	GLuint EndTick; // Ticks covered by the log
+
+	CameraInputLog() : EndTick(0) {}
+
+	// Records keys held during tick (ticks in increasing order)
+	void Record(GLuint tick, GLuint keys)
+	{
+		if (transitions.empty() || transitions.back().second != keys) // Only changes are stored
+			transitions.push_back(std::make_pair(tick, keys));
+		EndTick = tick + 1;
+	}
+
+	// Keys held during tick (none before the first transition)
+	GLuint KeysAt(GLuint tick) const
+	{
+		std::vector<std::pair<GLuint, GLuint> >::const_iterator next = std::upper_bound(transitions.begin(), transitions.end(),
+			std::make_pair(tick, ~0u)); // First transition after tick
+		return (next == transitions.begin()) ? 0 : (next - 1)->second;
+	}
+
+	// Writes "CAMERA_INPUT <tick rate> <end tick>" and one "tick keys" line per transition
+	bool Save(const std::string& path) const
+	{
+		std::ofstream file(path.c_str()); // Output file
+		if (!file)
+		{
+			std::cout << "ERROR::CAMERA::CANNOT_WRITE " << path << std::endl;
+			return false;
+		}
+		file << "CAMERA_INPUT " << CAMERA_TICK_RATE << " " << EndTick << "\n";
+		for (size_t i = 0; i < transitions.size(); i++)
+			file << transitions[i].first << " " << transitions[i].second << "\n";
+		return true;
+	}
+
+	// Reads a file written by Save. Fails on a different tick rate, which would change the path.
+	bool Load(const std::string& path)
+	{
+		std::ifstream file(path.c_str()); // Input file
+		std::string magic; // "CAMERA_INPUT"
+		float tickRate = 0.0f; // Rate the log was recorded at
+		if (!(file >> magic >> tickRate >> EndTick) || magic != "CAMERA_INPUT" || tickRate != CAMERA_TICK_RATE)
+		{
+			std::cout << "ERROR::CAMERA::INVALID_INPUT_LOG " << path << std::endl;
+			return false;
+		}
+		transitions.clear();
+		GLuint tick, keys; // One transition
+		while (file >> tick >> keys)
+			transitions.push_back(std::make_pair(tick, keys));
+		return true;
+	}
+
+private:
+	std::vector<std::pair<GLuint, GLuint> > transitions; // (tick, keys from that tick on)
+};
+
+// Fixed-timestep camera: Advance runs as many CAMERA_TICK steps as the elapsed time covers, so movement no longer
+// depends on the frame rate, and View blends the last two steps for rendering in between. With Playback set the
+// keys come from a log until it ends; with Recording set every tick's keys are logged.
+class CameraSimulation
+{
+public:
+	Camera Current; // State after the last tick
+	Camera Previous; // State one tick earlier
+	GLuint Tick; // Ticks simulated
+	CameraInputLog* Recording; // Log to record into, NULL for none
+	const CameraInputLog* Playback; // Log to replay, NULL for live keys
+
+	CameraSimulation(const Camera& camera) : Current(camera), Previous(camera), Tick(0), Recording(NULL), Playback(NULL), accumulator(0.0f) {}
+
+	// Simulates the ticks that fit into seconds (plus what earlier calls left over) with liveKeys held
+	void Advance(float seconds, GLuint liveKeys)
+	{
+		accumulator += std::min(seconds, CAMERA_MAX_FRAME_TIME); // A long stall doesn't have to be caught up
+		while (accumulator >= CAMERA_TICK)
+		{
+			GLuint keys = Replaying() ? Playback->KeysAt(Tick) : liveKeys; // This tick's input
+			if (Recording)
+				Recording->Record(Tick, keys);
+			Previous = Current;
+			Current.Step(keys, CAMERA_TICK);
+			Tick++;
+			accumulator -= CAMERA_TICK;
+		}
+	}
+
+	// Poses camera for rendering: the last two ticks blended by the time left over. Keep rendering with the same
+	// camera so its cached matrices survive frames where nothing moved.
+	void View(Camera& camera) const
+	{
+		camera.Interpolate(Previous, Current, accumulator / CAMERA_TICK);
+	}
+
+	// True while the playback log still has ticks to run
+	bool Replaying() const
+	{
+		return Playback && Tick < Playback->EndTick;
+	}
+
+private:
+	float accumulator; // Seconds not simulated yet, less than CAMERA_TICK after Advance
+};
+#endif
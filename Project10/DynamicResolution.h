@@ -0,0 +1,197 @@
+#pragma once
+// Std. Includes
+#include <iostream> // Include cout
+#include <iomanip> // Include setprecision
+#include <sstream> // Include ostringstream
+#include <algorithm> // Include min/max
+#include <cmath> // Include sqrt/floor/ceil
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+
+#include "GLHandle.h" // Include FBO/renderbuffer handles
+
+// Dynamic resolution: the scene renders into an offscreen target at Scale times the output size, and End upscales
+// it to the output with a bilinear glBlitFramebuffer. A GL_TIMESTAMP pair around every frame measures the GPU time
+// (read back DYNAMIC_RESOLUTION_QUERY_FRAMES frames later, never stalling), and a feedback controller moves Scale
+// between MinScale and MaxScale to keep that time between DYNAMIC_RESOLUTION_HEADROOM * TargetMs and TargetMs.
+// Pixel cost grows with Scale squared, so each correction is sqrt(target / measured), snapped to
+// DYNAMIC_RESOLUTION_STEP. After a change the controller waits DYNAMIC_RESOLUTION_SETTLE_FRAMES before the next,
+// so results still in flight at the old scale don't push it further.
+
+const GLuint DYNAMIC_RESOLUTION_QUERY_FRAMES = 3; // Timestamp pairs in flight
+const float DYNAMIC_RESOLUTION_TARGET_MS = 15.0f; // Default budget: a 60 Hz frame minus room for the blit and the compositor
+const float DYNAMIC_RESOLUTION_HEADROOM = 0.8f; // Scale up only below this fraction of the target
+const float DYNAMIC_RESOLUTION_STEP = 0.05f; // Scales snap to multiples of this
+const float DYNAMIC_RESOLUTION_MAX_STEP_UP = 0.1f; // Largest increase per change (decreases are not limited)
+const float DYNAMIC_RESOLUTION_SMOOTHING = 0.25f; // Weight of a new sample in the filtered GPU time
+const GLuint DYNAMIC_RESOLUTION_SETTLE_FRAMES = 8; // Samples ignored after a change
+
+class DynamicResolution
+{
+public:
+	bool Enabled; // Adjust the scale from the GPU time (otherwise it stays where it is)
+	float MinScale; // Smallest scale per axis
+	float MaxScale; // Largest scale per axis (above 1 supersamples)
+	float TargetMs; // GPU time per frame to hold
+	bool Log; // Print every scale change
+
+	// width x height is the output size; the offscreen target is allocated for maxScale
+	DynamicResolution(GLuint width, GLuint height, float minScale = 0.5f, float maxScale = 1.0f, float targetMs = DYNAMIC_RESOLUTION_TARGET_MS) :
+		Enabled(true), MinScale(minScale), MaxScale(maxScale), TargetMs(targetMs), Log(true), outputWidth(width), outputHeight(height),
+		targetWidth(0), targetHeight(0), scale(min(1.0f, maxScale)), filteredMs(0.0f), settle(0), frame(0)
+	{
+		glGenQueries(DYNAMIC_RESOLUTION_QUERY_FRAMES * 2, this->queries);
+		for (GLuint i = 0; i < DYNAMIC_RESOLUTION_QUERY_FRAMES; i++)
+			this->pending[i] = false;
+	}
+	~DynamicResolution()
+	{
+		glDeleteQueries(DYNAMIC_RESOLUTION_QUERY_FRAMES * 2, this->queries);
+	}
+	DynamicResolution(const DynamicResolution&) = delete; // Owns GL objects, no copies
+	DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+	// Collects a finished GPU time, adjusts the scale and binds the offscreen target. Render the frame at
+	// Width() x Height() after this.
+	void Begin()
+	{
+		GLuint slot = this->frame % DYNAMIC_RESOLUTION_QUERY_FRAMES; // Pair written DYNAMIC_RESOLUTION_QUERY_FRAMES frames ago
+		if (this->pending[slot])
+		{
+			this->pending[slot] = false;
+			GLint available = 0; // Result ready without waiting
+			glGetQueryObjectiv(this->queries[slot * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available) // Otherwise dropped, like the profiler does
+			{
+				GLuint64 begin = 0, end = 0; // Nanoseconds on the GPU clock
+				glGetQueryObjectui64v(this->queries[slot * 2], GL_QUERY_RESULT, &begin);
+				glGetQueryObjectui64v(this->queries[slot * 2 + 1], GL_QUERY_RESULT, &end);
+				this->Update((end - begin) / 1.0e6f);
+			}
+		}
+		this->scale = min(max(this->scale, this->MinScale), this->MaxScale); // Bounds may have changed
+		this->allocate();
+		glQueryCounter(this->queries[slot * 2], GL_TIMESTAMP); // GPU frame start
+		glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.Get());
+	}
+
+	// Upscales the rendered region to all of framebuffer (0 for the window), leaves framebuffer bound and
+	// ends the GPU timing
+	void End(GLuint framebuffer)
+	{
+		GLuint slot = this->frame % DYNAMIC_RESOLUTION_QUERY_FRAMES; // Pair started in Begin
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, this->framebuffer.Get());
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+		bool exact = this->Width() == this->outputWidth && this->Height() == this->outputHeight; // 1:1 copy
+		glBlitFramebuffer(0, 0, this->Width(), this->Height(), 0, 0, this->outputWidth, this->outputHeight, GL_COLOR_BUFFER_BIT, exact ? GL_NEAREST : GL_LINEAR);
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glQueryCounter(this->queries[slot * 2 + 1], GL_TIMESTAMP); // GPU frame end
+		this->pending[slot] = true;
+		this->frame++;
+	}
+
+	// Feeds one measured GPU frame time to the controller (Begin does this with the timer results)
+	void Update(float gpuMs)
+	{
+		this->filteredMs = (this->filteredMs <= 0.0f) ? gpuMs : this->filteredMs + (gpuMs - this->filteredMs) * DYNAMIC_RESOLUTION_SMOOTHING;
+		if (!this->Enabled || this->filteredMs <= 0.0f)
+			return;
+		if (this->settle > 0) // Results from before the last change
+		{
+			this->settle--;
+			return;
+		}
+		float cost = this->filteredMs / this->TargetMs; // Fraction of the budget used
+		if (cost <= 1.0f && cost >= DYNAMIC_RESOLUTION_HEADROOM) // Inside the band
+			return;
+		float aim = (1.0f + DYNAMIC_RESOLUTION_HEADROOM) * 0.5f; // Middle of the band
+		float wanted = this->scale * sqrt(aim / cost); // Pixel count follows the scale squared
+		wanted = floor(wanted / DYNAMIC_RESOLUTION_STEP + 0.5f) * DYNAMIC_RESOLUTION_STEP; // Snap
+		if (cost > 1.0f)
+			wanted = min(wanted, this->scale - DYNAMIC_RESOLUTION_STEP); // At least one step down
+		else
+			wanted = min(max(wanted, this->scale + DYNAMIC_RESOLUTION_STEP), this->scale + DYNAMIC_RESOLUTION_MAX_STEP_UP); // One step up, at most a few
+		wanted = min(max(wanted, this->MinScale), this->MaxScale);
+		if (fabs(wanted - this->scale) < DYNAMIC_RESOLUTION_STEP * 0.5f) // Already at a bound
+			return;
+		if (this->Log)
+		{
+			ostringstream line; // Formatted apart so cout keeps its own precision
+			line << fixed << setprecision(2) << "DYNAMIC_RESOLUTION::SCALE " << this->scale << " -> " << wanted << " (gpu " << setprecision(1)
+				<< this->filteredMs << " ms, target " << this->TargetMs << " ms, " << this->scaled(this->outputWidth, wanted) << "x"
+				<< this->scaled(this->outputHeight, wanted) << ")";
+			cout << line.str() << endl;
+		}
+		this->filteredMs *= (wanted * wanted) / (this->scale * this->scale); // Expected time at the new scale
+		this->scale = wanted;
+		this->settle = DYNAMIC_RESOLUTION_SETTLE_FRAMES;
+	}
+
+	// Sets the scale directly (clamped to the bounds), e.g. for a fixed-scale run with Enabled off
+	void SetScale(float scale)
+	{
+		this->scale = min(max(scale, this->MinScale), this->MaxScale);
+	}
+
+	// Current scale per axis
+	float Scale() const
+	{
+		return this->scale;
+	}
+
+	// Filtered GPU frame time the controller works from, in milliseconds (0 before the first result)
+	float FilteredMs() const
+	{
+		return this->filteredMs;
+	}
+
+	// Size to render the frame at
+	GLuint Width() const
+	{
+		return this->scaled(this->outputWidth, this->scale);
+	}
+	GLuint Height() const
+	{
+		return this->scaled(this->outputHeight, this->scale);
+	}
+
+private:
+	GLuint outputWidth, outputHeight; // Size of the framebuffer End blits to
+	GLuint targetWidth, targetHeight; // Allocated size of the offscreen target
+	GLFramebuffer framebuffer; // Offscreen target
+	GLRenderbuffer colorBuffer, depthBuffer; // Its attachments
+	GLuint queries[DYNAMIC_RESOLUTION_QUERY_FRAMES * 2]; // Begin/end timestamp per frame in flight
+	bool pending[DYNAMIC_RESOLUTION_QUERY_FRAMES]; // Pair written and not read yet
+	float scale; // Current scale per axis
+	float filteredMs; // Smoothed GPU time
+	GLuint settle; // Samples left to ignore after a change
+	GLuint frame; // Frames begun
+
+	// A size at a scale, at least one pixel
+	static GLuint scaled(GLuint size, float scale)
+	{
+		return max(1u, (GLuint)(size * scale + 0.5f));
+	}
+
+	// (Re)allocates the offscreen target when MaxScale needs more pixels than it has. Rendering always goes to
+	// its lower left corner, so scale changes never reallocate.
+	void allocate()
+	{
+		GLuint width = this->scaled(this->outputWidth, max(this->MaxScale, this->scale)); // Largest size needed
+		GLuint height = this->scaled(this->outputHeight, max(this->MaxScale, this->scale));
+		if (width <= this->targetWidth && height <= this->targetHeight)
+			return;
+		this->targetWidth = width;
+		this->targetHeight = height;
+		glBindFramebuffer(GL_FRAMEBUFFER, this->framebuffer.Create());
+		glBindRenderbuffer(GL_RENDERBUFFER, this->colorBuffer.Create());
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height); // Color
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->colorBuffer.Get());
+		glBindRenderbuffer(GL_RENDERBUFFER, this->depthBuffer.Create());
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height); // Depth
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, this->depthBuffer.Get());
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			cout << "ERROR::DYNAMIC_RESOLUTION::FRAMEBUFFER_INCOMPLETE" << endl;
+	}
+};
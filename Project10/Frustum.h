@@ -0,0 +1,120 @@
+#pragma once
+// Std. Includes
+#include <cmath> // Include fabs/sqrt
+#include <algorithm> // Include max
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <glm/glm.hpp> // Include glm
+
+// View frustum as six world-space planes (normals point inward), extracted from projection * view
+// (Gribb & Hartmann). Objects are tested with a bounding sphere first and an AABB second, and only
+// skipped when they are completely outside one plane, so nothing visible is ever culled.
+class Frustum
+{
+public:
+	glm::vec4 Planes[6]; // Left, right, bottom, top, near, far: xyz = normal, w = distance
+
+	// Builds the planes from a combined view-projection matrix
+	static Frustum FromMatrix(const glm::mat4& viewProjection)
+	{
+		Frustum frustum; // Result
+		glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]); // Matrix rows
+		glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+		glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+		glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+		frustum.Planes[0] = row3 + row0; // Left
+		frustum.Planes[1] = row3 - row0; // Right
+		frustum.Planes[2] = row3 + row1; // Bottom
+		frustum.Planes[3] = row3 - row1; // Top
+		frustum.Planes[4] = row3 + row2; // Near
+		frustum.Planes[5] = row3 - row2; // Far
+		for (int i = 0; i < 6; i++) // Normalize so plane distances are in world units
+		{
+			float length = glm::length(glm::vec3(frustum.Planes[i]));
+			if (length > 0.0f)
+				frustum.Planes[i] /= length;
+		}
+		return frustum;
+	}
+
+	// False when the sphere is completely outside the frustum
+	bool IntersectsSphere(const glm::vec3& center, float radius) const
+	{
+		for (int i = 0; i < 6; i++)
+			if (glm::dot(glm::vec3(this->Planes[i]), center) + this->Planes[i].w < -radius) // Fully behind plane i
+				return false;
+		return true;
+	}
+
+	// False when the axis aligned box is completely outside the frustum
+	bool IntersectsBox(const glm::vec3& minimum, const glm::vec3& maximum) const
+	{
+		for (int i = 0; i < 6; i++)
+		{
+			glm::vec3 normal(this->Planes[i]); // Plane normal
+			glm::vec3 positive( // Box corner furthest along the normal
+				normal.x >= 0.0f ? maximum.x : minimum.x,
+				normal.y >= 0.0f ? maximum.y : minimum.y,
+				normal.z >= 0.0f ? maximum.z : minimum.z);
+			if (glm::dot(normal, positive) + this->Planes[i].w < 0.0f) // Even that corner is behind plane i
+				return false;
+		}
+		return true;
+	}
+
+	// Tests object-space bounds placed by a model matrix: transformed sphere first (cheap), then the
+	// world-space box enclosing the transformed AABB
+	bool IntersectsBounds(const glm::mat4& model, const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec3& sphereCenter, float sphereRadius) const
+	{
+		float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])))); // Largest axis scale
+		if (!this->IntersectsSphere(glm::vec3(model * glm::vec4(sphereCenter, 1.0f)), sphereRadius * scale))
+			return false;
+		glm::vec3 center = glm::vec3(model * glm::vec4((boundsMin + boundsMax) * 0.5f, 1.0f)); // World box center
+		glm::vec3 extent = (boundsMax - boundsMin) * 0.5f; // Object half size
+		glm::vec3 worldExtent( // Arvo: |M| * extent gives the world-space half size
+			fabs(model[0][0]) * extent.x + fabs(model[1][0]) * extent.y + fabs(model[2][0]) * extent.z,
+			fabs(model[0][1]) * extent.x + fabs(model[1][1]) * extent.y + fabs(model[2][1]) * extent.z,
+			fabs(model[0][2]) * extent.x + fabs(model[1][2]) * extent.y + fabs(model[2][2]) * extent.z);
+		return this->IntersectsBox(center - worldExtent, center + worldExtent);
+	}
+};
+
+// Per-frame culling counters (objects, meshes or board tiles, whatever the caller counts), plus the
+// draw calls, triangles and state changes that were actually submitted
+struct CullStats {
+	GLuint Visible; // Submitted for drawing
+	GLuint Culled; // Skipped because they were outside the frustum
+	GLuint DrawCalls; // glDraw* calls issued
+	GLuint Triangles; // Triangles those calls drew (all instances)
+	GLuint StateChanges; // Program, VAO and texture binds the calls needed (see GLStateCache)
+
+	CullStats() : Visible(0), Culled(0), DrawCalls(0), Triangles(0), StateChanges(0) {}
+
+	// Clears the counters, call at the start of every frame
+	void Reset()
+	{
+		this->Visible = 0;
+		this->Culled = 0;
+		this->DrawCalls = 0;
+		this->Triangles = 0;
+		this->StateChanges = 0;
+	}
+
+	// Counts one draw call of the given number of triangles
+	void AddDraw(GLuint triangles)
+	{
+		this->DrawCalls++;
+		this->Triangles += triangles;
+	}
+
+	// Counts one test result and passes it through
+	bool Record(bool visible, GLuint count = 1)
+	{
+		if (visible)
+			this->Visible += count;
+		else
+			this->Culled += count;
+		return visible;
+	}
+};
@@ -0,0 +1,95 @@
+#pragma once
+// Std. Includes
+#include <utility> // Include swap
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+
+// Move-only owners of GL object names. A handle creates its object on Create(), deletes it when destroyed or
+// reset, and hands ownership over on move, so a Mesh (or anything else holding handles) can live in a vector
+// and be moved around without leaking buffers or deleting them twice. Copies do not compile.
+// The GL context must still be current when a handle is destroyed.
+
+// Create/delete calls for buffer objects
+struct GLBufferTraits {
+	static GLuint Create() { GLuint name = 0; glGenBuffers(1, &name); return name; }
+	static void Delete(GLuint name) { glDeleteBuffers(1, &name); }
+};
+
+// Create/delete calls for vertex array objects
+struct GLVertexArrayTraits {
+	static GLuint Create() { GLuint name = 0; glGenVertexArrays(1, &name); return name; }
+	static void Delete(GLuint name) { glDeleteVertexArrays(1, &name); }
+};
+
+// Create/delete calls for framebuffer objects
+struct GLFramebufferTraits {
+	static GLuint Create() { GLuint name = 0; glGenFramebuffers(1, &name); return name; }
+	static void Delete(GLuint name) { glDeleteFramebuffers(1, &name); }
+};
+
+// Create/delete calls for renderbuffer objects
+struct GLRenderbufferTraits {
+	static GLuint Create() { GLuint name = 0; glGenRenderbuffers(1, &name); return name; }
+	static void Delete(GLuint name) { glDeleteRenderbuffers(1, &name); }
+};
+
+template <class Traits>
+class GLHandle
+{
+public:
+	GLHandle() : name(0) {}
+
+	~GLHandle()
+	{
+		this->Reset();
+	}
+
+	GLHandle(GLHandle&& other) noexcept : name(other.name)
+	{
+		other.name = 0; // Moved-from handles own nothing
+	}
+
+	GLHandle& operator=(GLHandle&& other) noexcept
+	{
+		if (this != &other)
+		{
+			this->Reset(); // Drop what this one owned
+			swap(this->name, other.name);
+		}
+		return *this;
+	}
+
+	GLHandle(const GLHandle&) = delete; // One owner per GL object
+	GLHandle& operator=(const GLHandle&) = delete;
+
+	// Creates a new object (deleting any previous one) and returns its name
+	GLuint Create()
+	{
+		this->Reset();
+		this->name = Traits::Create();
+		return this->name;
+	}
+
+	// Deletes the object, if any
+	void Reset()
+	{
+		if (this->name != 0)
+			Traits::Delete(this->name);
+		this->name = 0;
+	}
+
+	// The GL name, 0 when empty
+	GLuint Get() const
+	{
+		return this->name;
+	}
+
+private:
+	GLuint name; // Owned object, 0 for none
+};
+
+typedef GLHandle<GLBufferTraits> GLBuffer; // VBO, EBO, UBO, PBO
+typedef GLHandle<GLVertexArrayTraits> GLVertexArray; // VAO
+typedef GLHandle<GLFramebufferTraits> GLFramebuffer; // FBO
+typedef GLHandle<GLRenderbufferTraits> GLRenderbuffer; // FBO attachment
@@ -0,0 +1,311 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <vector> // Include vector
+#include <fstream> // Include ofstream
+#include <iostream> // Include cout
+#include <iomanip> // Include setprecision
+#include <sstream> // Include ostringstream
+#include <chrono> // Include steady_clock
+#include <cmath> // Include sin/cos/atan2
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#define EGL_NO_X11 // Keep Xlib and its macros out, only the surfaceless platform is used
+#include <EGL/egl.h> // Include EGL (context without a window)
+#include <EGL/eglext.h> // Include EGL_MESA_platform_surfaceless / EGL_KHR_no_config_context
+#include <glm/glm.hpp> // Include glm
+
+#include "Camera.h" // Include Camera class
+#include "Scene.h" // Include the scene both binaries draw
+#include "DynamicResolution.h" // Include the scaled render target
+
+// Headless benchmark: renders the scene into an FBO on an EGL surfaceless context (Mesa llvmpipe works, no
+// display or GPU needed), replays a fixed camera path and writes one row per frame to JSON and/or CSV.
+// Scene::Render is the same call the window loop makes, so optimizations are measured on the real path.
+
+const GLuint BENCHMARK_PATH_FRAMES = 600; // Frames per orbit of the camera path (frame N is always the same pose)
+const GLuint GPU_QUERY_LATENCY = 3; // GL_TIME_ELAPSED results are read this many frames late, so reading never stalls
+
+// Options for RunHeadless (see the --headless flags in main.cpp)
+struct HeadlessOptions {
+	GLuint Width; // FBO width in pixels
+	GLuint Height; // FBO height in pixels
+	GLuint Frames; // Frames recorded
+	GLuint WarmupFrames; // Frames rendered first and not recorded (driver shader compiles, LOD hysteresis)
+	string JsonPath; // Per-frame JSON output, empty to skip
+	string CsvPath; // Per-frame CSV output, empty to skip
+	string TracePath; // Chrome trace of the profiled passes (Profiler.h), empty to skip
+	bool ParallaxOcclusion; // Scene::ParallaxOcclusion for the run (compare against the single-step offset)
+	bool DepthPrepass; // Scene::DepthPrepass for the run
+	bool DynamicScale; // Render through DynamicResolution (off: straight into the FBO at full size)
+	float MinScale, MaxScale; // DynamicResolution bounds
+	float TargetMs; // DynamicResolution::TargetMs
+	string ReplayPath; // Camera input log (CameraInputLog) to fly instead of the orbit, one tick per frame; empty for the orbit
+
+	HeadlessOptions() : Width(800), Height(600), Frames(BENCHMARK_PATH_FRAMES), WarmupFrames(10), JsonPath("benchmark.json"), CsvPath("benchmark.csv"),
+		ParallaxOcclusion(true), DepthPrepass(true), DynamicScale(false), MinScale(0.5f), MaxScale(1.0f), TargetMs(DYNAMIC_RESOLUTION_TARGET_MS) {}
+};
+
+// One recorded frame
+struct FrameSample {
+	GLuint Frame; // Index on the camera path
+	double CpuMs; // CPU time to record and submit the frame
+	double GpuMs; // GPU time between glBeginQuery/glEndQuery(GL_TIME_ELAPSED)
+	GLuint DrawCalls; // Draw calls issued
+	GLuint Triangles; // Triangles drawn
+	GLuint StateChanges; // Program, VAO and texture binds issued (see GLStateCache)
+	GLuint Visible; // Frustum culling counters (see CullStats)
+	GLuint Culled;
+	float Scale; // Resolution scale the frame was rendered at (1 without dynamic resolution)
+};
+
+// Camera pose for a frame of the benchmark path: orbits the objects around (0, -0.5, -5.5), swinging in and out
+// so the LODs change and the board and objects leave the frustum part of the time. Frame 0 is close to the
+// default interactive view.
+inline Camera BenchmarkCamera(GLuint frame)
+{
+	float angle = glm::radians(360.0f * (float)(frame % BENCHMARK_PATH_FRAMES) / (float)BENCHMARK_PATH_FRAMES); // Position on the orbit
+	glm::vec3 target(0.0f, -0.5f, -5.5f); // Middle of the objects
+	float radius = 4.0f + 2.5f * sin(2.0f * angle); // 1.5 to 6.5 units away
+	glm::vec3 position = target + glm::vec3(sin(angle) * radius, 1.0f + 0.5f * sin(3.0f * angle), cos(angle) * radius); // Orbit position
+	glm::vec3 direction = glm::normalize(target - position); // Look at the target
+	float yaw = glm::degrees(atan2(direction.z, direction.x)); // Angles the Camera constructor turns back into this front
+	float pitch = glm::degrees(asin(direction.y));
+	return Camera(position, glm::vec3(0.0f, 1.0f, 0.0f), yaw, pitch, ROLL);
+}
+
+// Quotes a string for the JSON output: escapes '"', '\\' and control characters (driver strings and paths can hold any)
+inline string JsonString(const string& text)
+{
+	ostringstream quoted; // Escaped result
+	quoted << '"';
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		unsigned char c = (unsigned char)text[i]; // Next byte (UTF-8 passes through)
+		if (c == '"' || c == '\\')
+			quoted << '\\' << (char)c;
+		else if (c < 0x20)
+			quoted << "\\u" << hex << setw(4) << setfill('0') << (int)c;
+		else
+			quoted << (char)c;
+	}
+	quoted << '"';
+	return quoted.str();
+}
+
+// Writes the samples as {"renderer", "width", "height", "parallax", "depth_prepass", "camera", "frames": [...]}
+inline bool WriteBenchmarkJson(const string& path, const HeadlessOptions& options, const string& renderer, const vector<FrameSample>& samples)
+{
+	ofstream file(path.c_str()); // Output file
+	if (!file)
+	{
+		cout << "ERROR::HEADLESS::CANNOT_WRITE " << path << endl;
+		return false;
+	}
+	file << fixed << setprecision(4); // Milliseconds to 0.1 us
+	file << "{\n  \"renderer\": " << JsonString(renderer) << ",\n  \"width\": " << options.Width << ",\n  \"height\": " << options.Height
+		<< ",\n  \"parallax\": \"" << (options.ParallaxOcclusion ? "pom" : "offset") << "\",\n  \"depth_prepass\": " << (options.DepthPrepass ? "true" : "false")
+		<< ",\n  \"camera\": " << JsonString(options.ReplayPath.empty() ? "orbit" : options.ReplayPath) << ",\n  \"frames\": [\n";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const FrameSample& s = samples[i];
+		file << "    {\"frame\": " << s.Frame << ", \"cpu_ms\": " << s.CpuMs << ", \"gpu_ms\": " << s.GpuMs
+			<< ", \"draw_calls\": " << s.DrawCalls << ", \"triangles\": " << s.Triangles << ", \"state_changes\": " << s.StateChanges
+			<< ", \"visible\": " << s.Visible << ", \"culled\": " << s.Culled << ", \"scale\": " << s.Scale << "}" << (i + 1 < samples.size() ? ",\n" : "\n");
+	}
+	file << "  ]\n}\n";
+	return true;
+}
+
+// Writes the samples as CSV with a header row
+inline bool WriteBenchmarkCsv(const string& path, const vector<FrameSample>& samples)
+{
+	ofstream file(path.c_str()); // Output file
+	if (!file)
+	{
+		cout << "ERROR::HEADLESS::CANNOT_WRITE " << path << endl;
+		return false;
+	}
+	file << fixed << setprecision(4);
+	file << "frame,cpu_ms,gpu_ms,draw_calls,triangles,state_changes,visible,culled,scale\n";
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		const FrameSample& s = samples[i];
+		file << s.Frame << "," << s.CpuMs << "," << s.GpuMs << "," << s.DrawCalls << "," << s.Triangles << "," << s.StateChanges << "," << s.Visible << "," << s.Culled << "," << s.Scale << "\n";
+	}
+	return true;
+}
+
+// Creates a surfaceless OpenGL 3.3 core context and makes it current. Prefers the Mesa surfaceless platform,
+// falls back to the default display.
+inline bool CreateHeadlessContext(EGLDisplay& display, EGLContext& context)
+{
+	PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+	display = getPlatformDisplay ? getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL) : EGL_NO_DISPLAY;
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY); // Any display will do, nothing is presented
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, NULL, NULL))
+	{
+		cout << "ERROR::HEADLESS::NO_EGL_DISPLAY" << endl;
+		return false;
+	}
+	if (!eglBindAPI(EGL_OPENGL_API)) // Desktop GL, not GLES
+	{
+		cout << "ERROR::HEADLESS::NO_OPENGL_API" << endl;
+		return false;
+	}
+	const EGLint attributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3, // Same version the window asks GLFW for
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, attributes); // No config: we only render to FBOs
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		cout << "ERROR::HEADLESS::CANNOT_CREATE_CONTEXT 0x" << hex << eglGetError() << dec << endl;
+		return false;
+	}
+	return true;
+}
+
+// Runs the benchmark and returns the process exit code
+inline int RunHeadless(const HeadlessOptions& options)
+{
+	EGLDisplay display; // EGL display
+	EGLContext context; // GL 3.3 core context
+	if (!CreateHeadlessContext(display, context))
+		return 1;
+
+	glewExperimental = GL_TRUE; // Set glew to experimental
+	GLenum err = glewInit(); // Load the entry points
+	if (err != GLEW_OK && err != GLEW_ERROR_NO_GLX_DISPLAY) // A GLX build of GLEW finds no X display here, the GL entry points still load
+	{
+		cout << "ERROR::HEADLESS::GLEW " << glewGetErrorString(err) << endl;
+		return 1;
+	}
+	string renderer = (const char*)glGetString(GL_RENDERER); // E.g. llvmpipe (LLVM 15.0.7, 256 bits)
+
+	// Offscreen target in place of the window's default framebuffer
+	GLuint FBO, colorBuffer, depthBuffer; // Framebuffer and its attachments
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glGenRenderbuffers(1, &colorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.Width, options.Height); // Color
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+	glGenRenderbuffers(1, &depthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, options.Width, options.Height); // Depth
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		cout << "ERROR::HEADLESS::FRAMEBUFFER_INCOMPLETE" << endl;
+		return 1;
+	}
+
+	CameraInputLog replay; // Recorded flythrough for --replay
+	if (!options.ReplayPath.empty() && !replay.Load(options.ReplayPath))
+		return 1;
+	GLuint frames = options.ReplayPath.empty() ? options.Frames : replay.EndTick; // A replay runs to its end
+	vector<FrameSample> samples(frames); // Results
+	GLuint lateResults = 0; // GPU times that were not ready when read (the read then waited)
+	{
+		Scene scene; // Same scene the window draws
+		scene.ParallaxOcclusion = options.ParallaxOcclusion; // Parallax mode under test
+		scene.DepthPrepass = options.DepthPrepass; // Pre-pass mode under test
+		DynamicResolution resolution(options.Width, options.Height, options.MinScale, options.MaxScale, options.TargetMs); // Used with --dynamic-resolution on
+		CameraSimulation simulation((Camera())); // Replayed camera, starting where the window's does
+		simulation.Playback = &replay;
+		TextureManager::Instance().Flush(); // Wait for the async texture loads so they don't land mid-run
+
+		GLuint warmupFrames = max(options.WarmupFrames, 1u); // At least one: llvmpipe reports a bogus start time for a query begun before anything was drawn
+		for (GLuint frame = 0; frame < warmupFrames; frame++) // Not recorded
+		{
+			Camera camera = options.ReplayPath.empty() ? BenchmarkCamera(0) : simulation.Current; // Stay on the first pose
+			scene.Render(camera, options.Width, options.Height);
+		}
+		glFinish(); // Start the measured frames with an idle pipeline
+
+		GLuint queries[GPU_QUERY_LATENCY]; // Ring of GL_TIME_ELAPSED queries
+		glGenQueries(GPU_QUERY_LATENCY, queries);
+		for (GLuint frame = 0; frame < frames + GPU_QUERY_LATENCY; frame++) // Extra frames drain the ring
+		{
+			if (frame >= GPU_QUERY_LATENCY) // Query of frame - GPU_QUERY_LATENCY is done by now (or nearly)
+			{
+				GLuint query = queries[frame % GPU_QUERY_LATENCY]; // Query to read and reuse
+				GLint available = 0; // Result ready without waiting
+				glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (!available) // GPU more than GPU_QUERY_LATENCY frames behind: every frame needs its time, so wait
+					lateResults++; // (outside the CPU timing, but the stall is counted and reported)
+				GLuint64 elapsed = 0; // Nanoseconds
+				glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+				samples[frame - GPU_QUERY_LATENCY].GpuMs = elapsed / 1.0e6;
+			}
+			if (frame >= frames) // Only draining
+				continue;
+
+			chrono::steady_clock::time_point start = chrono::steady_clock::now(); // CPU frame start
+			if (!options.ReplayPath.empty())
+				simulation.Advance(CAMERA_TICK, 0); // Exactly one tick, keys from the log
+			Camera camera = options.ReplayPath.empty() ? BenchmarkCamera(frame) : simulation.Current; // Pose on the path
+			TextureManager::Instance().Update(); // Same per-frame work as the window loop
+			glBeginQuery(GL_TIME_ELAPSED, queries[frame % GPU_QUERY_LATENCY]);
+			if (options.DynamicScale)
+			{
+				resolution.Begin(); // Scaled target, scale picked from earlier frames
+				scene.Render(camera, resolution.Width(), resolution.Height());
+				resolution.End(FBO); // Upscale into the benchmark FBO
+			}
+			else
+				scene.Render(camera, options.Width, options.Height);
+			glEndQuery(GL_TIME_ELAPSED);
+			glFlush(); // Submit, where the window loop would swap
+			double cpuMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count(); // CPU frame end
+
+			FrameSample& sample = samples[frame];
+			sample.Frame = frame;
+			sample.CpuMs = cpuMs;
+			sample.GpuMs = 0.0;
+			sample.DrawCalls = scene.Stats.DrawCalls;
+			sample.Triangles = scene.Stats.Triangles;
+			sample.StateChanges = scene.Stats.StateChanges;
+			sample.Visible = scene.Stats.Visible;
+			sample.Culled = scene.Stats.Culled;
+			sample.Scale = options.DynamicScale ? resolution.Scale() : 1.0f;
+		}
+		glDeleteQueries(GPU_QUERY_LATENCY, queries);
+
+		cout << scene.Profile.Report(); // Per-pass breakdown of the run (warm-up included)
+		if (!options.TracePath.empty())
+			scene.Profile.WriteChromeTrace(options.TracePath);
+	} // Scene releases its GL objects while the context is still current
+
+	glDeleteRenderbuffers(1, &colorBuffer);
+	glDeleteRenderbuffers(1, &depthBuffer);
+	glDeleteFramebuffers(1, &FBO);
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT); // Release the context
+	eglDestroyContext(display, context);
+	eglTerminate(display);
+
+	double cpuTotal = 0.0, gpuTotal = 0.0; // Averages for the console
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		cpuTotal += samples[i].CpuMs;
+		gpuTotal += samples[i].GpuMs;
+	}
+	if (!samples.empty())
+		cout << "HEADLESS::" << renderer << " " << options.Width << "x" << options.Height << " " << (options.ParallaxOcclusion ? "pom" : "offset")
+			<< " parallax, depth pre-pass " << (options.DepthPrepass ? "on" : "off") << ", " << samples.size() << " frames, cpu "
+			<< cpuTotal / samples.size() << " ms, gpu " << gpuTotal / samples.size() << " ms per frame" << endl;
+	if (lateResults > 0) // The ring was too short for this GPU, the run waited on queries
+		cout << "HEADLESS::" << lateResults << " GPU times were not ready " << GPU_QUERY_LATENCY << " frames later, reading them stalled" << endl;
+
+	bool written = true; // Both outputs succeeded
+	if (!options.JsonPath.empty())
+		written = WriteBenchmarkJson(options.JsonPath, options, renderer, samples) && written;
+	if (!options.CsvPath.empty())
+		written = WriteBenchmarkCsv(options.CsvPath, samples) && written;
+	return written ? 0 : 1;
+}
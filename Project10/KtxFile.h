@@ -0,0 +1,256 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <fstream> // Include fstream
+#include <iostream> // Include iostream
+#include <vector> // Include vector
+#include <cstdio> // Include cstdio for rename/remove
+#include <cstring> // Include cstring for memcmp/memcpy
+#include <cstdint> // Include fixed width integer types
+#include <algorithm> // Include max
+using namespace std; // Use namespace std
+// POSIX Includes
+#include <sys/stat.h> // stat for source/baked mtimes
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+
+// Block-compressed textures baked offline by bake_textures.cpp into KTX 1.1 files next to the source image
+// (e.g. Bump-Picture.jpg -> Bump-Picture.jpg.ktx). Each file holds one 2D image with its full mip chain in
+// BC1, BC4, BC5 or BC7, ready for glCompressedTexImage2D.
+// Layout: KtxHeader, key/value data (KTXorientation, plus CSTbumpLayout on bump maps), then per mip level a uint32 byte count
+// followed by the blocks. Block sizes are multiples of 8 bytes, so no mip padding is needed.
+// The TextureLoader uses a baked file instead of decoding the image whenever it is at least as new as the source.
+
+const unsigned char KTX_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' }; // File identifier
+const uint32_t KTX_ENDIANNESS = 0x04030201; // Written in native order, read back as-is on the same machine
+const char KTX_ORIENTATION_KEY[] = "KTXorientation"; // Row order key
+const char KTX_ROWS_DOWN[] = "S=r,T=d"; // First row is the top of the image (SOIL order, 2D textures)
+const char KTX_ROWS_UP[] = "S=r,T=u"; // First row is the bottom of the image (flipped, cubemap faces)
+const char KTX_BUMP_LAYOUT_KEY[] = "CSTbumpLayout"; // Marks a bump map baked with --bump
+const char KTX_BUMP_LAYOUT[] = "normalXY,height"; // RGB layout of BumpMap.h
+
+struct KtxHeader {
+	unsigned char identifier[12]; // KTX_IDENTIFIER
+	uint32_t endianness; // KTX_ENDIANNESS
+	uint32_t glType; // 0 for compressed data
+	uint32_t glTypeSize; // 1 for compressed data
+	uint32_t glFormat; // 0 for compressed data
+	uint32_t glInternalFormat; // GL_COMPRESSED_* format
+	uint32_t glBaseInternalFormat; // GL_RED, GL_RG, GL_RGB or GL_RGBA
+	uint32_t pixelWidth; // Level 0 width
+	uint32_t pixelHeight; // Level 0 height
+	uint32_t pixelDepth; // 0 for 2D
+	uint32_t numberOfArrayElements; // 0, not an array
+	uint32_t numberOfFaces; // 1, cubemaps are baked one face per file
+	uint32_t numberOfMipmapLevels; // Levels that follow
+	uint32_t bytesOfKeyValueData; // Key/value bytes after the header
+};
+
+// One mip level inside KtxImage::data
+struct KtxLevel {
+	GLsizei width, height; // Level size in pixels
+	size_t offset; // Byte offset into data
+	GLsizei size; // Compressed bytes
+};
+
+// A baked texture read back into memory
+struct KtxImage {
+	GLenum internalFormat = 0; // GL_COMPRESSED_* format
+	GLenum baseFormat = 0; // GL_RED, GL_RG, GL_RGB or GL_RGBA
+	string orientation; // KTX_ROWS_DOWN or KTX_ROWS_UP
+	bool bumpLayout = false; // Holds the normal/height layout of BumpMap.h, not raw colors or heights
+	vector<KtxLevel> levels; // Mip chain, level 0 first
+	vector<unsigned char> data; // Blocks of every level back to back
+};
+
+// Returns the baked file used for a source image
+inline string KtxPath(const string& sourcePath)
+{
+	return sourcePath + ".ktx"; // Baked file lives next to the source image
+}
+
+// Bytes per 4x4 block of a compressed format, 0 for formats the baker never writes
+inline GLsizei KtxBlockBytes(GLenum internalFormat)
+{
+	switch (internalFormat) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: // BC1
+	case GL_COMPRESSED_RED_RGTC1: // BC4
+		return 8;
+	case GL_COMPRESSED_RG_RGTC2: // BC5
+	case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB: // BC7
+		return 16;
+	}
+	return 0;
+}
+
+// Compressed size of one level
+inline GLsizei KtxLevelSize(GLenum internalFormat, GLsizei width, GLsizei height)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * KtxBlockBytes(internalFormat); // Partial blocks at the edges still take a whole block
+}
+
+// True when the driver can sample the format. RGTC (BC4/BC5) is core since GL 3.0; BC1 needs S3TC, BC7 needs BPTC.
+// Only reads GLEW's extension flags, so it is safe to call from the loader's worker threads after glewInit.
+inline bool KtxFormatSupported(GLenum internalFormat)
+{
+	switch (internalFormat) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+		return GLEW_EXT_texture_compression_s3tc;
+	case GL_COMPRESSED_RED_RGTC1:
+	case GL_COMPRESSED_RG_RGTC2:
+		return true;
+	case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB:
+		return GLEW_ARB_texture_compression_bptc;
+	}
+	return false;
+}
+
+// Short name of a format for log output
+inline const char* KtxFormatName(GLenum internalFormat)
+{
+	switch (internalFormat) {
+	case GL_COMPRESSED_RGB_S3TC_DXT1_EXT: return "BC1";
+	case GL_COMPRESSED_RED_RGTC1: return "BC4";
+	case GL_COMPRESSED_RG_RGTC2: return "BC5";
+	case GL_COMPRESSED_RGBA_BPTC_UNORM_ARB: return "BC7";
+	}
+	return "unknown";
+}
+
+// True when sourcePath has a baked file that is at least as new as the image (or the image is gone)
+inline bool KtxFresh(const string& sourcePath)
+{
+	struct stat baked, source; // Stat buffers
+	if (stat(KtxPath(sourcePath).c_str(), &baked) != 0) // Never baked
+		return false;
+	if (stat(sourcePath.c_str(), &source) != 0) // Only the baked file was shipped
+		return true;
+	return baked.st_mtim.tv_sec > source.st_mtim.tv_sec ||
+		(baked.st_mtim.tv_sec == source.st_mtim.tv_sec && baked.st_mtim.tv_nsec >= source.st_mtim.tv_nsec); // Re-bake after editing the image
+}
+
+// Reads a baked file. Returns false (and prints why) if it is missing, truncated or not something the baker wrote.
+inline bool ReadKtx(const string& path, KtxImage& image)
+{
+	ifstream in(path.c_str(), ios::binary); // Open baked file
+	if (!in)
+		return false;
+	KtxHeader header; // File header
+	if (!in.read((char*)&header, sizeof(header)) || memcmp(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0 ||
+		header.endianness != KTX_ENDIANNESS || header.glType != 0 || KtxBlockBytes(header.glInternalFormat) == 0 ||
+		header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth != 0 || header.numberOfArrayElements != 0 ||
+		header.numberOfFaces != 1 || header.numberOfMipmapLevels == 0) {
+		cerr << "ERROR::KTX::UNSUPPORTED " << path << endl;
+		return false;
+	}
+
+	// Key/value pairs: uint32 size, "key\0value\0", padded to 4 bytes
+	vector<char> keyValues(header.bytesOfKeyValueData); // Raw key/value data
+	if (!in.read(keyValues.data(), keyValues.size())) {
+		cerr << "ERROR::KTX::TRUNCATED " << path << endl;
+		return false;
+	}
+	image.orientation = KTX_ROWS_DOWN; // KTX default when the key is absent
+	image.bumpLayout = false; // Only bump bakes carry the key
+	for (size_t at = 0; at + 4 <= keyValues.size();) {
+		uint32_t pairSize; // Bytes of key + value
+		memcpy(&pairSize, &keyValues[at], 4);
+		if (pairSize > keyValues.size() - at - 4)
+			break;
+		string key(&keyValues[at + 4], strnlen(&keyValues[at + 4], pairSize)); // Key up to its terminator
+		string value; // Value up to its terminator
+		if (key.size() + 1 < pairSize)
+			value = string(&keyValues[at + 4 + key.size() + 1], strnlen(&keyValues[at + 4 + key.size() + 1], pairSize - key.size() - 1));
+		if (key == KTX_ORIENTATION_KEY && !value.empty())
+			image.orientation = value;
+		else if (key == KTX_BUMP_LAYOUT_KEY)
+			image.bumpLayout = value == KTX_BUMP_LAYOUT;
+		at += 4 + ((pairSize + 3) & ~3u); // Next pair
+	}
+
+	image.internalFormat = header.glInternalFormat;
+	image.baseFormat = header.glBaseInternalFormat;
+	image.levels.clear();
+	image.data.clear();
+	GLsizei width = header.pixelWidth, height = header.pixelHeight; // Current level size
+	for (uint32_t level = 0; level < header.numberOfMipmapLevels; level++)
+	{
+		uint32_t imageSize; // Bytes in this level
+		KtxLevel entry; // Level record
+		entry.width = width;
+		entry.height = height;
+		entry.offset = image.data.size();
+		entry.size = KtxLevelSize(image.internalFormat, width, height);
+		if (!in.read((char*)&imageSize, 4) || imageSize != (uint32_t)entry.size) {
+			cerr << "ERROR::KTX::TRUNCATED " << path << endl;
+			return false;
+		}
+		image.data.resize(entry.offset + entry.size);
+		if (!in.read((char*)&image.data[entry.offset], entry.size)) {
+			cerr << "ERROR::KTX::TRUNCATED " << path << endl;
+			return false;
+		}
+		image.levels.push_back(entry);
+		width = max(width / 2, 1); // Next level
+		height = max(height / 2, 1);
+	}
+	return true;
+}
+
+// Appends one key/value pair: uint32 size, "key\0value\0", padded to 4 bytes
+inline void AppendKtxKeyValue(vector<char>& keyValues, const char* key, const char* value)
+{
+	size_t start = keyValues.size(); // Offset of the size field
+	keyValues.resize(start + 4);
+	keyValues.insert(keyValues.end(), key, key + strlen(key) + 1); // Includes '\0'
+	keyValues.insert(keyValues.end(), value, value + strlen(value) + 1);
+	uint32_t pairSize = (uint32_t)(keyValues.size() - start - 4); // Bytes of key + value
+	memcpy(&keyValues[start], &pairSize, 4);
+	keyValues.resize((keyValues.size() + 3) & ~(size_t)3, 0); // Pad to 4 bytes
+}
+
+// Writes a baked file. levels[i] holds the blocks of mip level i. bumpLayout marks a --bump bake so the loader can
+// tell it from a plain RGB bake of the same height map. Written to a temp file and renamed, like the mesh cache.
+inline bool WriteKtx(const string& path, GLenum internalFormat, GLenum baseFormat, GLsizei width, GLsizei height,
+	const vector<vector<unsigned char> >& levels, bool rowsUp, bool bumpLayout = false)
+{
+	KtxHeader header; // File header
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER));
+	header.endianness = KTX_ENDIANNESS;
+	header.glTypeSize = 1;
+	header.glInternalFormat = internalFormat;
+	header.glBaseInternalFormat = baseFormat;
+	header.pixelWidth = width;
+	header.pixelHeight = height;
+	header.numberOfFaces = 1;
+	header.numberOfMipmapLevels = (uint32_t)levels.size();
+
+	vector<char> keyValues; // Key/value pairs
+	AppendKtxKeyValue(keyValues, KTX_ORIENTATION_KEY, rowsUp ? KTX_ROWS_UP : KTX_ROWS_DOWN); // Row order of the baked blocks
+	if (bumpLayout)
+		AppendKtxKeyValue(keyValues, KTX_BUMP_LAYOUT_KEY, KTX_BUMP_LAYOUT);
+	header.bytesOfKeyValueData = (uint32_t)keyValues.size();
+
+	string tempPath = path + ".tmp"; // Written first, renamed on success
+	ofstream out(tempPath.c_str(), ios::binary | ios::trunc); // Open temp file
+	if (!out) {
+		cerr << "ERROR::KTX::CANNOT_WRITE " << tempPath << endl;
+		return false;
+	}
+	out.write((const char*)&header, sizeof(header)); // Header
+	out.write(keyValues.data(), keyValues.size()); // Orientation (+ bump layout)
+	for (size_t i = 0; i < levels.size(); i++)
+	{
+		uint32_t imageSize = (uint32_t)levels[i].size(); // Bytes in this level
+		out.write((const char*)&imageSize, 4);
+		out.write((const char*)levels[i].data(), imageSize);
+	}
+	out.close(); // Flush
+	if (!out || rename(tempPath.c_str(), path.c_str()) != 0) { // Publish atomically
+		cerr << "ERROR::KTX::CANNOT_WRITE " << path << endl;
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
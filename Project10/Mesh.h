@@ -5,11 +5,16 @@
 #include <sstream> // Include sstream
 #include <iostream> // Include iostream
 #include <vector> // Include vector
+#include <cmath> // Include cmath for fabs
+#include <algorithm> // Include min/max
 using namespace std; // Use namespace std
 // GL Includes
 #include <GL/glew.h> // Contains all the necessery OpenGL includes
 #include <glm/glm.hpp> // Include glm
 #include <glm/gtc/matrix_transform.hpp> // Include matrix transform
+#include <glm/gtc/packing.hpp> // Include half/snorm packing
+
+#include "GLHandle.h" // Include move-only VAO/buffer owners
 
 
 // Define vertex structure
@@ -26,6 +31,63 @@ struct Vertex {
     glm::vec3 Bitangent; // Vec3 bitangent
 };
 
+// Layout a Mesh uploads its vertices in
+enum Vertex_Format {
+    VERTEX_FULL, // Vertex as-is: every attribute a 32-bit float (56 bytes)
+    VERTEX_PACKED // PackedVertex: half UVs, octahedral normal/tangent, bitangent rebuilt in the shader (24 bytes)
+};
+
+// Compact GPU-side vertex. Only used for the upload; the CPU copy in Mesh::vertices stays a full Vertex.
+struct PackedVertex {
+    glm::vec3 Position; // Vec3 position (kept full precision, models are not normalized to a unit box)
+    GLuint TexCoords; // Two half floats (GL_HALF_FLOAT), still fine for tiled UVs outside [0, 1]
+    GLuint Normal; // Octahedral normal as two 16-bit snorm values
+    GLuint Tangent; // Octahedral tangent in x/y of a 10:10:10:2 snorm word, bitangent handedness in w
+};
+
+// Maps a unit vector onto the [-1, 1] square of an octahedron folded flat (2 values instead of 3)
+inline glm::vec2 OctahedralEncode(glm::vec3 n)
+{
+    n /= (fabs(n.x) + fabs(n.y) + fabs(n.z)); // Project onto the octahedron
+    glm::vec2 encoded(n.x, n.y); // Upper hemisphere maps directly
+    if (n.z < 0.0f) { // Lower hemisphere folds over the diagonals
+        encoded.x = (1.0f - fabs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        encoded.y = (1.0f - fabs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return encoded;
+}
+
+// Converts a full vertex to the packed layout. The bitangent is reduced to a sign: the shaders rebuild it
+// as cross(N, T) * sign, which is exact for the orthogonal frames the bump/parallax shaders use anyway.
+inline PackedVertex PackVertex(const Vertex& vertex)
+{
+    glm::vec3 normal = vertex.Normal; // Normal to encode
+    if (!(glm::length(normal) > 0.0f)) // Zero or NaN
+        normal = glm::vec3(0.0f, 0.0f, 1.0f);
+    normal = glm::normalize(normal);
+    glm::vec3 tangent = vertex.Tangent; // Tangent to encode
+    if (!(glm::length(tangent) > 0.0f)) // Degenerate UVs leave no tangent, pick any perpendicular
+        tangent = (fabs(normal.x) < 0.9f) ? glm::cross(normal, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(normal, glm::vec3(0.0f, 1.0f, 0.0f));
+    tangent = glm::normalize(tangent);
+    float handedness = (glm::dot(glm::cross(normal, tangent), vertex.Bitangent) < 0.0f) ? -1.0f : 1.0f; // Mirrored UVs flip B
+
+    PackedVertex packed; // Output
+    packed.Position = vertex.Position; // Position unchanged
+    packed.TexCoords = glm::packHalf2x16(vertex.TexCoords); // 2 x half
+    packed.Normal = glm::packSnorm2x16(OctahedralEncode(normal)); // 2 x snorm16
+    glm::vec2 octTangent = OctahedralEncode(tangent); // 2 x snorm10 + sign
+    packed.Tangent = glm::packSnorm3x10_1x2(glm::vec4(octTangent.x, octTangent.y, 0.0f, handedness));
+    return packed;
+}
+
+// One level of detail: a range of the mesh's index buffer plus the object-space error it introduces.
+// All levels index the same vertex buffer, LOD 0 is the full mesh.
+struct MeshLod {
+    GLuint indexOffset; // First index of the level
+    GLuint indexCount; // Number of indices in the level
+    float error; // Max geometric error vs LOD 0 (object units), used for screen-space LOD selection
+};
+
 // Define texture structure
 struct Texture {
     GLuint id; // GLuint for id
@@ -37,25 +99,107 @@ class Mesh {  // Provided in class
 public:
     /*  Mesh Data  */
     vector<Vertex> vertices; // vector of vertices
-    vector<GLuint> indices; // vector of indices
+    vector<GLuint> indices; // vector of indices (every LOD, LOD 0 first)
     vector<Texture> textures; // vector of textures
+    vector<MeshLod> lods; // Index ranges per level of detail
+    glm::vec3 BoundsMin; // Object-space AABB minimum
+    glm::vec3 BoundsMax; // Object-space AABB maximum
+    glm::vec3 BoundsCenter; // Object-space bounding sphere center
+    float BoundsRadius; // Object-space bounding sphere radius
 
     /*  Functions  */
-    // Constructor
-    Mesh(vector<Vertex> vertices, vector<GLuint> indices, vector<Texture> textures) // Input constructor
+    // Constructor. format picks the GPU vertex layout (see Vertex_Format); shaders read it from packedVertices.
+    // lods describes the ranges of indices; when empty the whole index list is a single level.
+    // Without upload no GL objects are created: the mesh only describes a part of a merged Model (see Model.h).
+    // The vectors are moved in, pass them with move() to avoid copying the geometry; the mesh keeps them as its
+    // CPU copy until ReleaseGeometry.
+    Mesh(vector<Vertex> vertices, vector<GLuint> indices, vector<Texture> textures, Vertex_Format format = VERTEX_FULL, vector<MeshLod> lods = vector<MeshLod>(), bool upload = true) // Input constructor
     {
-        this->vertices = vertices; // Set vertices equal to input
-        this->indices = indices; // Set indices equal to input
-        this->textures = textures; // Set textures equal to input
+        this->vertices = move(vertices); // Take over the vertices
+        this->indices = move(indices); // Take over the indices
+        this->textures = move(textures); // Take over the textures
+        this->format = format; // Set upload layout
+        this->lods = move(lods); // Set LOD ranges
 
         // Now that we have all the required data, set the vertex buffers and its attribute pointers.
-        this->setupMesh(); // Call class setupMesh() method
+        this->setupMesh(upload); // Call class setupMesh() method
+    }
+
+    // Constructor for pre-baked geometry (e.g. a mapped mesh cache). Uploads straight from the given
+    // pointers and keeps no CPU copy, so vertices/indices stay empty for meshes built this way.
+    Mesh(const Vertex* vertexData, GLuint vertexCount, const GLuint* indexData, GLuint indexCount, vector<Texture> textures, Vertex_Format format = VERTEX_FULL, vector<MeshLod> lods = vector<MeshLod>(), bool upload = true)
+    {
+        this->textures = move(textures); // Take over the textures
+        this->format = format; // Set upload layout
+        this->lods = move(lods); // Set LOD ranges
+        this->setupMesh(vertexData, vertexCount, indexData, indexCount, upload); // Upload directly from the given data
+    }
+
+    // Move-only: the mesh owns its VAO and buffers (deleted with the mesh), a copy would delete them twice
+    Mesh(Mesh&&) = default;
+    Mesh& operator=(Mesh&&) = default;
+    Mesh(const Mesh&) = delete;
+    Mesh& operator=(const Mesh&) = delete;
+
+    // Frees the CPU copy of vertices and indices once nothing needs them any more (the GPU keeps its own).
+    // Bounds, LODs and draws keep working; only CPU-side queries on vertices/indices lose their data.
+    void ReleaseGeometry()
+    {
+        vector<Vertex>().swap(this->vertices); // Swap to actually return the memory
+        vector<GLuint>().swap(this->indices);
     }
 
-    // Render the mesh
-    void Draw(Shader shader) 
+    // Number of levels of detail
+    GLuint LodCount() const
+    {
+        return (GLuint)this->lods.size();
+    }
+
+    // Triangles Draw submits at a level of detail (clamped like Draw)
+    GLuint TriangleCount(GLuint lod) const
+    {
+        return this->lods[min(lod, (GLuint)this->lods.size() - 1)].indexCount / 3;
+    }
+
+    // Vertex array holding the mesh, for callers that issue the draw themselves (RenderQueue)
+    GLuint VertexArray() const
+    {
+        return this->VAO.Get();
+    }
+
+    // Layout of the uploaded vertices (the shaders' packedVertices uniform)
+    Vertex_Format Format() const
+    {
+        return this->format;
+    }
+
+    // Index range of a level of detail (clamped like Draw)
+    const MeshLod& Lod(GLuint lod) const
+    {
+        return this->lods[min(lod, (GLuint)this->lods.size() - 1)];
+    }
+
+    // Render the mesh at a level of detail (clamped to the coarsest level available)
+    void Draw(Shader& shader, GLuint lod = 0)
+    {
+        this->BindTextures(shader); // Bind appropriate textures
+        
+        // Also set each mesh's shininess property to a default value (if you want you could extend this to another mesh property and possibly change this value)
+        shader.SetFloat("material.shininess", 16.0f);
+        shader.SetInt("packedVertices", this->format == VERTEX_PACKED); // Tell the vertex shader how to decode attributes
+
+        // Draw mesh
+        glBindVertexArray(this->VAO.Get()); // Bind VAO
+        const MeshLod& level = this->lods[min(lod, (GLuint)this->lods.size() - 1)]; // Selected level
+        glDrawElements(GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT, (GLvoid*)(level.indexOffset * sizeof(GLuint))); // Draw GL_TRIANGLES
+        glBindVertexArray(0); // Bind 0
+
+        this->UnbindTextures(); // Always good practice to set everything back to defaults once configured.
+    }
+
+    // Binds the mesh's textures to units 0, 1, ... and points the texture_diffuseN/texture_specularN samplers at them
+    void BindTextures(Shader& shader) const
     {
-        // Bind appropriate textures
         GLuint diffuseNr = 1; // Set diffuseNr
         GLuint specularNr = 1; // Set specularNr
         for(GLuint i = 0; i < this->textures.size(); i++) // Iterate over textures
@@ -71,20 +215,15 @@ public:
                 ss << specularNr++; // Transfer GLuint to stream
             number = ss.str(); // Set number equal to string of ss
             // Now set the sampler to the correct texture unit
-            glUniform1i(glGetUniformLocation(shader.Program, (name + number).c_str()), i); // Set sampler to texture unit
+            shader.SetInt(name + number, i); // Set sampler to texture unit (cached location)
             // And finally bind the texture
             glBindTexture(GL_TEXTURE_2D, this->textures[i].id); // Bind
         }
-        
-        // Also set each mesh's shininess property to a default value (if you want you could extend this to another mesh property and possibly change this value)
-        glUniform1f(glGetUniformLocation(shader.Program, "material.shininess"), 16.0f);
-
-        // Draw mesh
-        glBindVertexArray(this->VAO); // Bind VAO
-        glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0); // Draw GL_TRIANGLES
-        glBindVertexArray(0); // Bind 0
+    }
 
-        // Always good practice to set everything back to defaults once configured.
+    // Unbinds what BindTextures bound
+    void UnbindTextures() const
+    {
         for (GLuint i = 0; i < this->textures.size(); i++)
         {
             glActiveTexture(GL_TEXTURE0 + i); // Reset active texture
@@ -94,27 +233,53 @@ public:
 
 private:
     /*  Render data  */
-    GLuint VAO, VBO, EBO; // Initialize VAO, VBO, EBO
+    GLVertexArray VAO; // Owned VAO, deleted with the mesh
+    GLBuffer VBO, EBO; // Owned vertex and index buffers
+    GLuint indexCount; // Number of indices uploaded to the EBO (all levels)
+    Vertex_Format format; // Layout of the uploaded vertices
 
     /*  Functions    */
-    // Initializes all the buffer objects/arrays
-    void setupMesh()
+    // Initializes all the buffer objects/arrays from the member vectors
+    void setupMesh(bool upload)
     {
+        this->setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size(), upload); // Upload member data
+    }
+
+    // Initializes all the buffer objects/arrays from raw vertex/index data (only LODs and bounds without upload)
+    void setupMesh(const Vertex* vertexData, GLuint vertexCount, const GLuint* indexData, GLuint indexCount, bool upload)
+    {
+        this->indexCount = indexCount; // Remember index count for Draw
+        if (this->lods.empty()) { // Single level covering every index
+            MeshLod full; // LOD 0
+            full.indexOffset = 0;
+            full.indexCount = indexCount;
+            full.error = 0.0f;
+            this->lods.push_back(full);
+        }
+        this->computeBounds(vertexData, vertexCount); // Bounds for LOD selection and culling
+        if (!upload) // Drawn from the Model's merged buffers
+            return;
         // Create buffers/arrays
-        glGenVertexArrays(1, &this->VAO); // Create VAO array
-        glGenBuffers(1, &this->VBO); // Create VBO buffer
-        glGenBuffers(1, &this->EBO); // Create EBO buffer
+        this->VAO.Create(); // Create VAO array
+        this->VBO.Create(); // Create VBO buffer
+        this->EBO.Create(); // Create EBO buffer
 
-        glBindVertexArray(this->VAO); // Bind vertex array
+        glBindVertexArray(this->VAO.Get()); // Bind vertex array
         // Load data into vertex buffers
-        glBindBuffer(GL_ARRAY_BUFFER, this->VBO); // Bind buffer
+        glBindBuffer(GL_ARRAY_BUFFER, this->VBO.Get()); // Bind buffer
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO.Get()); // Bind EBO buffer
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLuint), indexData, GL_STATIC_DRAW); // Set buffer data
+
+        if (this->format == VERTEX_PACKED) {
+            this->setupPackedAttributes(vertexData, vertexCount); // Convert and upload the compact layout
+            glBindVertexArray(0); // Bind 0
+            return;
+        }
+
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(Vertex), &this->vertices[0], GL_STATIC_DRAW);   // Set buffer data
-
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO); // Bind EBO buffer
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), &this->indices[0], GL_STATIC_DRAW); // Set buffer data
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);   // Set buffer data
 
         // Set the vertex attribute pointers
         // Vertex Positions
@@ -135,5 +300,50 @@ private:
 
         glBindVertexArray(0); // Bind 0
     }
+
+    // AABB, plus a bounding sphere around the AABB center (cheap and close enough for LOD distances and culling)
+    void computeBounds(const Vertex* vertexData, GLuint vertexCount)
+    {
+        glm::vec3 minimum(0.0f), maximum(0.0f); // AABB
+        for (GLuint i = 0; i < vertexCount; i++)
+        {
+            const glm::vec3& p = vertexData[i].Position;
+            if (i == 0) { minimum = p; maximum = p; }
+            minimum = glm::vec3(min(minimum.x, p.x), min(minimum.y, p.y), min(minimum.z, p.z));
+            maximum = glm::vec3(max(maximum.x, p.x), max(maximum.y, p.y), max(maximum.z, p.z));
+        }
+        this->BoundsMin = minimum; // Keep AABB
+        this->BoundsMax = maximum;
+        this->BoundsCenter = (minimum + maximum) * 0.5f; // AABB center
+        this->BoundsRadius = 0.0f;
+        for (GLuint i = 0; i < vertexCount; i++) // Farthest vertex from the center
+            this->BoundsRadius = max(this->BoundsRadius, glm::length(vertexData[i].Position - this->BoundsCenter));
+    }
+
+    // Packs the vertices and points the attributes at the compact layout. Attribute locations match the full
+    // layout so the same shaders work with both: normal and tangent arrive as octahedral x/y (tangent.w is the
+    // handedness) and the bitangent array stays disabled.
+    void setupPackedAttributes(const Vertex* vertexData, GLuint vertexCount)
+    {
+        vector<PackedVertex> packed(vertexCount); // Compact copy, only needed for the upload
+        for (GLuint i = 0; i < vertexCount; i++) // Iterate over vertices
+            packed[i] = PackVertex(vertexData[i]); // Pack vertex
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(PackedVertex), packed.data(), GL_STATIC_DRAW); // Set buffer data
+
+        // Vertex Positions
+        glEnableVertexAttribArray(0); // Enable vertex attrib
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(PackedVertex), (GLvoid*)0); // Set vertex attrib for position
+        // Vertex Normals (octahedral, snorm16 x 2)
+        glEnableVertexAttribArray(1); // Enable vertex attrib
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, Normal)); // Set vertex attrib for normal
+        // Vertex Texture Coords (half x 2)
+        glEnableVertexAttribArray(2); // Enable vertex attrib
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, TexCoords)); // Set vertex attrib for texcoords
+        // Vertex Tangents (octahedral + handedness, 10:10:10:2)
+        glEnableVertexAttribArray(3); // Enable vertex attrib
+        glVertexAttribPointer(3, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex), (GLvoid*)offsetof(PackedVertex, Tangent)); // Set vertex attrib for tangent
+        // Vertex Bitangents are rebuilt in the shader
+        glDisableVertexAttribArray(4); // Disable vertex attrib
+    }
 };
 
@@ -0,0 +1,371 @@
+#pragma once
+// Std. Includes
+#include <vector> // Include vector
+#include <iostream> // Include iostream
+#include <algorithm> // Include sort
+#include <unordered_map> // Include unordered_map
+#include <cstring> // Include memcpy/memcmp
+#include <cstdint> // Include fixed width integer types
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <glm/glm.hpp> // Include glm
+
+#include "Mesh.h" // Include Mesh.h for Vertex
+
+// Post-load mesh optimization run by Model::processMesh before the mesh is uploaded (and baked into the mesh cache).
+// Steps, in order:
+// 1. Weld:         merge vertices with identical position/normal/UV (OBJ import gives every face corner its own vertex).
+//                  Runs before tangent generation so shared vertices accumulate tangents from all their triangles.
+// 2. Vertex cache: Tipsify (Sander et al. 2007) triangle reordering for post-transform cache locality.
+// 3. Overdraw:     split the Tipsify order into clusters and draw outward-facing clusters first, accepting a
+//                  small ACMR loss (overdrawThreshold) in exchange for better early-z rejection.
+// 4. Fetch:        renumber vertices in first-use order so vertex fetch walks memory linearly.
+// ACMR (cache misses per triangle) and ATVR (misses per vertex) come from a FIFO cache simulation and are
+// printed before/after every step when report is set.
+
+struct MeshOptimizerOptions {
+	bool weld = true; // Merge duplicate vertices
+	bool vertexCache = true; // Tipsify reordering
+	bool overdraw = true; // Cluster sort for overdraw (needs vertexCache)
+	bool fetch = true; // First-use vertex renumbering
+	bool report = true; // Print ACMR/ATVR per step
+	GLuint cacheSize = 16; // Simulated post-transform cache size (FIFO entries)
+	float overdrawThreshold = 1.05f; // Max ACMR growth allowed by the overdraw step
+};
+
+struct VertexCacheStats {
+	float acmr; // Average cache miss ratio: transformed vertices per triangle (0.5 ideal, 3.0 worst)
+	float atvr; // Average transformed vertex ratio: transformed vertices per unique vertex (1.0 ideal)
+};
+
+// Simulates a FIFO post-transform cache over the index list
+inline VertexCacheStats AnalyzeVertexCache(const vector<GLuint>& indices, size_t vertexCount, GLuint cacheSize)
+{
+	vector<uint32_t> cachedAt(vertexCount, 0); // Miss counter value when each vertex entered the cache (0 = never)
+	vector<bool> used(vertexCount, false); // Referenced vertices, for ATVR
+	uint32_t misses = 0; // Transformed vertices
+	size_t uniqueCount = 0; // Referenced vertex count
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		GLuint v = indices[i]; // Vertex
+		if (!used[v]) { used[v] = true; uniqueCount++; }
+		if (cachedAt[v] == 0 || misses - cachedAt[v] >= cacheSize) { // Not in the last cacheSize misses -> evicted
+			misses++;
+			cachedAt[v] = misses; // Enters the FIFO
+		}
+	}
+	VertexCacheStats stats; // Result
+	size_t triangleCount = indices.size() / 3;
+	stats.acmr = triangleCount ? (float)misses / triangleCount : 0.0f;
+	stats.atvr = uniqueCount ? (float)misses / uniqueCount : 0.0f;
+	return stats;
+}
+
+// Prints one report line for an optimization step
+inline void ReportMeshOptimizerStep(const char* step, VertexCacheStats before, VertexCacheStats after)
+{
+	cout << "MESHOPT::" << step << " ACMR " << before.acmr << " -> " << after.acmr
+		<< ", ATVR " << before.atvr << " -> " << after.atvr << endl;
+}
+
+// Merges vertices whose position, normal and texture coordinates are bitwise identical
+inline void WeldVertices(vector<Vertex>& vertices, vector<GLuint>& indices, const MeshOptimizerOptions& options)
+{
+	VertexCacheStats before; // Stats before welding
+	if (options.report)
+		before = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize);
+
+	struct WeldKey { float data[8]; }; // Position, normal, UV
+	struct WeldHash {
+		size_t operator()(const WeldKey& key) const {
+			uint32_t bits[8]; // Raw float bits
+			memcpy(bits, key.data, sizeof(bits));
+			size_t hash = 2166136261u; // FNV-1a over the 8 words
+			for (int i = 0; i < 8; i++)
+				hash = (hash ^ bits[i]) * 16777619u;
+			return hash;
+		}
+	};
+	struct WeldEqual {
+		bool operator()(const WeldKey& a, const WeldKey& b) const { return memcmp(a.data, b.data, sizeof(a.data)) == 0; }
+	};
+
+	unordered_map<WeldKey, GLuint, WeldHash, WeldEqual> unique; // Key -> welded index
+	unique.reserve(vertices.size());
+	vector<GLuint> remap(vertices.size()); // Old index -> welded index
+	vector<Vertex> welded; // Welded vertices
+	welded.reserve(vertices.size());
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		WeldKey key; // Attributes that define a vertex before tangents exist
+		memcpy(key.data, &vertices[i].Position, sizeof(glm::vec3));
+		memcpy(key.data + 3, &vertices[i].Normal, sizeof(glm::vec3));
+		memcpy(key.data + 6, &vertices[i].TexCoords, sizeof(glm::vec2));
+		pair<unordered_map<WeldKey, GLuint, WeldHash, WeldEqual>::iterator, bool> result = unique.insert(make_pair(key, (GLuint)welded.size()));
+		if (result.second) // First time seen
+			welded.push_back(vertices[i]);
+		remap[i] = result.first->second;
+	}
+	for (size_t i = 0; i < indices.size(); i++)
+		indices[i] = remap[indices[i]]; // Point at welded vertices
+	size_t originalCount = vertices.size();
+	vertices.swap(welded);
+
+	if (options.report) {
+		ReportMeshOptimizerStep("WELD", before, AnalyzeVertexCache(indices, vertices.size(), options.cacheSize));
+		cout << "MESHOPT::WELD vertices " << originalCount << " -> " << vertices.size() << endl;
+	}
+}
+
+// Tipsify triangle reordering. Fans around the most recently cached vertex that will still be in the cache
+// after its remaining triangles are emitted, falling back to a dead-end stack and then a linear scan.
+// hardBoundaries receives the triangle offsets where the walk had to jump (used by the overdraw step).
+inline void OptimizeVertexCache(vector<GLuint>& indices, size_t vertexCount, GLuint cacheSize, vector<size_t>* hardBoundaries)
+{
+	size_t triangleCount = indices.size() / 3; // Triangles
+	if (triangleCount == 0)
+		return;
+
+	// Vertex -> triangle adjacency (compressed rows)
+	vector<GLuint> live(vertexCount, 0); // Unemitted triangles per vertex
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		live[indices[i]]++;
+	vector<size_t> offsets(vertexCount + 1, 0); // Row starts
+	for (size_t v = 0; v < vertexCount; v++)
+		offsets[v + 1] = offsets[v] + live[v];
+	vector<GLuint> adjacency(triangleCount * 3); // Triangle ids
+	vector<size_t> fill(offsets.begin(), offsets.end() - 1); // Write cursors
+	for (size_t t = 0; t < triangleCount; t++)
+		for (int c = 0; c < 3; c++)
+			adjacency[fill[indices[t * 3 + c]]++] = (GLuint)t;
+
+	vector<uint32_t> cacheTime(vertexCount, 0); // Timestamp when the vertex last entered the cache
+	vector<bool> emitted(triangleCount, false); // Triangles already output
+	vector<GLuint> deadEnd; // Recently used vertices to resume from
+	vector<GLuint> candidates; // 1-ring of the current fan
+	vector<GLuint> output; // Reordered indices
+	output.reserve(triangleCount * 3);
+	uint32_t time = cacheSize + 1; // Current timestamp
+	size_t cursor = 0; // Linear scan position for fallback
+	long fan = 0; // Current fanning vertex
+	while (fan >= 0 && cursor < vertexCount)
+	{
+		candidates.clear();
+		for (size_t a = offsets[fan]; a < offsets[fan + 1]; a++) // Emit every remaining triangle around fan
+		{
+			GLuint t = adjacency[a]; // Triangle
+			if (emitted[t])
+				continue;
+			for (int c = 0; c < 3; c++)
+			{
+				GLuint v = indices[t * 3 + c]; // Corner
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+				if (time - cacheTime[v] > cacheSize) { // Cache miss
+					cacheTime[v] = time;
+					time++;
+				}
+			}
+			emitted[t] = true;
+		}
+
+		// Next fan: the candidate that stays cached longest after its remaining triangles are emitted
+		long best = -1; // Best candidate
+		long bestPriority = -1; // Its priority
+		for (size_t c = 0; c < candidates.size(); c++)
+		{
+			GLuint v = candidates[c];
+			if (live[v] == 0)
+				continue;
+			long priority = 0; // Not cached after fanning -> lowest priority
+			if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+				priority = time - cacheTime[v]; // Age in cache
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = v;
+			}
+		}
+		if (best == -1) { // Dead end: resume from the stack, then scan linearly
+			if (hardBoundaries && !output.empty() && output.size() < triangleCount * 3)
+				hardBoundaries->push_back(output.size() / 3);
+			while (!deadEnd.empty() && best == -1) {
+				GLuint v = deadEnd.back();
+				deadEnd.pop_back();
+				if (live[v] > 0)
+					best = v;
+			}
+			while (best == -1 && cursor < vertexCount) {
+				if (live[cursor] > 0)
+					best = (long)cursor;
+				else
+					cursor++;
+			}
+		}
+		fan = best;
+	}
+	indices.swap(output);
+}
+
+// Splits the Tipsify order into clusters (at the hard boundaries, and further wherever the cluster so far is
+// already as cache friendly as the whole cluster) and sorts them so clusters facing away from the mesh center
+// are drawn first. Keeps the new order only when ACMR grows by at most threshold.
+inline void OptimizeOverdraw(vector<GLuint>& indices, const vector<Vertex>& vertices, const vector<size_t>& hardBoundaries, GLuint cacheSize, float threshold)
+{
+	size_t triangleCount = indices.size() / 3; // Triangles
+	if (triangleCount == 0)
+		return;
+
+	// Cluster boundaries in triangle offsets
+	vector<size_t> hard(hardBoundaries); // Hard boundaries from Tipsify
+	hard.insert(hard.begin(), 0);
+	hard.push_back(triangleCount);
+	vector<size_t> boundaries; // Final cluster starts
+	vector<uint32_t> cachedAt(vertices.size(), 0); // FIFO simulation: miss counter when each vertex was cached
+	uint32_t misses = 0; // Global miss counter, never reset so cachedAt needs no clearing
+	// Simulates triangle t against a cache that was flushed when the counter was at base; returns its misses
+	auto simulate = [&](size_t t, uint32_t base) {
+		uint32_t triangleMisses = 0;
+		for (int c = 0; c < 3; c++)
+		{
+			GLuint v = indices[t * 3 + c];
+			if (cachedAt[v] <= base || misses - cachedAt[v] >= cacheSize) { // Cached before the flush, or evicted
+				misses++;
+				triangleMisses++;
+				cachedAt[v] = misses;
+			}
+		}
+		return triangleMisses;
+	};
+	for (size_t h = 0; h + 1 < hard.size(); h++)
+	{
+		size_t begin = hard[h], end = hard[h + 1]; // Hard cluster
+		if (begin >= end)
+			continue;
+		uint32_t base = misses; // Fresh cache for the hard cluster
+		uint32_t clusterMisses = 0; // Misses over the whole hard cluster
+		for (size_t t = begin; t < end; t++)
+			clusterMisses += simulate(t, base);
+		float clusterAcmr = (float)clusterMisses / (float)(end - begin); // Whole-cluster ACMR
+
+		// Soft boundaries: end a cluster once its running ACMR is within threshold of the hard cluster's
+		base = misses; // Fresh cache for the first soft cluster
+		uint32_t softMisses = 0; // Misses in the current soft cluster
+		size_t start = begin; // Current soft cluster start
+		boundaries.push_back(begin);
+		for (size_t t = begin; t < end; t++)
+		{
+			softMisses += simulate(t, base);
+			float running = (float)softMisses / (float)(t - start + 1); // Cluster ACMR so far
+			if (t + 1 < end && running <= clusterAcmr * threshold) { // Good enough: start a new cluster
+				start = t + 1;
+				base = misses;
+				softMisses = 0;
+				boundaries.push_back(start);
+			}
+		}
+	}
+	boundaries.push_back(triangleCount);
+
+	// Mesh centroid (area weighted)
+	glm::vec3 meshCenter(0.0f); // Centroid
+	float meshArea = 0.0f; // Total area
+	for (size_t t = 0; t < triangleCount; t++)
+	{
+		glm::vec3 a = vertices[indices[t * 3]].Position, b = vertices[indices[t * 3 + 1]].Position, c = vertices[indices[t * 3 + 2]].Position;
+		float area = glm::length(glm::cross(b - a, c - a)); // Twice the area
+		meshCenter += (a + b + c) * (area / 3.0f);
+		meshArea += area;
+	}
+	if (meshArea > 0.0f)
+		meshCenter /= meshArea;
+
+	// Sort key per cluster: how much it faces away from the centroid
+	struct Cluster { size_t begin, end; float key; };
+	vector<Cluster> clusters; // Soft clusters
+	for (size_t i = 0; i + 1 < boundaries.size(); i++)
+	{
+		Cluster cluster; // Cluster
+		cluster.begin = boundaries[i];
+		cluster.end = boundaries[i + 1];
+		glm::vec3 center(0.0f), normal(0.0f); // Area weighted centroid and normal
+		float area = 0.0f;
+		for (size_t t = cluster.begin; t < cluster.end; t++)
+		{
+			glm::vec3 a = vertices[indices[t * 3]].Position, b = vertices[indices[t * 3 + 1]].Position, c = vertices[indices[t * 3 + 2]].Position;
+			glm::vec3 n = glm::cross(b - a, c - a); // Length is twice the area
+			float triangleArea = glm::length(n);
+			center += (a + b + c) * (triangleArea / 3.0f);
+			normal += n;
+			area += triangleArea;
+		}
+		if (area > 0.0f)
+			center /= area;
+		float normalLength = glm::length(normal);
+		cluster.key = (normalLength > 0.0f) ? glm::dot(center - meshCenter, normal / normalLength) : 0.0f;
+		clusters.push_back(cluster);
+	}
+	stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.key > b.key; }); // Outward first
+
+	vector<GLuint> sorted; // Reordered indices
+	sorted.reserve(indices.size());
+	for (size_t i = 0; i < clusters.size(); i++)
+		sorted.insert(sorted.end(), indices.begin() + clusters[i].begin * 3, indices.begin() + clusters[i].end * 3);
+
+	float before = AnalyzeVertexCache(indices, vertices.size(), cacheSize).acmr; // Tipsify ACMR
+	float after = AnalyzeVertexCache(sorted, vertices.size(), cacheSize).acmr; // Sorted ACMR
+	if (after <= before * threshold) // Within budget
+		indices.swap(sorted);
+}
+
+// Renumbers vertices in the order the index buffer first touches them and drops unreferenced ones
+inline void OptimizeVertexFetch(vector<Vertex>& vertices, vector<GLuint>& indices)
+{
+	const GLuint unused = ~0u; // Not yet assigned
+	vector<GLuint> remap(vertices.size(), unused); // Old -> new index
+	vector<Vertex> ordered; // Vertices in first-use order
+	ordered.reserve(vertices.size());
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		GLuint& slot = remap[indices[i]];
+		if (slot == unused) { // First use
+			slot = (GLuint)ordered.size();
+			ordered.push_back(vertices[indices[i]]);
+		}
+		indices[i] = slot;
+	}
+	vertices.swap(ordered);
+}
+
+// Runs the reordering steps (2-4) on a welded mesh with tangents already generated
+inline void OptimizeMesh(vector<Vertex>& vertices, vector<GLuint>& indices, const MeshOptimizerOptions& options)
+{
+	VertexCacheStats before = {0.0f, 0.0f}; // Stats before each step
+	if (options.report)
+		before = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize);
+
+	vector<size_t> hardBoundaries; // Tipsify jump points, for the overdraw clusters
+	if (options.vertexCache) {
+		OptimizeVertexCache(indices, vertices.size(), options.cacheSize, &hardBoundaries);
+		if (options.report) {
+			VertexCacheStats after = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize);
+			ReportMeshOptimizerStep("VERTEX_CACHE", before, after);
+			before = after;
+		}
+		if (options.overdraw) {
+			OptimizeOverdraw(indices, vertices, hardBoundaries, options.cacheSize, options.overdrawThreshold);
+			if (options.report) {
+				VertexCacheStats after = AnalyzeVertexCache(indices, vertices.size(), options.cacheSize);
+				ReportMeshOptimizerStep("OVERDRAW", before, after);
+				before = after;
+			}
+		}
+	}
+	if (options.fetch) {
+		OptimizeVertexFetch(vertices, indices);
+		if (options.report) // Cache behaviour is unchanged by renumbering, but unreferenced vertices are gone
+			ReportMeshOptimizerStep("FETCH", before, AnalyzeVertexCache(indices, vertices.size(), options.cacheSize));
+	}
+}
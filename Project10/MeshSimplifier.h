@@ -0,0 +1,391 @@
+#pragma once
+// Std. Includes
+#include <vector> // Include vector
+#include <queue> // Include priority_queue
+#include <algorithm> // Include sort/unique/set_intersection
+#include <iterator> // Include back_inserter
+#include <unordered_map> // Include unordered_map
+#include <cmath> // Include sqrt
+#include <cstring> // Include memcpy
+#include <cstdint> // Include fixed width integer types
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <glm/glm.hpp> // Include glm
+
+#include "Mesh.h" // Include Mesh.h for Vertex and MeshLod
+#include "MeshOptimizer.h" // Include vertex cache reordering for the LOD index lists
+
+// Quadric error metric simplification (Garland & Heckbert 1997) used to build LOD chains at load time.
+// Collapses are half-edge collapses onto existing vertices, so every LOD is just another index list over the
+// same vertex buffer: positions, UVs and tangent frames are never interpolated or recomputed.
+// Vertices on UV/normal seams (several vertices sharing a position) and on open borders are locked, so seams
+// cannot tear and silhouettes of open meshes stay put.
+
+const GLuint LOD_MAX_LEVELS = 4; // LOD 0 (full mesh) + up to 3 simplified levels
+const float LOD_REDUCTION = 0.5f; // Each level targets this fraction of the previous level's triangles
+const float LOD_MIN_GAIN = 0.9f; // A level that keeps more than this fraction of triangles is not worth adding
+const float LOD_FLIP_LIMIT = 0.2f; // Minimum cos between a face normal before and after a collapse
+const float LOD_MAX_ERROR = 0.1f; // Largest error any level may reach, as a fraction of the mesh's bounding box diagonal
+
+// Symmetric 4x4 quadric stored as its 10 unique coefficients
+struct Quadric {
+	double a2, ab, ac, ad, b2, bc, bd, c2, cd, d2; // Plane products
+
+	Quadric() : a2(0), ab(0), ac(0), ad(0), b2(0), bc(0), bd(0), c2(0), cd(0), d2(0) {}
+
+	// Quadric of the plane ax + by + cz + d = 0
+	static Quadric FromPlane(double a, double b, double c, double d)
+	{
+		Quadric q; // Result
+		q.a2 = a * a; q.ab = a * b; q.ac = a * c; q.ad = a * d;
+		q.b2 = b * b; q.bc = b * c; q.bd = b * d;
+		q.c2 = c * c; q.cd = c * d;
+		q.d2 = d * d;
+		return q;
+	}
+
+	void Add(const Quadric& o)
+	{
+		a2 += o.a2; ab += o.ab; ac += o.ac; ad += o.ad; b2 += o.b2;
+		bc += o.bc; bd += o.bd; c2 += o.c2; cd += o.cd; d2 += o.d2;
+	}
+
+	// Sum of squared distances from p to every plane in the quadric
+	double Error(const glm::vec3& p) const
+	{
+		double x = p.x, y = p.y, z = p.z;
+		double e = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+			+ b2 * y * y + 2 * bc * y * z + 2 * bd * y
+			+ c2 * z * z + 2 * cd * z + d2;
+		return e > 0.0 ? e : 0.0; // Round-off can go slightly negative
+	}
+};
+
+// Incremental half-edge collapse simplifier over one indexed triangle list
+class MeshSimplifier
+{
+public:
+	MeshSimplifier(const vector<Vertex>& vertices, const vector<GLuint>& indices)
+		: vertices(vertices), indices(indices), aliveTriangles(indices.size() / 3), maxError(0.0)
+	{
+		size_t vertexCount = vertices.size(); // Vertices
+		size_t triangleCount = indices.size() / 3; // Triangles
+		this->triangleAlive.assign(triangleCount, true);
+		this->vertexAlive.assign(vertexCount, true);
+		this->locked.assign(vertexCount, false);
+		this->quadrics.assign(vertexCount, Quadric());
+		this->vertexTriangles.assign(vertexCount, vector<GLuint>());
+
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			const GLuint* tri = &this->indices[t * 3]; // Corners
+			for (int c = 0; c < 3; c++)
+				this->vertexTriangles[tri[c]].push_back((GLuint)t);
+			glm::vec3 p0 = vertices[tri[0]].Position, p1 = vertices[tri[1]].Position, p2 = vertices[tri[2]].Position;
+			glm::vec3 n = glm::cross(p1 - p0, p2 - p0); // Face normal
+			float length = glm::length(n);
+			if (!(length > 0.0f)) // Zero-area triangle adds no plane
+				continue;
+			n /= length;
+			Quadric q = Quadric::FromPlane(n.x, n.y, n.z, -glm::dot(n, p0)); // Triangle plane
+			for (int c = 0; c < 3; c++)
+				this->quadrics[tri[c]].Add(q);
+		}
+
+		this->lockSeams();
+		this->lockBorders();
+
+		// Seed the queue with every edge leaving an unlocked vertex
+		for (size_t v = 0; v < vertexCount; v++)
+			this->pushEdges((GLuint)v);
+	}
+
+	// Live triangle count
+	size_t TriangleCount() const { return this->aliveTriangles; }
+
+	// Largest geometric error introduced so far (object-space distance)
+	float Error() const { return (float)sqrt(this->maxError); }
+
+	// Collapses edges until at most targetTriangles remain, no legal collapse is left, or the next collapse
+	// would introduce more than maxError (object-space distance)
+	void Simplify(size_t targetTriangles, float maxError)
+	{
+		double limit = (double)maxError * maxError; // Costs are squared distances
+		while (this->aliveTriangles > targetTriangles && !this->queue.empty())
+		{
+			Collapse collapse = this->queue.top(); // Cheapest edge
+			this->queue.pop();
+			if (!this->vertexAlive[collapse.from] || !this->vertexAlive[collapse.to]) // Endpoint gone
+				continue;
+			double cost = this->collapseCost(collapse.from, collapse.to); // Quadrics may have grown since it was queued
+			if (cost > collapse.cost + 1e-12) {
+				collapse.cost = cost;
+				this->queue.push(collapse); // Requeue with current cost
+				continue;
+			}
+			if (cost > limit) // Cheapest collapse is already too coarse
+				break;
+			if (!this->isLegal(collapse.from, collapse.to)) // Would flip a triangle or make the surface non-manifold
+				continue;
+			this->apply(collapse.from, collapse.to);
+			if (cost > this->maxError)
+				this->maxError = cost;
+		}
+	}
+
+	// Current index list (live triangles only)
+	vector<GLuint> Indices() const
+	{
+		vector<GLuint> out; // Output
+		out.reserve(this->aliveTriangles * 3);
+		for (size_t t = 0; t < this->triangleAlive.size(); t++)
+			if (this->triangleAlive[t])
+				out.insert(out.end(), this->indices.begin() + t * 3, this->indices.begin() + t * 3 + 3);
+		return out;
+	}
+
+private:
+	struct Collapse {
+		GLuint from, to; // Half edge: from is removed, to is kept
+		double cost; // Quadric error at to
+		bool operator<(const Collapse& o) const { return cost > o.cost; } // Min-heap
+	};
+
+	const vector<Vertex>& vertices; // Source vertices (positions only are read)
+	vector<GLuint> indices; // Working index list
+	vector<bool> triangleAlive; // Triangle not collapsed
+	vector<bool> vertexAlive; // Vertex not collapsed away
+	vector<bool> locked; // Vertex may not be removed
+	vector<Quadric> quadrics; // Accumulated quadric per vertex
+	vector<vector<GLuint> > vertexTriangles; // Vertex -> triangles (may hold dead ones)
+	priority_queue<Collapse> queue; // Candidate collapses
+	size_t aliveTriangles; // Live triangles
+	double maxError; // Largest collapse cost applied
+
+	// Locks every vertex whose position is shared with another vertex (UV or normal seam)
+	void lockSeams()
+	{
+		struct PositionHash {
+			size_t operator()(const glm::vec3& p) const {
+				uint32_t bits[3]; // Raw float bits
+				memcpy(bits, &p, sizeof(bits));
+				return ((size_t)bits[0] * 73856093u) ^ ((size_t)bits[1] * 19349663u) ^ ((size_t)bits[2] * 83492791u);
+			}
+		};
+		struct PositionEqual {
+			bool operator()(const glm::vec3& a, const glm::vec3& b) const { return a.x == b.x && a.y == b.y && a.z == b.z; }
+		};
+		unordered_map<glm::vec3, GLuint, PositionHash, PositionEqual> firstAt; // Position -> first vertex
+		for (size_t v = 0; v < this->vertices.size(); v++)
+		{
+			pair<unordered_map<glm::vec3, GLuint, PositionHash, PositionEqual>::iterator, bool> result = firstAt.insert(make_pair(this->vertices[v].Position, (GLuint)v));
+			if (!result.second) { // Position already used by another vertex
+				this->locked[v] = true;
+				this->locked[result.first->second] = true;
+			}
+		}
+	}
+
+	// Locks vertices on edges used by a single triangle (open borders)
+	void lockBorders()
+	{
+		for (size_t v = 0; v < this->vertexTriangles.size(); v++)
+		{
+			vector<GLuint> neighbors; // Every edge endpoint, once per triangle
+			for (size_t i = 0; i < this->vertexTriangles[v].size(); i++)
+			{
+				const GLuint* tri = &this->indices[this->vertexTriangles[v][i] * 3];
+				for (int c = 0; c < 3; c++)
+					if (tri[c] != v)
+						neighbors.push_back(tri[c]);
+			}
+			sort(neighbors.begin(), neighbors.end());
+			for (size_t i = 0; i < neighbors.size(); i++) // An edge seen once is a border edge
+			{
+				bool once = (i == 0 || neighbors[i - 1] != neighbors[i]) && (i + 1 == neighbors.size() || neighbors[i + 1] != neighbors[i]);
+				if (once) {
+					this->locked[v] = true;
+					break;
+				}
+			}
+		}
+	}
+
+	double collapseCost(GLuint from, GLuint to) const
+	{
+		Quadric q = this->quadrics[from]; // Both quadrics, evaluated where the merged vertex ends up
+		q.Add(this->quadrics[to]);
+		return q.Error(this->vertices[to].Position);
+	}
+
+	// Queues every edge from v to its neighbors (only unlocked vertices can move)
+	void pushEdges(GLuint v)
+	{
+		if (this->locked[v] || !this->vertexAlive[v])
+			return;
+		for (size_t i = 0; i < this->vertexTriangles[v].size(); i++)
+		{
+			GLuint t = this->vertexTriangles[v][i];
+			if (!this->triangleAlive[t])
+				continue;
+			for (int c = 0; c < 3; c++)
+			{
+				GLuint other = this->indices[t * 3 + c];
+				if (other == v)
+					continue;
+				Collapse collapse; // Candidate
+				collapse.from = v;
+				collapse.to = other;
+				collapse.cost = this->collapseCost(v, other);
+				this->queue.push(collapse);
+			}
+		}
+	}
+
+	// Sorted, unique vertices sharing a live triangle with v
+	void neighbors(GLuint v, vector<GLuint>& out) const
+	{
+		out.clear();
+		for (size_t i = 0; i < this->vertexTriangles[v].size(); i++)
+		{
+			GLuint t = this->vertexTriangles[v][i];
+			if (!this->triangleAlive[t])
+				continue;
+			for (int c = 0; c < 3; c++)
+				if (this->indices[t * 3 + c] != v)
+					out.push_back(this->indices[t * 3 + c]);
+		}
+		sort(out.begin(), out.end());
+		out.erase(unique(out.begin(), out.end()), out.end());
+	}
+
+	// Link condition: the vertices adjacent to both from and to must be exactly the opposite corners of the
+	// triangles on the edge. Any other shared neighbor would leave a pinched edge or vertex after the collapse
+	// (e.g. a thin part folding onto itself).
+	bool keepsManifold(GLuint from, GLuint to) const
+	{
+		vector<GLuint> fromNeighbors, toNeighbors, shared, opposite; // Vertex sets
+		this->neighbors(from, fromNeighbors);
+		this->neighbors(to, toNeighbors);
+		set_intersection(fromNeighbors.begin(), fromNeighbors.end(), toNeighbors.begin(), toNeighbors.end(), back_inserter(shared));
+		for (size_t i = 0; i < this->vertexTriangles[from].size(); i++)
+		{
+			GLuint t = this->vertexTriangles[from][i];
+			if (!this->triangleAlive[t])
+				continue;
+			const GLuint* tri = &this->indices[t * 3];
+			if (tri[0] != to && tri[1] != to && tri[2] != to) // Not on the edge
+				continue;
+			for (int c = 0; c < 3; c++)
+				if (tri[c] != from && tri[c] != to)
+					opposite.push_back(tri[c]);
+		}
+		sort(opposite.begin(), opposite.end());
+		opposite.erase(unique(opposite.begin(), opposite.end()), opposite.end());
+		return shared == opposite;
+	}
+
+	// Rejects collapses that break the link condition or flip or squash any surviving triangle around from
+	bool isLegal(GLuint from, GLuint to) const
+	{
+		if (!this->keepsManifold(from, to))
+			return false;
+		const glm::vec3& target = this->vertices[to].Position; // Where from moves to
+		for (size_t i = 0; i < this->vertexTriangles[from].size(); i++)
+		{
+			GLuint t = this->vertexTriangles[from][i];
+			if (!this->triangleAlive[t])
+				continue;
+			const GLuint* tri = &this->indices[t * 3];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) // Removed by the collapse
+				continue;
+			glm::vec3 p[3], q[3]; // Before and after
+			for (int c = 0; c < 3; c++)
+			{
+				p[c] = this->vertices[tri[c]].Position;
+				q[c] = (tri[c] == from) ? target : p[c];
+			}
+			glm::vec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::vec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			float lengths = glm::length(before) * glm::length(after);
+			if (!(lengths > 0.0f) || glm::dot(before, after) < LOD_FLIP_LIMIT * lengths)
+				return false;
+		}
+		return true;
+	}
+
+	void apply(GLuint from, GLuint to)
+	{
+		for (size_t i = 0; i < this->vertexTriangles[from].size(); i++)
+		{
+			GLuint t = this->vertexTriangles[from][i];
+			if (!this->triangleAlive[t])
+				continue;
+			GLuint* tri = &this->indices[t * 3];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) { // Edge triangle disappears
+				this->triangleAlive[t] = false;
+				this->aliveTriangles--;
+				continue;
+			}
+			for (int c = 0; c < 3; c++)
+				if (tri[c] == from)
+					tri[c] = to; // Move corner
+			this->vertexTriangles[to].push_back(t);
+		}
+		this->vertexAlive[from] = false;
+		this->quadrics[to].Add(this->quadrics[from]);
+		this->pushEdges(to); // Costs around the merged vertex changed
+		for (size_t i = 0; i < this->vertexTriangles[to].size(); i++) // And for its neighbors collapsing into it
+		{
+			GLuint t = this->vertexTriangles[to][i];
+			if (!this->triangleAlive[t])
+				continue;
+			for (int c = 0; c < 3; c++)
+				if (this->indices[t * 3 + c] != to)
+					this->pushEdges(this->indices[t * 3 + c]);
+		}
+	}
+};
+
+// Builds LOD 1..n for a mesh whose LOD 0 is indices. Appends every level to indices (LOD 0 stays first) and
+// returns the ranges. Each level is reordered for the vertex cache; vertices are shared by all levels.
+inline vector<MeshLod> BuildLodChain(const vector<Vertex>& vertices, vector<GLuint>& indices, GLuint cacheSize)
+{
+	vector<MeshLod> lods; // Output ranges
+	MeshLod full; // LOD 0
+	full.indexOffset = 0;
+	full.indexCount = (GLuint)indices.size();
+	full.error = 0.0f;
+	lods.push_back(full);
+
+	glm::vec3 minimum(0.0f), maximum(0.0f); // Bounding box, sets the error budget
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const glm::vec3& p = vertices[i].Position;
+		if (i == 0) { minimum = p; maximum = p; }
+		minimum = glm::vec3(min(minimum.x, p.x), min(minimum.y, p.y), min(minimum.z, p.z));
+		maximum = glm::vec3(max(maximum.x, p.x), max(maximum.y, p.y), max(maximum.z, p.z));
+	}
+	float maxError = glm::length(maximum - minimum) * LOD_MAX_ERROR; // Error budget
+
+	MeshSimplifier simplifier(vertices, indices); // Shared state, each level continues from the previous one
+	size_t previous = indices.size() / 3; // Triangles in the previous level
+	while (lods.size() < LOD_MAX_LEVELS)
+	{
+		simplifier.Simplify((size_t)(previous * LOD_REDUCTION), maxError); // Halve
+		size_t reached = simplifier.TriangleCount();
+		if (reached == 0 || reached > previous * LOD_MIN_GAIN) // Locked, out of error budget or already minimal
+			break;
+		vector<GLuint> level = simplifier.Indices(); // Snapshot
+		OptimizeVertexCache(level, vertices.size(), cacheSize, nullptr); // Cache friendly order
+		MeshLod lod; // Range in the shared index buffer
+		lod.indexOffset = (GLuint)indices.size();
+		lod.indexCount = (GLuint)level.size();
+		lod.error = simplifier.Error();
+		indices.insert(indices.end(), level.begin(), level.end());
+		lods.push_back(lod);
+		previous = reached;
+	}
+	return lods;
+}
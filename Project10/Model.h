@@ -6,6 +6,7 @@
 #include <iostream> // Include iostream
 #include <map> // Include map
 #include <vector> // Include vector
+#include <memory> // Include unique_ptr
 using namespace std; // Use namespace std
 // GL Includes
 #include <GL/glew.h> // Contains all the necessery OpenGL includes
@@ -17,49 +18,339 @@ using namespace std; // Use namespace std
 #include <assimp/postprocess.h> // Include assimp postprocess
 
 #include "Mesh.h" // Include Mesh.h
+#include "MeshCache.h" // Include binary mesh cache
+#include "TangentSpace.h" // Include parallel tangent generation
+#include "MeshOptimizer.h" // Include post-load mesh optimizer
+#include "MeshSimplifier.h" // Include LOD chain generation
+#include "Frustum.h" // Include frustum culling
+#include "TextureManager.h" // Include shared texture cache
+#include "RenderQueue.h" // Include state-sorted render queue
 
 GLint TextureFromFile(const char* path, string directory); // Texture from file
 
 class Model  // Provided in class
 {
 public:
+	// LOD selection (see SelectLod)
+	float LodPixelError; // Largest simplification error allowed on screen, in pixels
+	float LodHysteresis; // Fraction of LodPixelError a coarser level must stay under before switching to it
+
 	/*  Functions   */
-	// Constructor, expects a filepath to a 3D model.
-	Model(GLchar* path) // Model constructor using path
+	// Constructor, expects a filepath to a 3D model. With useCache the processed meshes are read from / written to
+	// a binary cache next to the model (see MeshCache.h), so only the first launch after an edit runs Assimp.
+	// format picks the GPU vertex layout of every mesh; VERTEX_PACKED needs shaders that decode packedVertices.
+	// With mergeMeshes every submesh goes into one shared vertex/index buffer (one VAO for the whole model), each
+	// at its own base vertex and first index, and submeshes that share textures are drawn with a single
+	// glMultiDrawElementsBaseVertex instead of a VAO bind and draw call per mesh.
+	// Meshes free their CPU copy of the geometry once everything is uploaded and cached; pass keepGeometry to
+	// keep Mesh::vertices/indices filled for CPU-side queries (copied out of the mapping when loading from the
+	// mesh cache).
+	Model(const GLchar* path, bool useCache = true, Vertex_Format format = VERTEX_FULL, bool mergeMeshes = false, bool keepGeometry = false) : LodPixelError(1.0f),
+		LodHysteresis(0.25f), useCache(useCache), format(format), mergeMeshes(mergeMeshes), keepGeometry(keepGeometry) // Model constructor using path
 	{
 		this->loadModel(path); // Load model with callback and path
 	}
+
+	// Releases this model's references on the shared textures
+	~Model()
+	{
+		for(GLuint i = 0; i < this->meshes.size(); i++) // Iterate over meshes
+			for(GLuint t = 0; t < this->meshes[i].textures.size(); t++) // Iterate over textures
+				TextureManager::Instance().Release(this->meshes[i].textures[t].id); // Drop reference
+	}
+	Model(const Model&) = delete; // Texture references are owned, no copies
+	Model& operator=(const Model&) = delete;
 	
-	// Draws the model, and thus all its meshes
-	void Draw(Shader shader)
+	// Draws the model, and thus all its meshes, at a level of detail (0 = full resolution)
+	void Draw(Shader& shader, GLuint lod = 0)
 	{
+		if(this->arena) // Merged: every mesh, batched by textures
+		{
+			vector<GLuint> all(this->meshes.size()); // Mesh indices
+			for(GLuint i = 0; i < all.size(); i++)
+				all[i] = i;
+			this->drawMerged(shader, lod, all, NULL);
+			return;
+		}
 		for(GLuint i = 0; i < this->meshes.size(); i++) // Iterate over mesh
-			this->meshes[i].Draw(shader); // Draw
+			this->meshes[i].Draw(shader, lod); // Draw
+	}
+
+	// Draws only the meshes whose bounds (placed by model) intersect the frustum and counts them in stats
+	void Draw(Shader& shader, GLuint lod, const Frustum& frustum, const glm::mat4& model, CullStats& stats)
+	{
+		vector<GLuint> visible; // Meshes to draw when merged
+		for(GLuint i = 0; i < this->meshes.size(); i++) // Iterate over mesh
+		{
+			const Mesh& mesh = this->meshes[i];
+			if(!stats.Record(frustum.IntersectsBounds(model, mesh.BoundsMin, mesh.BoundsMax, mesh.BoundsCenter, mesh.BoundsRadius))) // Outside
+				continue;
+			if(this->arena)
+			{
+				visible.push_back(i); // Drawn together below
+				continue;
+			}
+			this->meshes[i].Draw(shader, lod); // Draw
+			stats.AddDraw(mesh.TriangleCount(lod)); // One glDrawElements
+		}
+		if(this->arena && !visible.empty())
+			this->drawMerged(shader, lod, visible, &stats);
+	}
+
+	// Queues the meshes whose bounds (placed by model) intersect the frustum instead of drawing them, one item per
+	// mesh with the given shader and material. The material's textures replace the meshes' own (the Project 10
+	// .mtl files have none). depth is the camera distance for the sort key, passName the profiler pass.
+	// A merged model queues a single item that draws every visible mesh as one index range.
+	void Submit(RenderQueue& queue, Render_Pass pass, Shader& shader, GLuint material, GLuint lod, const Frustum& frustum,
+		const glm::mat4& model, float depth, const char* passName, CullStats& stats)
+	{
+		RenderItem* merged = NULL; // The merged model's item, once a mesh is visible
+		for(GLuint i = 0; i < this->meshes.size(); i++) // Iterate over mesh
+		{
+			const Mesh& mesh = this->meshes[i];
+			if(!stats.Record(frustum.IntersectsBounds(model, mesh.BoundsMin, mesh.BoundsMax, mesh.BoundsCenter, mesh.BoundsRadius))) // Outside
+				continue;
+			const MeshLod& level = mesh.Lod(lod); // Selected level
+			if(this->arena)
+			{
+				if(!merged)
+				{
+					merged = &queue.Submit(pass, shader, material, this->arena->VertexArray(), depth, passName);
+					merged->HasModel = true;
+					merged->Model = model;
+					merged->IntName = "packedVertices"; // Tell the vertex shader how to decode attributes
+					merged->IntValue = this->format == VERTEX_PACKED;
+				}
+				queue.AddRange(*merged, this->firstIndices[i] + level.indexOffset, level.indexCount, this->baseVertices[i]); // Range in the shared buffers
+				merged->Triangles += level.indexCount / 3;
+				continue;
+			}
+			RenderItem& item = queue.Submit(pass, shader, material, mesh.VertexArray(), depth, passName);
+			item.HasModel = true;
+			item.Model = model;
+			item.IntName = "packedVertices"; // Tell the vertex shader how to decode attributes
+			item.IntValue = mesh.Format() == VERTEX_PACKED;
+			item.Indexed = true;
+			item.First = level.indexOffset;
+			item.Count = level.indexCount;
+			item.Triangles = level.indexCount / 3;
+		}
+	}
+
+	// Number of levels of detail (the most any mesh has)
+	GLuint LodCount() const
+	{
+		GLuint count = 1; // Always at least the full mesh
+		for(GLuint i = 0; i < this->meshes.size(); i++) // Iterate over meshes
+			count = max(count, this->meshes[i].LodCount());
+		return count;
+	}
+
+	// Picks the coarsest level whose simplification error projects to at most LodPixelError pixels.
+	// cameraPosition is Camera::Position, model the object's model matrix, pixelsPerUnit the projection scale
+	// (viewport height / (2 * tan(fovy / 2))). Pass the level returned last frame as currentLod: moving to a
+	// coarser level needs the error to be LodHysteresis below the limit, so objects near a threshold don't pop.
+	GLuint SelectLod(const glm::vec3& cameraPosition, const glm::mat4& model, float pixelsPerUnit, GLuint currentLod) const
+	{
+		float scale = max(glm::length(glm::vec3(model[0])), max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])))); // Largest axis scale
+		float distance = 1e30f; // Distance from the camera to the closest mesh bounds
+		for(GLuint i = 0; i < this->meshes.size(); i++) // Iterate over meshes
+		{
+			glm::vec3 center = glm::vec3(model * glm::vec4(this->meshes[i].BoundsCenter, 1.0f)); // World space center
+			distance = min(distance, glm::length(cameraPosition - center) - this->meshes[i].BoundsRadius * scale);
+		}
+		if(distance <= 0.0f) // Camera inside the bounds
+			return 0;
+
+		GLuint level = 0; // Full resolution by default
+		for(GLuint lod = 1; lod < this->LodCount(); lod++) // Errors grow with the level
+		{
+			float error = 0.0f; // Largest error of any mesh at this level
+			for(GLuint i = 0; i < this->meshes.size(); i++)
+				error = max(error, this->meshes[i].lods[min(lod, this->meshes[i].LodCount() - 1)].error);
+			float pixels = error * scale * pixelsPerUnit / distance; // Projected error
+			float limit = (lod > currentLod) ? this->LodPixelError * (1.0f - this->LodHysteresis) : this->LodPixelError; // Hysteresis
+			if(pixels > limit)
+				break;
+			level = lod;
+		}
+		return level;
 	}
 	
 private:
 	/*  Model Data  */
 	vector<Mesh> meshes; // Vector of meshes
 	string directory; // String for directory
+	bool useCache; // Read/write the binary mesh cache
+	Vertex_Format format; // Vertex layout uploaded for each mesh
+	bool mergeMeshes; // Upload every mesh into one shared buffer (arena) instead of one VAO each
+	bool keepGeometry; // Keep the meshes' CPU vertices/indices after loading
+	unique_ptr<Mesh> arena; // With mergeMeshes: all vertices and indices, meshes only describe their part
+	vector<GLint> baseVertices; // With mergeMeshes: first vertex of each mesh in the arena
+	vector<GLuint> firstIndices; // With mergeMeshes: first index of each mesh in the arena (indices stay mesh-local)
 	
 	/*  Functions   */
 	// Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
 	void loadModel(string path)
 	{
+		const GLuint postProcessFlags = aiProcess_Triangulate | aiProcess_FlipUVs; // Assimp processing, part of the cache key
+		// Retrieve the directory path of the filepath
+		this->directory = path.substr(0, path.find_last_of('/')); // Get directory
+
+		// Warm path: upload straight from the mapped cache
+		if(this->useCache && this->loadFromCache(path, postProcessFlags))
+			return;
+
 		// Read file via ASSIMP
 		Assimp::Importer importer; // Initialize importer
-		const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs); // Read model
+		const aiScene* scene = importer.ReadFile(path, postProcessFlags); // Read model
 		// Check for errors
 		if(!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
 		{
 			cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl; // Write error message
 			return;
 		}
-		// Retrieve the directory path of the filepath
-		this->directory = path.substr(0, path.find_last_of('/')); // Get directory
 		
 		// Process ASSIMP's root node recursively
 		this->processNode(scene->mRootNode, scene); // Process nodes using callback
+
+		// Bake the processed meshes for the next launch
+		if(this->useCache)
+			WriteMeshCache(path, postProcessFlags, this->meshes); // Write cache next to the model
+
+		if(this->mergeMeshes) // Meshes kept their CPU copies, upload them together
+		{
+			vector<MeshGeometry> parts; // Every mesh
+			for(GLuint i = 0; i < this->meshes.size(); i++)
+				parts.push_back(MeshGeometry{ this->meshes[i].vertices.data(), (GLuint)this->meshes[i].vertices.size(),
+					this->meshes[i].indices.data(), (GLuint)this->meshes[i].indices.size() });
+			this->mergeGeometry(parts);
+		}
+
+		if(!this->keepGeometry) // Uploaded and cached, the CPU copies are dead weight now
+			for(GLuint i = 0; i < this->meshes.size(); i++)
+				this->meshes[i].ReleaseGeometry();
+	}
+
+	// Vertices and indices of one mesh, for mergeGeometry
+	struct MeshGeometry {
+		const Vertex* vertices; // Vertex data
+		GLuint vertexCount; // Number of vertices
+		const GLuint* indices; // Index data (every LOD)
+		GLuint indexCount; // Number of indices
+	};
+
+	// Copies every mesh into one vertex and one index list and uploads them as the arena. Indices are not
+	// rebased: each mesh keeps its own, and draws add the mesh's base vertex instead.
+	void mergeGeometry(const vector<MeshGeometry>& parts)
+	{
+		GLuint vertexCount = 0, indexCount = 0; // Totals
+		for(GLuint i = 0; i < parts.size(); i++)
+		{
+			this->baseVertices.push_back((GLint)vertexCount);
+			this->firstIndices.push_back(indexCount);
+			vertexCount += parts[i].vertexCount;
+			indexCount += parts[i].indexCount;
+		}
+		if(vertexCount == 0 || indexCount == 0) // Nothing loaded
+			return;
+		vector<Vertex> vertices; // Shared vertex list
+		vector<GLuint> indices; // Shared index list
+		vertices.reserve(vertexCount);
+		indices.reserve(indexCount);
+		for(GLuint i = 0; i < parts.size(); i++)
+		{
+			vertices.insert(vertices.end(), parts[i].vertices, parts[i].vertices + parts[i].vertexCount);
+			indices.insert(indices.end(), parts[i].indices, parts[i].indices + parts[i].indexCount);
+		}
+		this->arena.reset(new Mesh(vertices.data(), vertexCount, indices.data(), indexCount, vector<Texture>(), this->format)); // One VAO, VBO and EBO
+	}
+
+	// Draws the given meshes from the arena: one glMultiDrawElementsBaseVertex per distinct texture set
+	void drawMerged(Shader& shader, GLuint lod, const vector<GLuint>& visible, CullStats* stats)
+	{
+		vector<bool> drawn(visible.size(), false); // Already part of a batch
+		vector<GLsizei> counts; // Batch index counts
+		vector<GLvoid*> offsets; // Batch byte offsets
+		vector<GLint> bases; // Batch base vertices
+		shader.SetFloat("material.shininess", 16.0f); // Same defaults as Mesh::Draw
+		shader.SetInt("packedVertices", this->format == VERTEX_PACKED);
+		glBindVertexArray(this->arena->VertexArray()); // Bind once for every batch
+		for(GLuint i = 0; i < visible.size(); i++)
+		{
+			if(drawn[i])
+				continue;
+			const Mesh& first = this->meshes[visible[i]]; // Batch leader, its textures are bound for the batch
+			counts.clear();
+			offsets.clear();
+			bases.clear();
+			GLuint triangles = 0; // Triangles in the batch
+			for(GLuint j = i; j < visible.size(); j++) // Every mesh with the same textures
+			{
+				const Mesh& mesh = this->meshes[visible[j]];
+				if(drawn[j] || !sameTextures(first, mesh))
+					continue;
+				drawn[j] = true;
+				const MeshLod& level = mesh.Lod(lod); // Selected level
+				counts.push_back(level.indexCount);
+				offsets.push_back((GLvoid*)((this->firstIndices[visible[j]] + level.indexOffset) * sizeof(GLuint)));
+				bases.push_back(this->baseVertices[visible[j]]);
+				triangles += level.indexCount / 3;
+			}
+			first.BindTextures(shader);
+			glMultiDrawElementsBaseVertex(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), (GLsizei)counts.size(), bases.data()); // Whole batch
+			first.UnbindTextures();
+			if(stats)
+				stats->AddDraw(triangles); // One call for the batch
+		}
+		glBindVertexArray(0); // Bind 0
+	}
+
+	// True when two meshes bind the same textures in the same order
+	static bool sameTextures(const Mesh& a, const Mesh& b)
+	{
+		if(a.textures.size() != b.textures.size())
+			return false;
+		for(GLuint t = 0; t < a.textures.size(); t++)
+			if(a.textures[t].id != b.textures[t].id || a.textures[t].type != b.textures[t].type)
+				return false;
+		return true;
+	}
+
+	// Builds the meshes from a valid binary cache; returns false when the cache is missing or stale
+	bool loadFromCache(const string& path, GLuint postProcessFlags)
+	{
+		MeshCacheFile cache; // Mapped cache, unmapped when it goes out of scope
+		if(!cache.Open(path, postProcessFlags)) // Missing, stale or different flags
+			return false;
+		for(GLuint i = 0; i < cache.meshes.size(); i++) // Iterate over cached meshes
+		{
+			const CachedMesh& cached = cache.meshes[i]; // Cached mesh view
+			vector<Texture> textures; // Textures for this mesh
+			for(GLuint t = 0; t < cached.textures.size(); t++) // Reload material textures
+			{
+				Texture texture; // Initialize texture
+				texture.id = TextureFromFile(cached.textures[t].path.c_str(), this->directory); // Assign id
+				texture.type = cached.textures[t].type; // Assign type
+				texture.path = aiString(cached.textures[t].path); // Assign path
+				textures.push_back(texture); // Push back texture
+			}
+			this->meshes.push_back(Mesh(cached.vertices, cached.vertexCount, cached.indices, cached.indexCount, textures, this->format, cached.lods,
+				!this->mergeMeshes)); // Upload from mapping (or only describe the mesh when merging)
+			if(this->keepGeometry) // Same CPU copy as after an Assimp load, the mapping goes away on return
+			{
+				this->meshes.back().vertices.assign(cached.vertices, cached.vertices + cached.vertexCount);
+				this->meshes.back().indices.assign(cached.indices, cached.indices + cached.indexCount);
+			}
+		}
+		if(this->mergeMeshes) // One upload for every mesh, straight from the mapping
+		{
+			vector<MeshGeometry> parts; // Every cached mesh
+			for(GLuint i = 0; i < cache.meshes.size(); i++)
+				parts.push_back(MeshGeometry{ cache.meshes[i].vertices, cache.meshes[i].vertexCount, cache.meshes[i].indices, cache.meshes[i].indexCount });
+			this->mergeGeometry(parts);
+		}
+		return true;
 	}
 	
 	// Processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -126,8 +417,18 @@ private:
 				indices.push_back(face.mIndices[j]); // Push back face indices
 		}
 		
+		// Weld duplicate face corners first so shared vertices get tangents from all their triangles
+		MeshOptimizerOptions optimizerOptions; // Default optimization steps (see MeshOptimizer.h)
+		WeldVertices(vertices, indices, optimizerOptions); // Merge identical vertices
+
 		// Calculate tangents and bitangents
 		this->calculateTangentsBitangents(vertices, indices); // Calculate tangents and bitangents
+
+		// Reorder for vertex cache, overdraw and fetch locality (the result is what the mesh cache stores)
+		OptimizeMesh(vertices, indices, optimizerOptions); // Optimize mesh
+
+		// Simplified levels of detail, appended to the index list (baked into the mesh cache with everything else)
+		vector<MeshLod> lods = BuildLodChain(vertices, indices, optimizerOptions.cacheSize); // Build LOD chain
 		
 		// Process materials
 		if(mesh->mMaterialIndex >= 0)
@@ -149,73 +450,19 @@ private:
 		}
 		
 		// Return a mesh object created from the extracted mesh data
-		return Mesh(vertices, indices, textures); // Return Mesh object from vertices, indices, textures defined above
+		return Mesh(move(vertices), move(indices), move(textures), this->format, move(lods), !this->mergeMeshes); // Return Mesh object (not uploaded when merging) from vertices, indices, textures defined above
 	}
 	
-	// Calculate tangents and bitangents for all vertices based on triangle data
+	// Calculate tangents and bitangents for all vertices based on triangle data.
+	// Done in SIMD batches across all cores by GenerateTangents (TangentSpace.h); frames come back orthonormal
+	// to the normal and vertices with degenerate or missing UVs still get a valid tangent.
 	void calculateTangentsBitangents(vector<Vertex>& vertices, vector<GLuint>& indices)
 	{
-		// Initialize all tangents and bitangents to zero
-		for(GLuint i = 0; i < vertices.size(); i++) // Iterate over vertices
-		{
-			vertices[i].Tangent = glm::vec3(0.0f); // Initialize tangent to 0.0f
-			vertices[i].Bitangent = glm::vec3(0.0f); // Initialize bitangent to 0.0f
-		}
-		
-		// Calculate tangent and bitangent for each triangle
-		for(GLuint i = 0; i < indices.size(); i += 3) // Iterate over triangles (3 indices per triangle)
-		{
-			GLuint i1 = indices[i]; // Get first index
-			GLuint i2 = indices[i + 1]; // Get second index
-			GLuint i3 = indices[i + 2]; // Get third index
-			
-			glm::vec3 v1 = vertices[i1].Position; // Get first vertex position
-			glm::vec3 v2 = vertices[i2].Position; // Get second vertex position
-			glm::vec3 v3 = vertices[i3].Position; // Get third vertex position
-			
-			glm::vec2 uv1 = vertices[i1].TexCoords; // Get first vertex texture coordinate
-			glm::vec2 uv2 = vertices[i2].TexCoords; // Get second vertex texture coordinate
-			glm::vec2 uv3 = vertices[i3].TexCoords; // Get third vertex texture coordinate
-			
-			glm::vec3 e1 = v2 - v1; // Calculate edge 1
-			glm::vec3 e2 = v3 - v1; // Calculate edge 2
-			
-			glm::vec2 duv1 = uv2 - uv1; // Calculate texture coordinate delta 1
-			glm::vec2 duv2 = uv3 - uv1; // Calculate texture coordinate delta 2
-			
-			float f = 1.0f / (duv1.x * duv2.y - duv2.x * duv1.y); // Calculate denominator
-			
-			// Calculate tangent
-			glm::vec3 tangent;
-			tangent.x = f * (duv2.y * e1.x - duv1.y * e2.x); // Calculate tangent x
-			tangent.y = f * (duv2.y * e1.y - duv1.y * e2.y); // Calculate tangent y
-			tangent.z = f * (duv2.y * e1.z - duv1.y * e2.z); // Calculate tangent z
-			
-			// Calculate bitangent
-			glm::vec3 bitangent;
-			bitangent.x = f * (-duv2.x * e1.x + duv1.x * e2.x); // Calculate bitangent x
-			bitangent.y = f * (-duv2.x * e1.y + duv1.x * e2.y); // Calculate bitangent y
-			bitangent.z = f * (-duv2.x * e1.z + duv1.x * e2.z); // Calculate bitangent z
-			
-			// Accumulate tangent and bitangent to each vertex of the triangle
-			vertices[i1].Tangent += tangent; // Add tangent to first vertex
-			vertices[i2].Tangent += tangent; // Add tangent to second vertex
-			vertices[i3].Tangent += tangent; // Add tangent to third vertex
-			
-			vertices[i1].Bitangent += bitangent; // Add bitangent to first vertex
-			vertices[i2].Bitangent += bitangent; // Add bitangent to second vertex
-			vertices[i3].Bitangent += bitangent; // Add bitangent to third vertex
-		}
-		
-		// Normalize tangents and bitangents
-		for(GLuint i = 0; i < vertices.size(); i++) // Iterate over vertices
-		{
-			vertices[i].Tangent = glm::normalize(vertices[i].Tangent); // Normalize tangent
-			vertices[i].Bitangent = glm::normalize(vertices[i].Bitangent); // Normalize bitangent
-		}
+		GenerateTangents(vertices, indices); // Parallel tangent generation
 	}
 	
 	// Checks all material textures of a given type and loads the textures if they're not loaded yet.
+	// Already-loaded images come back from the TextureManager with another reference instead of a new upload.
 	// The required info is returned as a Texture struct.
 	vector<Texture> loadMaterialTextures(aiMaterial* mat, aiTextureType type, string typeName)
 	{
@@ -224,7 +471,7 @@ private:
 		{
 			aiString str; // Initialize aiString
 			mat->GetTexture(type, i, &str); // Get texture using type and string
-			// Check if texture was loaded before and if so, continue to next iteration: skip loading a new texture
+			// TextureFromFile goes through the TextureManager, so a texture loaded before is reused, not decoded again
 			Texture texture; // Initialize texture
 			texture.id = TextureFromFile(str.C_Str(), this->directory); // Assign id
 			texture.type = typeName; // Assign type
@@ -239,24 +486,8 @@ private:
 
 GLint TextureFromFile(const char* path, string directory)
 {
-	//Generate texture ID and load texture data 
+	// Resolve the file relative to the model and fetch it from the shared cache (decoded + uploaded on first use only)
 	string filename = string(path); // Get filename
 	filename = directory + '/' + filename; // Get filename with directory
-	GLuint textureID; // Initialize textureID
-	glGenTextures(1, &textureID); // Gen textures with textureID
-	int width,height; // Initialize width and height
-	unsigned char* image = SOIL_load_image(filename.c_str(), &width, &height, 0, SOIL_LOAD_RGB); // Get SOIL image
-	// Assign texture to ID
-	glBindTexture(GL_TEXTURE_2D, textureID); // Bind texture
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image); // Bind image
-	glGenerateMipmap(GL_TEXTURE_2D); // Generate mip maps
-	
-	// Parameters
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT ); // Set texture wrap s
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT ); // Set texture wrap t
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR ); // Set min filter
-	glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Set mag filter
-	glBindTexture(GL_TEXTURE_2D, 0); // Bind texture
-	SOIL_free_image_data(image); // Use image
-	return textureID; // Return textureID
+	return TextureManager::Instance().Acquire2D(filename, SOIL_LOAD_RGB); // Return shared texture ID
 }
@@ -0,0 +1,317 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <vector> // Include vector
+#include <fstream> // Include ofstream
+#include <iostream> // Include cout
+#include <iomanip> // Include setprecision
+#include <sstream> // Include ostringstream
+#include <chrono> // Include steady_clock
+#include <algorithm> // Include nth_element/min/max
+#include <cstring> // Include strcmp
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <glm/glm.hpp> // Include glm
+
+// Named-pass profiler. Every pass gets a pair of GL_TIMESTAMP queries per frame, double buffered: the pair written
+// in frame N is read at the start of frame N + 2 and only if the GPU already has the result, so the profiler never
+// waits on the pipeline (a late result is dropped rather than stalling). CPU time of the same scope comes from
+// steady_clock. Passes may nest, timestamps (unlike GL_TIME_ELAPSED) don't care.
+
+const GLuint PROFILER_BUFFERS = 2; // Query pairs in flight per pass
+const GLuint PROFILER_HISTORY = 240; // Samples kept per pass for min/avg/p99 (4 seconds at 60 fps)
+const size_t PROFILER_MAX_TRACE_EVENTS = 200000; // Trace events kept for WriteChromeTrace, later ones are dropped
+const float PROFILER_OVERLAY_MS = 16.667f; // Time the full width of an overlay bar stands for (one 60 Hz frame)
+
+// min/avg/p99 of a pass history, in milliseconds
+struct ProfileStats {
+	float Min; // Fastest sample
+	float Avg; // Mean
+	float P99; // 99th percentile
+
+	ProfileStats() : Min(0.0f), Avg(0.0f), P99(0.0f) {}
+};
+
+// Fixed size ring of samples
+struct ProfileHistory {
+	vector<float> Samples; // Milliseconds, oldest overwritten first
+	GLuint Next; // Slot the next sample goes into
+
+	ProfileHistory() : Next(0) {}
+
+	// Adds a sample, replacing the oldest once full
+	void Add(float ms)
+	{
+		if (this->Samples.size() < PROFILER_HISTORY)
+			this->Samples.push_back(ms);
+		else
+			this->Samples[this->Next] = ms;
+		this->Next = (this->Next + 1) % PROFILER_HISTORY;
+	}
+
+	// min/avg/p99 over the ring
+	ProfileStats Stats() const
+	{
+		ProfileStats stats; // Result
+		if (this->Samples.empty())
+			return stats;
+		vector<float> sorted = this->Samples; // nth_element reorders
+		size_t p99 = min(sorted.size() - 1, (size_t)(sorted.size() * 0.99f)); // Index of the 99th percentile
+		nth_element(sorted.begin(), sorted.begin() + p99, sorted.end());
+		stats.P99 = sorted[p99];
+		stats.Min = sorted[0];
+		float total = 0.0f; // Sum for the mean
+		for (size_t i = 0; i < sorted.size(); i++)
+		{
+			stats.Min = min(stats.Min, sorted[i]);
+			total += sorted[i];
+		}
+		stats.Avg = total / sorted.size();
+		return stats;
+	}
+};
+
+// One complete event for the Chrome trace (chrome://tracing, ui.perfetto.dev)
+struct TraceEvent {
+	const char* Name; // Pass name (string literal)
+	bool Gpu; // GPU track, else CPU track
+	double Start; // Microseconds since the profiler was created
+	double Duration; // Microseconds
+};
+
+class Profiler
+{
+public:
+	bool Enabled; // Issue queries and record scopes at all
+	bool ShowOverlay; // Draw the bar overlay in DrawOverlay
+
+	// Needs a current GL context
+	Profiler() : Enabled(true), ShowOverlay(false), frame(0), active(0)
+	{
+		this->cpuBase = chrono::steady_clock::now(); // Trace time zero
+		glGetInteger64v(GL_TIMESTAMP, &this->gpuBase); // Same moment on the GPU clock
+	}
+
+	~Profiler()
+	{
+		for (size_t i = 0; i < this->passes.size(); i++)
+			glDeleteQueries(PROFILER_BUFFERS * 2, this->passes[i].Queries); // Delete query pairs
+	}
+	Profiler(const Profiler&) = delete; // Owns GL queries, no copies
+	Profiler& operator=(const Profiler&) = delete;
+
+	// Call once at the start of each frame: collects the GPU results that are ready and picks this frame's buffer
+	void BeginFrame()
+	{
+		this->frame++;
+		this->active = this->frame % PROFILER_BUFFERS; // Buffer written this frame, last written PROFILER_BUFFERS frames ago
+		for (size_t i = 0; i < this->passes.size(); i++)
+		{
+			Pass& pass = this->passes[i];
+			if (!pass.Pending[this->active])
+				continue;
+			pass.Pending[this->active] = false; // Reused this frame either way
+			GLuint* pair = &pass.Queries[this->active * 2]; // Begin and end timestamp
+			GLint available = 0; // Result ready without waiting
+			glGetQueryObjectiv(pair[1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available) // Still in flight, drop it instead of stalling
+				continue;
+			GLuint64 begin = 0, end = 0; // Nanoseconds on the GPU clock
+			glGetQueryObjectui64v(pair[0], GL_QUERY_RESULT, &begin);
+			glGetQueryObjectui64v(pair[1], GL_QUERY_RESULT, &end);
+			pass.Gpu.Add((end - begin) / 1.0e6f);
+			this->addEvent(pass.Name, true, ((GLint64)begin - this->gpuBase) / 1.0e3, (end - begin) / 1.0e3);
+		}
+	}
+
+	// Starts timing a pass, prefer ProfileScope. name must outlive the profiler (a string literal).
+	void Begin(const char* name)
+	{
+		if (!this->Enabled)
+			return;
+		Pass& pass = this->find(name);
+		glQueryCounter(pass.Queries[this->active * 2], GL_TIMESTAMP); // GPU start
+		pass.CpuStart = chrono::steady_clock::now(); // CPU start
+	}
+
+	// Ends the pass started by Begin(name)
+	void End(const char* name)
+	{
+		if (!this->Enabled)
+			return;
+		Pass& pass = this->find(name);
+		glQueryCounter(pass.Queries[this->active * 2 + 1], GL_TIMESTAMP); // GPU end
+		pass.Pending[this->active] = true; // Read back PROFILER_BUFFERS frames from now
+		chrono::steady_clock::time_point now = chrono::steady_clock::now(); // CPU end
+		double start = chrono::duration<double, micro>(pass.CpuStart - this->cpuBase).count(); // Microseconds
+		double duration = chrono::duration<double, micro>(now - pass.CpuStart).count();
+		pass.Cpu.Add((float)(duration / 1.0e3));
+		this->addEvent(pass.Name, false, start, duration);
+	}
+
+	// GPU and CPU min/avg/p99 of a pass over the last PROFILER_HISTORY frames (zeros for unknown names)
+	void Stats(const char* name, ProfileStats& gpu, ProfileStats& cpu) const
+	{
+		for (size_t i = 0; i < this->passes.size(); i++)
+			if (this->passes[i].Name == string(name))
+			{
+				gpu = this->passes[i].Gpu.Stats();
+				cpu = this->passes[i].Cpu.Stats();
+				return;
+			}
+		gpu = cpu = ProfileStats();
+	}
+
+	// One line per pass: "name  gpu avg/min/p99  cpu avg/min/p99" in milliseconds
+	string Report() const
+	{
+		ostringstream report; // Result
+		report << fixed << setprecision(3);
+		for (size_t i = 0; i < this->passes.size(); i++)
+		{
+			ProfileStats gpu = this->passes[i].Gpu.Stats(), cpu = this->passes[i].Cpu.Stats(); // Rolling stats
+			report << "PROFILE::" << left << setw(14) << this->passes[i].Name << right
+				<< " gpu " << gpu.Avg << "/" << gpu.Min << "/" << gpu.P99
+				<< "  cpu " << cpu.Avg << "/" << cpu.Min << "/" << cpu.P99 << " ms (avg/min/p99)\n";
+		}
+		return report.str();
+	}
+
+	// Draws one row per pass in the top left corner of the bound framebuffer with scissored clears (no shader,
+	// no font). Full width is PROFILER_OVERLAY_MS. Top bar: GPU average in the pass color, min as a dark tick,
+	// p99 as a white tick. Thin bar below: CPU average.
+	void DrawOverlay(GLuint width, GLuint height)
+	{
+		if (!this->ShowOverlay)
+			return;
+		const GLint barWidth = min(300, (GLint)width - 20), rowHeight = 16, left = 10; // Layout in pixels
+		glEnable(GL_SCISSOR_TEST); // Clears only touch the scissor box
+		for (size_t i = 0; i < this->passes.size(); i++)
+		{
+			ProfileStats gpu = this->passes[i].Gpu.Stats(), cpu = this->passes[i].Cpu.Stats(); // Rolling stats
+			GLint top = (GLint)height - 10 - (GLint)i * rowHeight; // Row top edge (GL origin is bottom left)
+			glm::vec3 color = this->passColor(i); // Pass color
+			this->fill(left, top - 14, barWidth, 14, glm::vec3(0.1f)); // Background
+			this->fill(left, top - 10, this->barLength(gpu.Avg, barWidth), 10, color); // GPU average
+			this->fill(left + this->barLength(gpu.Min, barWidth), top - 10, 2, 10, color * 0.4f); // GPU min
+			this->fill(left + this->barLength(gpu.P99, barWidth), top - 10, 2, 10, glm::vec3(1.0f)); // GPU p99
+			this->fill(left, top - 14, this->barLength(cpu.Avg, barWidth), 3, color * 0.7f); // CPU average
+		}
+		glDisable(GL_SCISSOR_TEST); // Back to full framebuffer clears
+	}
+
+	// Writes every recorded scope as Chrome trace JSON: CPU scopes on thread 1, GPU passes on thread 2
+	bool WriteChromeTrace(const string& path) const
+	{
+		ofstream file(path.c_str()); // Output file
+		if (!file)
+		{
+			cout << "ERROR::PROFILER::CANNOT_WRITE " << path << endl;
+			return false;
+		}
+		file << fixed << setprecision(3); // Nanosecond resolution
+		file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+		file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 1, \"args\": {\"name\": \"CPU\"}},\n";
+		file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 2, \"args\": {\"name\": \"GPU\"}}";
+		for (size_t i = 0; i < this->events.size(); i++)
+		{
+			const TraceEvent& event = this->events[i];
+			file << ",\n{\"name\": \"" << event.Name << "\", \"cat\": \"" << (event.Gpu ? "gpu" : "cpu") << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+				<< (event.Gpu ? 2 : 1) << ", \"ts\": " << event.Start << ", \"dur\": " << event.Duration << "}";
+		}
+		file << "\n]}\n";
+		cout << "PROFILER::WROTE " << this->events.size() << " events to " << path << endl;
+		return true;
+	}
+
+private:
+	// Timers and history of one named pass
+	struct Pass {
+		const char* Name; // Pass name
+		GLuint Queries[PROFILER_BUFFERS * 2]; // Begin/end timestamp pair per buffer
+		bool Pending[PROFILER_BUFFERS]; // Pair was written and not read yet
+		chrono::steady_clock::time_point CpuStart; // Begin time of the open scope
+		ProfileHistory Gpu; // GPU milliseconds
+		ProfileHistory Cpu; // CPU milliseconds
+	};
+
+	vector<Pass> passes; // In first-use order (overlay row order)
+	vector<TraceEvent> events; // Chrome trace
+	GLuint frame; // Frames begun
+	GLuint active; // Query buffer written this frame
+	chrono::steady_clock::time_point cpuBase; // CPU trace time zero
+	GLint64 gpuBase; // GPU timestamp at cpuBase, maps GPU events onto the CPU timeline
+
+	// Pass by name, created with fresh queries on first use
+	Pass& find(const char* name)
+	{
+		for (size_t i = 0; i < this->passes.size(); i++)
+			if (this->passes[i].Name == name || strcmp(this->passes[i].Name, name) == 0) // Literals usually match by pointer
+				return this->passes[i];
+		Pass pass; // New pass
+		pass.Name = name;
+		glGenQueries(PROFILER_BUFFERS * 2, pass.Queries);
+		for (GLuint b = 0; b < PROFILER_BUFFERS; b++)
+			pass.Pending[b] = false;
+		this->passes.push_back(pass);
+		return this->passes.back();
+	}
+
+	// Appends a trace event until the cap is reached
+	void addEvent(const char* name, bool gpu, double start, double duration)
+	{
+		if (this->events.size() >= PROFILER_MAX_TRACE_EVENTS)
+			return;
+		TraceEvent event; // New event
+		event.Name = name;
+		event.Gpu = gpu;
+		event.Start = start;
+		event.Duration = duration;
+		this->events.push_back(event);
+	}
+
+	// Bar length in pixels for a time, clamped to the bar
+	static GLint barLength(float ms, GLint barWidth)
+	{
+		return (GLint)(min(ms / PROFILER_OVERLAY_MS, 1.0f) * (barWidth - 2));
+	}
+
+	// Distinct color per overlay row
+	static glm::vec3 passColor(size_t index)
+	{
+		static const glm::vec3 colors[] = { glm::vec3(0.9f, 0.3f, 0.3f), glm::vec3(0.3f, 0.8f, 0.3f), glm::vec3(0.3f, 0.5f, 0.9f),
+			glm::vec3(0.9f, 0.8f, 0.2f), glm::vec3(0.8f, 0.4f, 0.9f), glm::vec3(0.3f, 0.8f, 0.8f) };
+		return colors[index % (sizeof(colors) / sizeof(colors[0]))];
+	}
+
+	// Fills a rectangle with a scissored clear
+	static void fill(GLint x, GLint y, GLint width, GLint height, const glm::vec3& color)
+	{
+		if (width <= 0 || height <= 0)
+			return;
+		glScissor(x, y, width, height); // Rectangle
+		glClearColor(color.x, color.y, color.z, 1.0f); // Rectangle color
+		glClear(GL_COLOR_BUFFER_BIT); // Fill
+	}
+};
+
+// Times the enclosing block as a named pass on the CPU and the GPU
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler& profiler, const char* name) : profiler(profiler), name(name)
+	{
+		this->profiler.Begin(this->name);
+	}
+	~ProfileScope()
+	{
+		this->profiler.End(this->name);
+	}
+	ProfileScope(const ProfileScope&) = delete; // One Begin, one End
+	ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+	Profiler& profiler; // Profiler the scope reports to
+	const char* name; // Pass name
+};
@@ -0,0 +1,146 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <fstream> // Include fstream
+#include <iostream> // Include iostream
+#include <vector> // Include vector
+#include <cstdio> // Include cstdio for rename/remove
+#include <cstring> // Include cstring for memcmp/memcpy
+#include <cstdint> // Include fixed width integer types
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+
+// Linked program binaries (glGetProgramBinary) cached next to the vertex shader, e.g. cube.vs + cube.frag ->
+// cube.vs+cube.frag.progcache, so a warm launch skips compiling and linking GLSL.
+// Layout: ProgramCacheHeader, then the driver's binary blob.
+// The key is a hash of both sources and the GL vendor/renderer/version strings, so editing a shader or updating
+// the driver misses the cache. A binary the driver still rejects (glProgramBinary leaves the program unlinked)
+// also misses; the caller compiles from source and overwrites the file.
+
+const char PROGRAM_CACHE_MAGIC[8] = { 'P', 'R', 'O', 'G', 'B', 'I', 'N', '1' }; // File identifier
+const uint32_t PROGRAM_CACHE_VERSION = 1; // Bump whenever the file layout changes
+
+struct ProgramCacheHeader {
+	char magic[8]; // PROGRAM_CACHE_MAGIC
+	uint32_t version; // PROGRAM_CACHE_VERSION
+	uint32_t binaryFormat; // Format returned by glGetProgramBinary
+	uint64_t key; // ProgramCacheKey of the sources and driver
+	uint32_t binaryLength; // Bytes of binary that follow the header
+	uint32_t reserved; // Keeps the header 8-byte aligned
+};
+
+// FNV-1a over a string, continuing from hash
+inline uint64_t ProgramCacheHash(uint64_t hash, const string& text)
+{
+	for (size_t i = 0; i < text.size(); i++)
+	{
+		hash ^= (unsigned char)text[i];
+		hash *= 1099511628211ULL; // FNV prime
+	}
+	hash ^= 0xff; // Separator, so "ab"+"c" and "a"+"bc" differ
+	hash *= 1099511628211ULL;
+	return hash;
+}
+
+// Cache key for a program: both sources plus the driver that compiled them. Needs a current context.
+inline uint64_t ProgramCacheKey(const string& vertexCode, const string& fragmentCode)
+{
+	uint64_t hash = 14695981039346656037ULL; // FNV offset basis
+	hash = ProgramCacheHash(hash, vertexCode);
+	hash = ProgramCacheHash(hash, fragmentCode);
+	const GLenum driverStrings[3] = { GL_VENDOR, GL_RENDERER, GL_VERSION }; // Binaries are only valid for the same driver
+	for (int i = 0; i < 3; i++)
+	{
+		const GLubyte* value = glGetString(driverStrings[i]);
+		hash = ProgramCacheHash(hash, value ? (const char*)value : "");
+	}
+	return hash;
+}
+
+// Returns the cache path used for a vertex/fragment shader pair
+inline string ProgramCachePath(const string& vertexPath, const string& fragmentPath)
+{
+	size_t slash = fragmentPath.find_last_of("/\\"); // Fragment file name without its directory
+	string fragmentName = (slash == string::npos) ? fragmentPath : fragmentPath.substr(slash + 1);
+	return vertexPath + "+" + fragmentName + ".progcache"; // Cache lives next to the vertex shader
+}
+
+// True when the driver can hand out program binaries (GL 4.1 or ARB_get_program_binary, and at least one format)
+inline bool ProgramCacheSupported()
+{
+	if (!GLEW_ARB_get_program_binary)
+		return false;
+	GLint formats = 0; // Number of binary formats
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	return formats > 0;
+}
+
+// Creates a program from the cached binary. Returns 0 if the file is missing, stale or rejected by the driver.
+inline GLuint LoadProgramBinary(const string& cachePath, uint64_t key)
+{
+	if (!ProgramCacheSupported())
+		return 0;
+	ifstream in(cachePath.c_str(), ios::binary); // Open cache
+	if (!in)
+		return 0;
+	ProgramCacheHeader header; // File header
+	if (!in.read((char*)&header, sizeof(header)) || memcmp(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC)) != 0 ||
+		header.version != PROGRAM_CACHE_VERSION || header.key != key) // Different sources, driver or layout
+		return 0;
+	vector<char> binary(header.binaryLength); // Driver blob
+	if (!in.read(binary.data(), binary.size()))
+		return 0;
+
+	GLuint program = glCreateProgram(); // New program
+	glProgramBinary(program, header.binaryFormat, binary.data(), (GLsizei)binary.size()); // Load instead of linking
+	GLint success = 0; // Link status
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	if (!success) // Driver rejected it (format no longer supported)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+	return program;
+}
+
+// Stores a linked program's binary. The program should have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+// Writes to a temp file and renames it so a crash mid-write never leaves a truncated cache behind.
+// Failures are reported but not fatal.
+inline bool WriteProgramBinary(const string& cachePath, uint64_t key, GLuint program)
+{
+	if (!ProgramCacheSupported())
+		return false;
+	GLint success = 0, length = 0; // Link status and binary size
+	glGetProgramiv(program, GL_LINK_STATUS, &success);
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (!success || length <= 0) // Nothing worth caching
+		return false;
+	vector<char> binary(length); // Driver blob
+	GLenum format = 0; // Binary format
+	glGetProgramBinary(program, length, &length, &format, binary.data());
+
+	ProgramCacheHeader header; // File header
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, PROGRAM_CACHE_MAGIC, sizeof(PROGRAM_CACHE_MAGIC));
+	header.version = PROGRAM_CACHE_VERSION;
+	header.binaryFormat = format;
+	header.key = key;
+	header.binaryLength = (uint32_t)length;
+
+	string tempPath = cachePath + ".tmp"; // Written first, renamed on success
+	ofstream out(tempPath.c_str(), ios::binary | ios::trunc); // Open temp file
+	if (!out) {
+		cout << "ERROR::PROGRAMCACHE::CANNOT_WRITE " << tempPath << endl;
+		return false;
+	}
+	out.write((const char*)&header, sizeof(header)); // Header
+	out.write(binary.data(), length); // Binary
+	out.close(); // Flush
+	if (!out || rename(tempPath.c_str(), cachePath.c_str()) != 0) { // Publish atomically
+		cout << "ERROR::PROGRAMCACHE::CANNOT_WRITE " << cachePath << endl;
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,397 @@
+#pragma once
+// Std. Includes
+#include <vector> // Include vector
+#include <utility> // Include pair
+#include <cstdint> // Include uint64_t
+#include <unordered_map> // Include unordered_map
+#include <algorithm> // Include min
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <glm/glm.hpp> // Include glm
+
+#include "shader.h" // Include shader class
+#include "Frustum.h" // Include CullStats
+#include "Profiler.h" // Include pass timers
+
+// State-sorted render queue. Instead of drawing objects in a hard-coded order, the scene submits one RenderItem
+// per draw call with a 64-bit sort key, the queue radix-sorts the keys and issues the draws through a
+// GLStateCache, so a program, texture or vertex array shared by consecutive items is bound once:
+//   bits 63-60  pass      (Render_Pass, drawn in enum order)
+//   bits 59-48  program   (slot in submission order, slots are reassigned every frame)
+//   bits 47-32  material  (texture set from AddMaterial)
+//   bits 31-20  VAO       (slot in submission order)
+//   bits 19-0   depth     (view distance, front to back, so early depth testing rejects hidden fragments)
+// Items with the same program, textures and VAO end up next to each other and only their uniforms change.
+//
+// With DepthPrepass set, every opaque item whose shader has a depth program (SetDepthProgram) is drawn twice:
+// first in PASS_DEPTH with the depth program and color writes off, then in PASS_OPAQUE with GL_EQUAL and depth
+// writes off, so the expensive fragment shader runs once per visible pixel however much the objects overlap.
+
+const GLuint GL_STATE_CACHE_UNITS = 16; // Texture units tracked (GL 3.3 guarantees 16 per stage)
+const GLuint GL_STATE_UNKNOWN = ~0u; // Cached value after Invalidate, never a GL name
+const GLuint RENDER_NO_MATERIAL = 0; // Material index for items that bind no textures
+const float RENDER_QUEUE_MAX_DEPTH = 100.0f; // Far plane; depths beyond it share the last key value
+const char* const RENDER_DEPTH_PASS_NAME = "depth pre-pass"; // Profiler pass of the PASS_DEPTH items
+
+// Passes in the order they are drawn
+enum Render_Pass {
+	PASS_DEPTH, // Depth-only copies of the opaque items (RenderQueue::DepthPrepass)
+	PASS_OPAQUE // Everything the scene draws
+};
+
+// Remembers the bound program, VAO and textures and skips binds that would not change anything.
+// Only sees calls made through it: call Invalidate whenever other code may have bound something.
+class GLStateCache
+{
+public:
+	GLuint Changes; // Binds issued since Invalidate (glUseProgram, glBindVertexArray, glBindTexture)
+	GLuint Skipped; // Binds skipped since Invalidate because the state was already current
+
+	GLStateCache()
+	{
+		this->Invalidate();
+	}
+
+	// Forgets the tracked state and zeroes the counters, the next bind of each kind always reaches GL
+	void Invalidate()
+	{
+		this->Changes = 0;
+		this->Skipped = 0;
+		this->program = GL_STATE_UNKNOWN;
+		this->vertexArray = GL_STATE_UNKNOWN;
+		this->activeUnit = GL_STATE_UNKNOWN;
+		for (GLuint i = 0; i < GL_STATE_CACHE_UNITS; i++)
+		{
+			this->textures[i] = GL_STATE_UNKNOWN;
+			this->targets[i] = GL_NONE;
+		}
+		this->depthFunc = GL_NONE;
+		this->depthWrite = GL_STATE_UNKNOWN;
+		this->colorWrite = GL_STATE_UNKNOWN;
+	}
+
+	// glUseProgram unless program is already in use
+	void UseProgram(GLuint program)
+	{
+		if (this->program == program)
+		{
+			this->Skipped++;
+			return;
+		}
+		glUseProgram(program);
+		this->program = program;
+		this->Changes++;
+	}
+
+	// glBindVertexArray unless vertexArray is already bound
+	void BindVertexArray(GLuint vertexArray)
+	{
+		if (this->vertexArray == vertexArray)
+		{
+			this->Skipped++;
+			return;
+		}
+		glBindVertexArray(vertexArray);
+		this->vertexArray = vertexArray;
+		this->Changes++;
+	}
+
+	// Binds texture to target on a texture unit, switching the active unit only when a bind is needed
+	void BindTexture(GLuint unit, GLenum target, GLuint texture)
+	{
+		if (unit < GL_STATE_CACHE_UNITS && this->textures[unit] == texture && this->targets[unit] == target)
+		{
+			this->Skipped++;
+			return;
+		}
+		if (this->activeUnit != unit)
+		{
+			glActiveTexture(GL_TEXTURE0 + unit);
+			this->activeUnit = unit;
+		}
+		glBindTexture(target, texture);
+		if (unit < GL_STATE_CACHE_UNITS)
+		{
+			this->textures[unit] = texture;
+			this->targets[unit] = target;
+		}
+		this->Changes++;
+	}
+
+	// Depth test function and depth/color write masks, each set only when it differs (not counted in Changes)
+	void DepthState(GLenum func, GLboolean depthWrite, GLboolean colorWrite)
+	{
+		if (this->depthFunc != func)
+		{
+			glDepthFunc(func);
+			this->depthFunc = func;
+		}
+		if (this->depthWrite != depthWrite)
+		{
+			glDepthMask(depthWrite);
+			this->depthWrite = depthWrite;
+		}
+		if (this->colorWrite != colorWrite)
+		{
+			glColorMask(colorWrite, colorWrite, colorWrite, colorWrite);
+			this->colorWrite = colorWrite;
+		}
+	}
+
+private:
+	GLuint program; // Program in use
+	GLuint vertexArray; // Bound VAO
+	GLuint activeUnit; // Active texture unit
+	GLuint textures[GL_STATE_CACHE_UNITS]; // Texture bound on each unit
+	GLenum targets[GL_STATE_CACHE_UNITS]; // Target it is bound to
+	GLenum depthFunc; // glDepthFunc
+	GLuint depthWrite; // glDepthMask
+	GLuint colorWrite; // glColorMask (all four channels alike)
+};
+
+// One texture of a material
+struct MaterialTexture {
+	GLuint Unit; // Texture unit (the sampler uniforms already point at it)
+	GLenum Target; // GL_TEXTURE_2D, GL_TEXTURE_CUBE_MAP
+	GLuint Texture; // Texture name
+};
+
+// One draw call in the queue. Submit fills the state and the key; the caller fills the draw.
+struct RenderItem {
+	uint64_t Key; // Sort key (RenderQueue::MakeKey)
+	Shader* Program; // Shader to draw with
+	GLuint Material; // Texture set (RenderQueue::AddMaterial)
+	GLuint VertexArray; // VAO
+	const char* PassName; // Profiler pass, a string literal (NULL: not timed)
+
+	bool HasModel; // Upload Model as the "model" uniform
+	glm::mat4 Model; // Model matrix
+	const char* IntName; // One per-draw int uniform (e.g. "packedVertices"), NULL for none
+	GLint IntValue; // Its value
+
+	bool Indexed; // glDrawElements (else glDrawArrays)
+	GLuint First; // First vertex, or first index when Indexed
+	GLsizei Count; // Vertices or indices
+	GLsizei Instances; // Instance count, 1 draws without instancing
+	GLuint RangeFirst; // Index ranges added with RenderQueue::AddRange (replace First/Count)
+	GLsizei RangeCount; // Number of them, drawn with one glMultiDrawElementsBaseVertex
+	GLuint Triangles; // Triangles drawn, for CullStats
+	bool DepthEqual; // Depth laid down by a PASS_DEPTH copy: draw with GL_EQUAL and no depth writes (set by Execute)
+
+	RenderItem() : Key(0), Program(NULL), Material(RENDER_NO_MATERIAL), VertexArray(0), PassName(NULL), HasModel(false), Model(1.0f),
+		IntName(NULL), IntValue(0), Indexed(false), First(0), Count(0), Instances(1), RangeFirst(0), RangeCount(0), Triangles(0), DepthEqual(false) {}
+};
+
+class RenderQueue
+{
+public:
+	GLStateCache State; // Binds issued by Execute (and by the scene between Begin and Execute)
+	bool DepthPrepass; // Lay down depth for the opaque items before shading them (see the top of the file)
+
+	RenderQueue() : DepthPrepass(false)
+	{
+		this->materials.push_back(vector<MaterialTexture>()); // RENDER_NO_MATERIAL
+	}
+
+	// Registers a texture set and returns its material index. Meshes that share textures should share the
+	// index: the key sorts by it, and the cache skips the binds between items that use the same one.
+	GLuint AddMaterial(const vector<MaterialTexture>& textures)
+	{
+		this->materials.push_back(textures);
+		return (GLuint)this->materials.size() - 1;
+	}
+
+	// Draws the depth pre-pass copies of items using shader with depthShader: a program built from the same vertex
+	// shader (so positions match bit for bit, see "invariant gl_Position") and a fragment shader that writes nothing.
+	// It gets the items' per-draw uniforms, so constant uniforms the vertex shader reads must be set on it too.
+	void SetDepthProgram(Shader& shader, Shader& depthShader)
+	{
+		this->depthPrograms[&shader] = &depthShader;
+	}
+
+	// Starts a frame: drops last frame's items and forgets the GL state (other code may have bound anything)
+	void Begin()
+	{
+		this->items.clear();
+		this->rangeCounts.clear();
+		this->rangeOffsets.clear();
+		this->rangeBaseVertices.clear();
+		this->programSlots.clear();
+		this->vertexArraySlots.clear();
+		this->State.Invalidate();
+	}
+
+	// Adds a draw and returns it for the caller to fill the draw range and uniforms (valid until the next Submit).
+	// depth is the distance from the camera, used to draw front to back within the same state.
+	RenderItem& Submit(Render_Pass pass, Shader& shader, GLuint material, GLuint vertexArray, float depth, const char* passName)
+	{
+		this->items.push_back(RenderItem());
+		RenderItem& item = this->items.back();
+		item.Program = &shader;
+		item.Material = material;
+		item.VertexArray = vertexArray;
+		item.PassName = passName;
+		item.Key = MakeKey(pass, slot(this->programSlots, shader.Program), material, slot(this->vertexArraySlots, vertexArray), depth);
+		return item;
+	}
+
+	// Adds an index range (first index, index count, base vertex) to the item just submitted. Items with ranges
+	// draw them all with one glMultiDrawElementsBaseVertex, e.g. the submeshes of a merged Model sharing a material.
+	void AddRange(RenderItem& item, GLuint firstIndex, GLsizei count, GLint baseVertex)
+	{
+		if (item.RangeCount == 0)
+			item.RangeFirst = (GLuint)this->rangeCounts.size(); // Ranges of one item are contiguous
+		item.RangeCount++;
+		item.Indexed = true;
+		this->rangeCounts.push_back(count);
+		this->rangeOffsets.push_back((GLvoid*)(firstIndex * sizeof(GLuint)));
+		this->rangeBaseVertices.push_back(baseVertex);
+	}
+
+	// Sorts the submitted items and draws them. Items with the same PassName must be contiguous in key order
+	// (one name per program within a pass): each run of a name is timed as one profiler pass.
+	void Execute(CullStats& stats, Profiler& profiler)
+	{
+		if (this->DepthPrepass)
+			this->addDepthItems();
+		this->sortItems();
+		const char* scope = NULL; // Profiler pass currently open
+		for (size_t i = 0; i < this->order.size(); i++)
+		{
+			const RenderItem& item = this->items[this->order[i].second];
+			if (item.PassName != scope) // Next run of items
+			{
+				if (scope)
+					profiler.End(scope);
+				scope = item.PassName;
+				if (scope)
+					profiler.Begin(scope);
+			}
+
+			if ((item.Key >> 60) == PASS_DEPTH)
+				this->State.DepthState(GL_LESS, GL_TRUE, GL_FALSE); // Depth only
+			else if (item.DepthEqual)
+				this->State.DepthState(GL_EQUAL, GL_FALSE, GL_TRUE); // Only the fragment that won the pre-pass
+			else
+				this->State.DepthState(GL_LESS, GL_TRUE, GL_TRUE); // Regular depth test
+			this->State.UseProgram(item.Program->Program);
+			const vector<MaterialTexture>& textures = this->materials[item.Material]; // Texture set
+			for (size_t t = 0; t < textures.size(); t++)
+				this->State.BindTexture(textures[t].Unit, textures[t].Target, textures[t].Texture);
+			this->State.BindVertexArray(item.VertexArray);
+			if (item.HasModel)
+				item.Program->SetMat4("model", item.Model);
+			if (item.IntName)
+				item.Program->SetInt(item.IntName, item.IntValue);
+
+			if (item.RangeCount > 0)
+				glMultiDrawElementsBaseVertex(GL_TRIANGLES, &this->rangeCounts[item.RangeFirst], GL_UNSIGNED_INT, &this->rangeOffsets[item.RangeFirst],
+					item.RangeCount, &this->rangeBaseVertices[item.RangeFirst]);
+			else if (item.Indexed && item.Instances != 1)
+				glDrawElementsInstanced(GL_TRIANGLES, item.Count, GL_UNSIGNED_INT, (GLvoid*)(item.First * sizeof(GLuint)), item.Instances);
+			else if (item.Indexed)
+				glDrawElements(GL_TRIANGLES, item.Count, GL_UNSIGNED_INT, (GLvoid*)(item.First * sizeof(GLuint)));
+			else if (item.Instances != 1)
+				glDrawArraysInstanced(GL_TRIANGLES, item.First, item.Count, item.Instances);
+			else
+				glDrawArrays(GL_TRIANGLES, item.First, item.Count);
+			stats.AddDraw(item.Triangles);
+		}
+		if (scope)
+			profiler.End(scope);
+		this->State.DepthState(GL_LESS, GL_TRUE, GL_TRUE); // Defaults back for glClear and the overlay
+		stats.StateChanges = this->State.Changes; // Everything bound since Begin
+	}
+
+	// Packs the key fields (see the layout at the top), each clamped to its bit range
+	static uint64_t MakeKey(Render_Pass pass, GLuint programSlot, GLuint material, GLuint vertexArraySlot, float depth)
+	{
+		float scaled = min(max(depth / RENDER_QUEUE_MAX_DEPTH, 0.0f), 1.0f) * (float)0xFFFFF; // 20-bit depth
+		return ((uint64_t)min((GLuint)pass, 0xFu) << 60) | ((uint64_t)min(programSlot, 0xFFFu) << 48) |
+			((uint64_t)min(material, 0xFFFFu) << 32) | ((uint64_t)min(vertexArraySlot, 0xFFFu) << 20) | (uint64_t)scaled;
+	}
+
+	// Items submitted this frame
+	size_t Size() const
+	{
+		return this->items.size();
+	}
+
+private:
+	vector<vector<MaterialTexture> > materials; // Texture sets, index 0 is empty
+	vector<RenderItem> items; // This frame's draws in submission order
+	vector<GLsizei> rangeCounts; // AddRange index counts
+	vector<GLvoid*> rangeOffsets; // AddRange byte offsets into the element buffer
+	vector<GLint> rangeBaseVertices; // AddRange base vertices
+	vector<pair<uint64_t, GLuint> > order; // (key, item) sorted by key
+	vector<pair<uint64_t, GLuint> > scratch; // Radix sort buffer
+	unordered_map<GLuint, GLuint> programSlots; // Program name -> key slot
+	unordered_map<GLuint, GLuint> vertexArraySlots; // VAO name -> key slot
+	unordered_map<const Shader*, Shader*> depthPrograms; // Shader -> its depth pre-pass program
+
+	// Small dense index for a GL name, in first-seen order
+	static GLuint slot(unordered_map<GLuint, GLuint>& slots, GLuint name)
+	{
+		unordered_map<GLuint, GLuint>::iterator found = slots.find(name);
+		if (found != slots.end())
+			return found->second;
+		GLuint index = (GLuint)slots.size(); // Next free slot
+		slots[name] = index;
+		return index;
+	}
+
+	// Queues a PASS_DEPTH copy of every opaque item that has a depth program, with the same geometry, uniforms,
+	// VAO and depth but no textures, and marks the original to test GL_EQUAL against it
+	void addDepthItems()
+	{
+		size_t count = this->items.size(); // Submitted items (the copies go after them)
+		for (size_t i = 0; i < count; i++)
+		{
+			if ((this->items[i].Key >> 60) != PASS_OPAQUE)
+				continue;
+			unordered_map<const Shader*, Shader*>::const_iterator found = this->depthPrograms.find(this->items[i].Program);
+			if (found == this->depthPrograms.end()) // Shaded with the regular depth test
+				continue;
+			this->items[i].DepthEqual = true;
+			RenderItem depth = this->items[i]; // Copy before push_back moves the items
+			depth.Program = found->second;
+			depth.Material = RENDER_NO_MATERIAL; // Nothing is sampled
+			depth.PassName = RENDER_DEPTH_PASS_NAME;
+			depth.DepthEqual = false;
+			GLuint vertexArraySlot = (GLuint)(depth.Key >> 20) & 0xFFFu; // Same VAO slot
+			depth.Key = MakeKey(PASS_DEPTH, slot(this->programSlots, depth.Program->Program), RENDER_NO_MATERIAL, vertexArraySlot, 0.0f)
+				| (depth.Key & 0xFFFFFu); // Same depth, front to back
+			this->items.push_back(depth);
+		}
+	}
+
+	// LSD radix sort of (key, item) pairs, one byte per pass. Stable, so equal keys keep submission order.
+	// Bytes every key shares (most of the pass and slot bits in a small scene) are skipped.
+	void sortItems()
+	{
+		size_t count = this->items.size(); // Items to sort
+		this->order.resize(count);
+		this->scratch.resize(count);
+		for (size_t i = 0; i < count; i++)
+			this->order[i] = make_pair(this->items[i].Key, (GLuint)i);
+		for (GLuint shift = 0; shift < 64; shift += 8)
+		{
+			size_t offsets[256] = { 0 }; // Histogram, then first output slot per digit
+			for (size_t i = 0; i < count; i++)
+				offsets[(this->order[i].first >> shift) & 0xFF]++;
+			if (count == 0 || offsets[(this->order[0].first >> shift) & 0xFF] == count) // Every key has the same byte here
+				continue;
+			size_t total = 0; // Running prefix sum
+			for (GLuint digit = 0; digit < 256; digit++)
+			{
+				size_t n = offsets[digit];
+				offsets[digit] = total;
+				total += n;
+			}
+			for (size_t i = 0; i < count; i++)
+				this->scratch[offsets[(this->order[i].first >> shift) & 0xFF]++] = this->order[i];
+			this->order.swap(this->scratch);
+		}
+	}
+};
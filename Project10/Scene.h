@@ -0,0 +1,329 @@
+// Scene Class
+
+#pragma once
+
+#include <string> // Include string
+#include <vector> // Include vector
+#include <cmath> // Include tan
+using namespace std; // Use namespace std
+
+#include <GL/glew.h> // Include glew to get all the required OpenGL headers
+#include <SOIL/SOIL.h> // soil include
+#include <glm/glm.hpp> // glm include
+#include <glm/gtc/matrix_transform.hpp> // glm matrix math include
+
+#include "shader.h" // Include shader class
+#include "Camera.h" // Include Camera class
+#include "Model.h" // Include Model class
+#include "TextureManager.h" // Include shared texture cache
+#include "Frustum.h" // Include frustum culling
+#include "Profiler.h" // Include GPU/CPU pass timers
+#include "RenderQueue.h" // Include state-sorted render queue
+
+const GLint BOARD_COLUMNS = 8, BOARD_ROWS = 8; // Checkerboard size in tiles (drawn instanced, so 256x256 costs the same CPU time)
+const glm::vec3 BOARD_ORIGIN(-4.0f, -0.5f, -9.0f); // Center of tile (0, 0)
+const glm::vec3 TILE_SCALE(1.0f, 0.1f, 1.0f); // Unit cube scaled to a tile
+
+// The Project 10 scene: checkerboard, environment mapped cube, bump mapped cylinder and sphere.
+// Owns every shader, model, buffer and texture, and draws one frame into whatever framebuffer is bound.
+// The window loop (main.cpp) and the headless benchmark (Headless.h) both call Render, so numbers
+// measured headless are for exactly the code the interactive binary runs. Needs a current GL context.
+class Scene {
+public:
+    glm::vec3 LightPos; // Light position
+    CullStats Stats; // Culling and draw counters of the last Render
+    Profiler Profile; // Per-pass GPU/CPU timings ("depth pre-pass", "checkerboard", "cube env map", "cylinder bump", "sphere")
+    bool ParallaxOcclusion; // Sphere uses adaptive parallax occlusion mapping instead of the single-step offset
+    bool DepthPrepass; // Draw depth only first, then shade with GL_EQUAL (see RenderQueue::DepthPrepass)
+
+    Scene() :
+        LightPos(1.0f, 1.0f, -2.0f), // Sets light position
+        ParallaxOcclusion(true), // Adaptive POM on by default
+        DepthPrepass(true), // Pre-pass on by default (cheaper whenever objects overlap)
+        checkerboardShader("checkerboard.vs", "checkerboard.frag"), // Create shader for checkerboard
+        cubeShader("cube.vs", "cube.frag"), // Create shader for cube object
+        cylinderShader("cylinder.vs", "cylinder.frag"), // Create shader for cylinder object
+        sphereShader("sphere.vs", "sphere.frag"), // Create shader for sphere object
+        checkerboardDepthShader("checkerboard.vs", "depth.frag"), // Depth pre-pass programs: same vertex shaders, empty fragment shader
+        cubeDepthShader("cube.vs", "depth.frag"),
+        cylinderDepthShader("cylinder.vs", "depth.frag"),
+        sphereDepthShader("sphere.vs", "depth.frag"),
+        cylinderModel("cylinder.obj", true, VERTEX_PACKED, true), // Defines model for cylinder using obj (packed 24-byte vertices, decoded in cylinder.vs, submeshes merged)
+        sphereModel("sphere.obj", true, VERTEX_PACKED, true), // Define model for sphere using obj (decoded in sphere.vs, submeshes merged)
+        cylinderLod(0), sphereLod(0) { // Full detail until the first frame picks a level
+        this->setConstantUniforms(); // Sampler units, tiling and board layout
+
+        GLfloat vertices[] = {
+            // Coordinates: 3 Position, 3 Color, 2 TexCoord, 3 Tangent, 3 Bitangent
+            // Back face of cube (normal: 0, 0, -1)
+            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
+            0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom right
+            0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
+            0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper left
+            -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
+
+            // Front face of cube (normal: 0, 0, 1)
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
+            0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom right
+            0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
+            0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
+            -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper left
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
+
+            // Left face (normal: -1, 0, 0)
+            -0.5f, 0.5f, 0.5f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
+            -0.5f, 0.5f, -0.5f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper far
+            -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
+            -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower close
+            -0.5f, 0.5f, 0.5f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
+
+            // Right face (normal: 1, 0, 0)
+            0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
+            0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper far
+            0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
+            0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
+            0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower close
+            0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
+
+            // Bottom face (normal: 0, -1, 0)
+            -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, // Left far
+            0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, // Right far
+            0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, // Right close
+            0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, // Right close
+            -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, // Left close
+            -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, // Left far
+
+            // Top Face (normal: 0, 1, 0)
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // Left far
+            0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // Right far
+            0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Right close
+            0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Right close
+            -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Left close
+            -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f // Left far
+        };
+        this->VAO.Create(); // Generate VAO
+        this->VBO.Create(); // Generate VBO
+
+        glBindVertexArray(this->VAO.Get());  // Bind VAO
+
+        glBindBuffer(GL_ARRAY_BUFFER, this->VBO.Get());  // Bind VBO
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);  // Buffer Data
+
+        // Position attribute (location 0)
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)0);
+        glEnableVertexAttribArray(0);
+
+        // Color attribute (location 1) - not used but kept for vertex data structure
+        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(1);
+
+        // TexCoord attribute (location 2)
+        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(2);
+
+        // Tangent attribute (location 3)
+        glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(8 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(3);
+
+        // Bitangent attribute (location 4)
+        glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(11 * sizeof(GLfloat)));
+        glEnableVertexAttribArray(4);
+
+        glBindVertexArray(0); // Unbind VAO
+
+        // LOAD TEXTURES FOR PARALLAX MAPPING (shared through the TextureManager, same cache the models use)
+        this->diffuseTexture = TextureManager::Instance().Acquire2D("Bump-Picture.jpg", SOIL_LOAD_RGB); // Diffuse texture
+        this->bumpMap = TextureManager::Instance().AcquireBumpMap("Bump-Map.jpg"); // Normal + height from the height map
+
+        // LOAD CUBEMAP TEXTURE for skybox (6 face images)
+        // Face filenames in OpenGL cubemap order (posy and negy swapped to correct vertical orientation)
+        vector<string> cubemapFaces = {
+            "posx.jpg", // GL_TEXTURE_CUBE_MAP_POSITIVE_X (right)
+            "negx.jpg", // GL_TEXTURE_CUBE_MAP_NEGATIVE_X (left)
+            "negy.jpg", // GL_TEXTURE_CUBE_MAP_POSITIVE_Y (top) - swapped
+            "posy.jpg", // GL_TEXTURE_CUBE_MAP_NEGATIVE_Y (bottom) - swapped
+            "posz.jpg", // GL_TEXTURE_CUBE_MAP_POSITIVE_Z (front)
+            "negz.jpg"  // GL_TEXTURE_CUBE_MAP_NEGATIVE_Z (back)
+        };
+        this->cubemapTexture = TextureManager::Instance().AcquireCubemap(cubemapFaces); // Load cubemap
+
+        // Texture sets for the render queue; the handles never change, the loader fills them in place
+        this->envMaterial = this->queue.AddMaterial({ { 0, GL_TEXTURE_CUBE_MAP, this->cubemapTexture } }); // Cube
+        this->bumpMaterial = this->queue.AddMaterial({ { 0, GL_TEXTURE_2D, this->diffuseTexture }, { 1, GL_TEXTURE_2D, this->bumpMap } }); // Cylinder and sphere
+        this->queue.SetDepthProgram(this->checkerboardShader, this->checkerboardDepthShader); // Pre-pass program of each shader
+        this->queue.SetDepthProgram(this->cubeShader, this->cubeDepthShader);
+        this->queue.SetDepthProgram(this->cylinderShader, this->cylinderDepthShader);
+        this->queue.SetDepthProgram(this->sphereShader, this->sphereDepthShader);
+    }
+
+    // Deallocate resources (before the context goes away). The cube buffers and the models' meshes are
+    // GL handles and delete themselves with the members.
+    ~Scene() {
+        TextureManager::Instance().Release(this->diffuseTexture); // Release diffuse texture
+        TextureManager::Instance().Release(this->bumpMap); // Release bump map
+        TextureManager::Instance().Release(this->cubemapTexture); // Release cubemap texture
+    }
+    Scene(const Scene&) = delete; // Owns GL objects, no copies
+    Scene& operator=(const Scene&) = delete;
+
+    // Hot-reloads edited shaders (see Shader::Update) and sets the constant uniforms on replaced programs.
+    // Call once per frame from the window loop.
+    void Update() {
+        bool reloaded = false; // Any program replaced
+        reloaded |= this->checkerboardShader.Update(); // Poll every shader, compiles overlap
+        reloaded |= this->cubeShader.Update();
+        reloaded |= this->cylinderShader.Update();
+        reloaded |= this->sphereShader.Update();
+        reloaded |= this->checkerboardDepthShader.Update();
+        reloaded |= this->cubeDepthShader.Update();
+        reloaded |= this->cylinderDepthShader.Update();
+        reloaded |= this->sphereDepthShader.Update();
+        if (reloaded)
+            this->setConstantUniforms(); // New programs start with default uniform values
+    }
+
+    // Clears and draws one frame seen from camera into the bound framebuffer (width x height pixels)
+    void Render(Camera& camera, GLuint width, GLuint height) {
+        this->Profile.BeginFrame(); // Collect last frames' timers
+        ProfileScope frameScope(this->Profile, "frame"); // Whole frame
+
+        glViewport(0, 0, width, height); // Define viewport dimensions
+        glEnable(GL_DEPTH_TEST); // Set up OpenGL options
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // Set background color
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear buffers
+
+        // Initialize Camera
+        camera.SetPerspective(CAMERA_FOVY, (GLfloat)width / (GLfloat)height, CAMERA_NEAR, CAMERA_FAR); // Initialize projection using initial values
+        glm::mat4 view = camera.GetViewMatrix(); // Set view based on camera (cached while it doesn't move)
+        glm::mat4 projection = camera.GetProjectionMatrix(); // Projection set above
+        float pixelsPerUnit = height * projection[1][1] / 2.0f; // Projection scale for LOD selection, from the matrix in use
+
+        // Upload camera + light once for every program (FrameData uniform block)
+        this->frameUniforms.Update(view, projection, camera.Position, this->LightPos, glm::vec3(1.0f, 1.0f, 1.0f)); // White light
+
+        // Frustum for this frame; everything below is skipped when fully outside it
+        const Frustum& frustum = camera.GetFrustum(); // World-space planes, cached by the camera
+        this->Stats.Reset(); // New frame
+
+        // Every draw goes through the render queue: submitted here in any order, sorted by pass, program,
+        // material and VAO, then drawn with redundant binds skipped (see RenderQueue.h)
+        this->queue.Begin(); // New frame, forget the bound state
+        this->queue.DepthPrepass = this->DepthPrepass; // Depth-only copies of every item first
+        this->queue.State.UseProgram(this->sphereShader.Program); // Per-frame uniform of the sphere program
+        this->sphereShader.SetInt("parallaxOcclusion", this->ParallaxOcclusion); // Parallax mode
+
+        // CHECKERBOARD - instanced draws over the visible rows (tile position and color come from gl_InstanceID)
+        this->submitBoard(frustum, camera.Position); // Queue visible tiles
+
+        // CUBE - environment mapped cube the camera can walk into
+        glm::mat4 model_cube = glm::mat4(1.0f); // Create cube model matrix
+        model_cube = glm::translate(model_cube, glm::vec3(0.0f, 0.0f, -5.5f)); // Place cube in world aligned with other shapes
+        if (this->Stats.Record(frustum.IntersectsBounds(model_cube, glm::vec3(-0.5f), glm::vec3(0.5f), glm::vec3(0.0f), 0.8661f))) { // Unit cube bounds
+            RenderItem& cube = this->queue.Submit(PASS_OPAQUE, this->cubeShader, this->envMaterial, this->VAO.Get(), distanceTo(camera, model_cube), "cube env map");
+            cube.HasModel = true; // Pass cube model to shader
+            cube.Model = model_cube;
+            cube.Count = 36; // Draw cube
+            cube.Triangles = 12; // Six faces, two triangles each
+        }
+
+        // CYLINDER - bump mapped
+        glm::mat4 model_cylinder = glm::mat4(1.0f); // Initialize cylinder model matrix
+        model_cylinder = glm::translate(model_cylinder, glm::vec3(-2.0f, -3.0f, -5.0f)); // Translate cylinder
+        model_cylinder = glm::scale(model_cylinder, glm::vec3(0.5f, 3.0f, 0.5f)); // Scale cylinder
+        this->cylinderLod = this->cylinderModel.SelectLod(camera.Position, model_cylinder, pixelsPerUnit, this->cylinderLod); // Pick detail from screen size
+        this->cylinderModel.Submit(this->queue, PASS_OPAQUE, this->cylinderShader, this->bumpMaterial, this->cylinderLod, frustum, model_cylinder,
+            distanceTo(camera, model_cylinder), "cylinder bump", this->Stats); // Queue obj model (culled per mesh)
+
+        // SPHERE - bump mapped with height map, same textures as the cylinder
+        glm::mat4 model_sphere = glm::mat4(1.0f); // Initialize sphere model matrix
+        model_sphere = glm::translate(model_sphere, glm::vec3(1.5f, 0.0f, -5.5f)); // Translate sphere
+        model_sphere = glm::scale(model_sphere, glm::vec3(0.5f, 0.5f, 0.5f)); // Scale sphere
+        this->sphereLod = this->sphereModel.SelectLod(camera.Position, model_sphere, pixelsPerUnit, this->sphereLod); // Pick detail from screen size
+        this->sphereModel.Submit(this->queue, PASS_OPAQUE, this->sphereShader, this->bumpMaterial, this->sphereLod, frustum, model_sphere,
+            distanceTo(camera, model_sphere), "sphere", this->Stats); // Queue sphere obj model (culled per mesh)
+
+        this->queue.Execute(this->Stats, this->Profile); // Sort and draw, one profiler pass per object type (and one for the pre-pass)
+        glBindVertexArray(0); // Bind zero at end
+    }
+
+private:
+    Shader checkerboardShader; // Instanced checkerboard
+    Shader cubeShader; // Environment mapped cube
+    Shader cylinderShader; // Bump mapped cylinder
+    Shader sphereShader; // Bump mapped sphere
+    Shader checkerboardDepthShader; // Depth pre-pass programs of the four shaders above
+    Shader cubeDepthShader;
+    Shader cylinderDepthShader;
+    Shader sphereDepthShader;
+    FrameUniforms frameUniforms; // Shared camera/light uniform buffer, read by every program through the FrameData block
+    Model cylinderModel; // Cylinder obj
+    Model sphereModel; // Sphere obj
+    GLuint cylinderLod, sphereLod; // Level of detail drawn last frame (for hysteresis)
+    GLVertexArray VAO; // Unit cube, shared by the cube and the board tiles (deleted with the scene)
+    GLBuffer VBO; // Its vertices
+    GLuint diffuseTexture; // Bump-Picture.jpg
+    GLuint bumpMap; // Bump-Map.jpg as normal X/Y + height
+    GLuint cubemapTexture; // Environment cubemap
+    RenderQueue queue; // Sorted draws of the frame and the GL state cache
+    GLuint envMaterial; // Queue material: cubemap on unit 0
+    GLuint bumpMaterial; // Queue material: diffuse on unit 0, bump map on unit 1 (cylinder and sphere)
+
+    // Constant uniforms: sampler units and UV tiling never change, so set them once instead of every frame
+    // (and again after a hot reload replaced a program)
+    void setConstantUniforms() {
+        this->checkerboardDepthShader.Use(); // Board layout for the pre-pass too, it runs the same vertex shader
+        this->checkerboardDepthShader.SetInt("boardColumns", BOARD_COLUMNS);
+        this->checkerboardDepthShader.SetVec3("boardOrigin", BOARD_ORIGIN);
+        this->checkerboardDepthShader.SetVec3("tileScale", TILE_SCALE);
+        this->checkerboardShader.Use(); // Activate checkerboard shader
+        this->checkerboardShader.SetInt("boardColumns", BOARD_COLUMNS); // Tiles per row
+        this->checkerboardShader.SetVec3("boardOrigin", BOARD_ORIGIN); // Corner tile position
+        this->checkerboardShader.SetVec3("tileScale", TILE_SCALE); // Scale squares to be like tiles
+        this->checkerboardShader.SetVec3("evenColor", glm::vec3(1.0f, 0.0f, 1.0f)); // Purple
+        this->checkerboardShader.SetVec3("oddColor", glm::vec3(1.0f, 1.0f, 1.0f)); // White
+        this->cubeShader.Use(); // Activate cube shader
+        this->cubeShader.SetInt("skybox", 0); // Cubemap on unit 0
+        this->cylinderShader.Use(); // Activate cylinder shader
+        this->cylinderShader.SetInt("diffuseTexture", 0); // Diffuse on unit 0
+        this->cylinderShader.SetInt("bumpMap", 1); // Bump map on unit 1
+        this->cylinderShader.SetVec2("uvScale", 3.0f, 2.0f); // Repeat texture on cylinder
+        this->sphereShader.Use(); // Activate sphere shader
+        this->sphereShader.SetInt("diffuseTexture", 0); // Diffuse on unit 0
+        this->sphereShader.SetInt("bumpMap", 1); // Bump map on unit 1
+        this->sphereShader.SetVec2("uvScale", 2.0f, 2.0f); // Repeat texture on sphere
+    }
+
+    // Queues the checkerboard as one instanced draw per run of consecutive rows that intersect the frustum
+    void submitBoard(const Frustum& frustum, const glm::vec3& cameraPosition) {
+        glm::vec3 half = TILE_SCALE * 0.5f; // Tile half size
+        GLint runStart = -1; // First row of the current visible run
+        for (GLint row = 0; row <= BOARD_ROWS; row++) { // One past the end flushes the last run
+            bool visible = false; // Row intersects the frustum
+            if (row < BOARD_ROWS) {
+                glm::vec3 rowMin = BOARD_ORIGIN + glm::vec3(0.0f, 0.0f, (float)row) - half; // Row AABB
+                glm::vec3 rowMax = BOARD_ORIGIN + glm::vec3((float)(BOARD_COLUMNS - 1), 0.0f, (float)row) + half;
+                visible = this->Stats.Record(frustum.IntersectsBox(rowMin, rowMax), BOARD_COLUMNS); // Count tiles
+            }
+            if (visible && runStart < 0)
+                runStart = row; // Run begins
+            if (!visible && runStart >= 0) { // Run ends, queue it
+                glm::vec3 center = BOARD_ORIGIN + glm::vec3((BOARD_COLUMNS - 1) * 0.5f, 0.0f, (runStart + row - 1) * 0.5f); // Middle of the run
+                RenderItem& tiles = this->queue.Submit(PASS_OPAQUE, this->checkerboardShader, RENDER_NO_MATERIAL, this->VAO.Get(),
+                    glm::length(center - cameraPosition), "checkerboard");
+                tiles.IntName = "boardFirstTile"; // Offset gl_InstanceID
+                tiles.IntValue = runStart * BOARD_COLUMNS;
+                tiles.Count = 36; // Unit cube per tile
+                tiles.Instances = (row - runStart) * BOARD_COLUMNS; // Draw the rows
+                tiles.Triangles = 12 * (row - runStart) * BOARD_COLUMNS; // 12 triangles per tile
+                runStart = -1;
+            }
+        }
+    }
+
+    // Camera distance to an object's origin, for front-to-back sorting
+    static float distanceTo(const Camera& camera, const glm::mat4& model) {
+        return glm::length(glm::vec3(model[3]) - camera.Position);
+    }
+};
@@ -0,0 +1,202 @@
+#pragma once
+// Std. Includes
+#include <vector> // Include vector
+#include <thread> // Include thread
+#include <algorithm> // Include min/max
+#include <cmath> // Include sqrt/fabs
+using namespace std; // Use namespace std
+// SIMD Includes
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 intrinsics
+#define TANGENT_SPACE_SSE 1
+#endif
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <glm/glm.hpp> // Include glm
+
+#include "Mesh.h" // Include Mesh.h for Vertex
+
+// Per-vertex tangent frame generation used by Model after loading.
+// 1. Positions and UVs are copied into structure-of-arrays buffers.
+// 2. Triangles are split across worker threads. Each thread computes triangle tangents/bitangents four at a
+//    time with SSE and scatters them into its own accumulation buffers, so no locking or atomics are needed.
+// 3. The per-thread buffers are summed per vertex (again split across threads) and every frame is
+//    Gram-Schmidt orthonormalized against the vertex normal, with the bitangent rebuilt from the handedness.
+// Triangles with a (near) zero UV determinant contribute nothing, and vertices left without a usable tangent
+// get an arbitrary one perpendicular to the normal, so the output never contains NaNs.
+
+const GLuint TANGENT_SPACE_MIN_TRIANGLES_PER_THREAD = 16384; // Below this per thread, threading costs more than it saves
+const float TANGENT_SPACE_DEGENERATE_UV = 1e-12f; // |det| of the UV edge matrix treated as zero
+
+// Structure-of-arrays tangent/bitangent accumulator for one thread
+struct TangentAccumulator {
+	vector<float> tx, ty, tz; // Tangent sums
+	vector<float> bx, by, bz; // Bitangent sums
+
+	void Resize(size_t count)
+	{
+		tx.assign(count, 0.0f); ty.assign(count, 0.0f); tz.assign(count, 0.0f);
+		bx.assign(count, 0.0f); by.assign(count, 0.0f); bz.assign(count, 0.0f);
+	}
+
+	// Adds one triangle's tangent and bitangent to its three corners
+	void Add(const GLuint* corners, const float* t, const float* b)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			GLuint v = corners[c]; // Corner vertex
+			tx[v] += t[0]; ty[v] += t[1]; tz[v] += t[2];
+			bx[v] += b[0]; by[v] += b[1]; bz[v] += b[2];
+		}
+	}
+};
+
+// Vertex positions and UVs in structure-of-arrays form for the triangle kernels
+struct TangentSpaceInput {
+	vector<float> px, py, pz; // Positions
+	vector<float> u, v; // Texture coordinates
+};
+
+// Scalar tangent/bitangent of one triangle; returns false for degenerate UVs
+inline bool TriangleTangent(const TangentSpaceInput& in, const GLuint* tri, float* t, float* b)
+{
+	float e1x = in.px[tri[1]] - in.px[tri[0]], e1y = in.py[tri[1]] - in.py[tri[0]], e1z = in.pz[tri[1]] - in.pz[tri[0]]; // Edge 1
+	float e2x = in.px[tri[2]] - in.px[tri[0]], e2y = in.py[tri[2]] - in.py[tri[0]], e2z = in.pz[tri[2]] - in.pz[tri[0]]; // Edge 2
+	float du1 = in.u[tri[1]] - in.u[tri[0]], dv1 = in.v[tri[1]] - in.v[tri[0]]; // UV delta 1
+	float du2 = in.u[tri[2]] - in.u[tri[0]], dv2 = in.v[tri[2]] - in.v[tri[0]]; // UV delta 2
+	float det = du1 * dv2 - du2 * dv1; // UV determinant
+	if (!(fabs(det) > TANGENT_SPACE_DEGENERATE_UV)) // Zero, tiny or NaN
+		return false;
+	float f = 1.0f / det; // Inverse determinant
+	t[0] = f * (dv2 * e1x - dv1 * e2x); t[1] = f * (dv2 * e1y - dv1 * e2y); t[2] = f * (dv2 * e1z - dv1 * e2z); // Tangent
+	b[0] = f * (du1 * e2x - du2 * e1x); b[1] = f * (du1 * e2y - du2 * e1y); b[2] = f * (du1 * e2z - du2 * e1z); // Bitangent
+	return true;
+}
+
+// Accumulates the triangles [first, last) into out
+inline void AccumulateTangents(const TangentSpaceInput& in, const GLuint* indices, size_t first, size_t last, TangentAccumulator& out)
+{
+	size_t tri = first; // Current triangle
+#ifdef TANGENT_SPACE_SSE
+	// Four triangles per iteration: gather corners into registers, compute in SIMD, scatter scalar
+	for (; tri + 4 <= last; tri += 4)
+	{
+		const GLuint* idx = indices + tri * 3; // 12 indices
+		#define TS_GATHER(arr, corner) _mm_setr_ps(in.arr[idx[corner]], in.arr[idx[3 + corner]], in.arr[idx[6 + corner]], in.arr[idx[9 + corner]])
+		__m128 x0 = TS_GATHER(px, 0), y0 = TS_GATHER(py, 0), z0 = TS_GATHER(pz, 0); // Corner 0 positions
+		__m128 e1x = _mm_sub_ps(TS_GATHER(px, 1), x0), e1y = _mm_sub_ps(TS_GATHER(py, 1), y0), e1z = _mm_sub_ps(TS_GATHER(pz, 1), z0); // Edge 1
+		__m128 e2x = _mm_sub_ps(TS_GATHER(px, 2), x0), e2y = _mm_sub_ps(TS_GATHER(py, 2), y0), e2z = _mm_sub_ps(TS_GATHER(pz, 2), z0); // Edge 2
+		__m128 u0 = TS_GATHER(u, 0), v0 = TS_GATHER(v, 0); // Corner 0 UVs
+		__m128 du1 = _mm_sub_ps(TS_GATHER(u, 1), u0), dv1 = _mm_sub_ps(TS_GATHER(v, 1), v0); // UV delta 1
+		__m128 du2 = _mm_sub_ps(TS_GATHER(u, 2), u0), dv2 = _mm_sub_ps(TS_GATHER(v, 2), v0); // UV delta 2
+		#undef TS_GATHER
+
+		__m128 det = _mm_sub_ps(_mm_mul_ps(du1, dv2), _mm_mul_ps(du2, dv1)); // UV determinants
+		__m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.0f), det); // |det| (NaN stays NaN and fails the compare)
+		__m128 valid = _mm_cmpgt_ps(absDet, _mm_set1_ps(TANGENT_SPACE_DEGENERATE_UV)); // Usable lanes
+		__m128 f = _mm_and_ps(_mm_div_ps(_mm_set1_ps(1.0f), det), valid); // 1/det, zero for degenerate lanes
+
+		float t[3][4], b[3][4]; // Lane results
+		_mm_storeu_ps(t[0], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(dv2, e1x), _mm_mul_ps(dv1, e2x)))); // Tangent x
+		_mm_storeu_ps(t[1], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(dv2, e1y), _mm_mul_ps(dv1, e2y)))); // Tangent y
+		_mm_storeu_ps(t[2], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(dv2, e1z), _mm_mul_ps(dv1, e2z)))); // Tangent z
+		_mm_storeu_ps(b[0], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1, e2x), _mm_mul_ps(du2, e1x)))); // Bitangent x
+		_mm_storeu_ps(b[1], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1, e2y), _mm_mul_ps(du2, e1y)))); // Bitangent y
+		_mm_storeu_ps(b[2], _mm_mul_ps(f, _mm_sub_ps(_mm_mul_ps(du1, e2z), _mm_mul_ps(du2, e1z)))); // Bitangent z
+		int mask = _mm_movemask_ps(valid); // One bit per usable lane
+
+		for (int lane = 0; lane < 4; lane++)
+		{
+			if (!(mask & (1 << lane))) // Degenerate UVs, skip
+				continue;
+			float laneT[3] = { t[0][lane], t[1][lane], t[2][lane] };
+			float laneB[3] = { b[0][lane], b[1][lane], b[2][lane] };
+			out.Add(idx + lane * 3, laneT, laneB); // Scatter to corners
+		}
+	}
+#endif
+	// Remainder (or everything without SSE)
+	for (; tri < last; tri++)
+	{
+		float t[3], b[3]; // Triangle frame
+		if (TriangleTangent(in, indices + tri * 3, t, b))
+			out.Add(indices + tri * 3, t, b);
+	}
+}
+
+// Sums the accumulators for vertices [first, last) and writes orthonormal frames into vertices
+inline void ResolveTangents(vector<Vertex>& vertices, const vector<TangentAccumulator>& sums, size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		glm::vec3 t(0.0f), b(0.0f); // Summed frame
+		for (size_t s = 0; s < sums.size(); s++)
+		{
+			t += glm::vec3(sums[s].tx[i], sums[s].ty[i], sums[s].tz[i]);
+			b += glm::vec3(sums[s].bx[i], sums[s].by[i], sums[s].bz[i]);
+		}
+
+		glm::vec3 n = vertices[i].Normal; // Vertex normal
+		float nLength = glm::length(n);
+		n = (nLength > 0.0f) ? n / nLength : glm::vec3(0.0f, 0.0f, 1.0f); // Missing normals fall back to +Z
+
+		t -= n * glm::dot(n, t); // Gram-Schmidt against the normal
+		float tLength = glm::length(t);
+		if (!(tLength > 1e-20f)) // No contribution, or tangent parallel to the normal
+			t = (fabs(n.x) < 0.9f) ? glm::cross(n, glm::vec3(1.0f, 0.0f, 0.0f)) : glm::cross(n, glm::vec3(0.0f, 1.0f, 0.0f));
+		t = glm::normalize(t);
+
+		float handedness = (glm::dot(glm::cross(n, t), b) < 0.0f) ? -1.0f : 1.0f; // Mirrored UVs flip B
+		vertices[i].Tangent = t; // Orthonormal tangent
+		vertices[i].Bitangent = glm::cross(n, t) * handedness; // Orthonormal bitangent
+	}
+}
+
+// Runs fn(first, last, worker) over [0, count) split across up to workerCount threads
+template <typename Fn>
+inline void TangentSpaceParallelFor(size_t count, size_t workerCount, Fn fn)
+{
+	if (workerCount <= 1) {
+		fn((size_t)0, count, (size_t)0);
+		return;
+	}
+	vector<thread> threads; // Workers
+	size_t chunk = (count + workerCount - 1) / workerCount; // Items per worker
+	for (size_t w = 0; w < workerCount; w++)
+	{
+		size_t first = min(count, w * chunk), last = min(count, first + chunk); // Worker range
+		threads.push_back(thread(fn, first, last, w));
+	}
+	for (size_t w = 0; w < threads.size(); w++)
+		threads[w].join(); // Wait for workers
+}
+
+// Fills Tangent and Bitangent of every vertex from the triangle list in indices
+inline void GenerateTangents(vector<Vertex>& vertices, const vector<GLuint>& indices)
+{
+	size_t vertexCount = vertices.size(); // Vertices to fill
+	size_t triangleCount = indices.size() / 3; // Whole triangles only
+
+	// Copy into structure-of-arrays form for the kernels
+	TangentSpaceInput in; // SoA positions + UVs
+	in.px.resize(vertexCount); in.py.resize(vertexCount); in.pz.resize(vertexCount);
+	in.u.resize(vertexCount); in.v.resize(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+	{
+		in.px[i] = vertices[i].Position.x; in.py[i] = vertices[i].Position.y; in.pz[i] = vertices[i].Position.z;
+		in.u[i] = vertices[i].TexCoords.x; in.v[i] = vertices[i].TexCoords.y;
+	}
+
+	// Only go wide when every worker gets a meaningful batch (each one also needs its own accumulator)
+	size_t workerCount = max(1u, thread::hardware_concurrency()); // One per core
+	workerCount = max((size_t)1, min(workerCount, triangleCount / TANGENT_SPACE_MIN_TRIANGLES_PER_THREAD));
+
+	vector<TangentAccumulator> sums(workerCount); // One accumulator per worker
+	TangentSpaceParallelFor(triangleCount, workerCount, [&](size_t first, size_t last, size_t worker) {
+		sums[worker].Resize(vertexCount); // Zeroed on the worker thread
+		AccumulateTangents(in, indices.data(), first, last, sums[worker]);
+	});
+	TangentSpaceParallelFor(vertexCount, workerCount, [&](size_t first, size_t last, size_t) {
+		ResolveTangents(vertices, sums, first, last);
+	});
+}
@@ -0,0 +1,388 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <vector> // Include vector
+#include <deque> // Include deque
+#include <iostream> // Include iostream
+#include <cstring> // Include cstring for memcpy
+#include <functional> // Include function
+#include <memory> // Include shared_ptr
+#include <thread> // Include thread
+#include <mutex> // Include mutex
+#include <condition_variable> // Include condition_variable
+#include <chrono> // Include chrono for Flush polling
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <SOIL/SOIL.h> // Include SOIL
+
+#include "KtxFile.h" // Include baked (block-compressed) texture files
+#include "BumpMap.h" // Include height map -> normal/height conversion
+
+// Asynchronous texture loader used by the TextureManager.
+// Images are decoded by SOIL on a pool of worker threads (one per core). Once a face is decoded the GL thread
+// maps a pixel-unpack buffer for it and a worker copies (and, for cubemaps, flips) the pixels into it.
+// When every face of a texture has been filled, Update() unmaps the PBOs and issues glTexImage2D from them,
+// so the GL thread only does the final upload and mipmap generation. Until then the texture keeps the
+// 1x1 placeholder the TextureManager gave it, and rendering never waits on image decoding.
+// Images baked by bake_textures.cpp (image.jpg.ktx, see KtxFile.h) skip SOIL entirely: a worker reads the
+// compressed mip chain, it goes through the same PBO path and is uploaded with glCompressedTexImage2D.
+// Bump maps are decoded as single-channel heights and expanded to normal/height RGB (BumpMap.h) while a worker
+// fills the PBO.
+class TextureLoader
+{
+public:
+	TextureLoader() : stopping(false), pending(0) {}
+	~TextureLoader()
+	{
+		{
+			lock_guard<mutex> lock(this->taskMutex); // Stop workers
+			this->stopping = true;
+		}
+		this->taskReady.notify_all(); // Wake everyone up
+		for (size_t i = 0; i < this->workers.size(); i++)
+			this->workers[i].join(); // Wait for workers
+	}
+	TextureLoader(const TextureLoader&) = delete; // Owns threads, no copies
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	// Queues a texture for background loading. faces holds one path for GL_TEXTURE_2D or six for a cubemap
+	// (in GL face order). The texture must already exist (with a placeholder) on the GL side.
+	// bumpMap converts a height map (decoded with SOIL_LOAD_L) into the RGB normal/height layout of BumpMap.h.
+	void Submit(GLuint textureID, GLenum target, const vector<string>& faces, int soilFormat, bool flipRows, bool mipmaps, bool bumpMap = false)
+	{
+		this->startWorkers(); // Lazily spin up the pool
+		shared_ptr<Job> job = make_shared<Job>(); // New job
+		job->textureID = textureID;
+		job->target = target;
+		job->soilFormat = soilFormat;
+		job->channels = (soilFormat == SOIL_LOAD_L && !bumpMap) ? 1 : 3; // Bytes per uploaded pixel
+		job->bumpMap = bumpMap;
+		job->flipRows = flipRows;
+		job->mipmaps = mipmaps;
+		job->cancelled = false;
+		job->facesFilled = 0;
+		job->faces.resize(faces.size()); // One entry per face
+		for (size_t i = 0; i < faces.size(); i++)
+			job->faces[i].path = faces[i];
+		this->jobs.push_back(job); // Track on the GL thread
+		this->pending++;
+		bool baked = true; // Every face has an up to date .ktx
+		for (size_t i = 0; i < faces.size(); i++)
+			baked = baked && KtxFresh(faces[i]);
+		if (baked) // Read the compressed files (falls back to decoding if they do not fit)
+			this->enqueue([this, job]() { this->loadBaked(job); });
+		else
+			this->decodeAll(job);
+	}
+
+	// Drops any pending work for a texture that is about to be deleted
+	void Cancel(GLuint textureID)
+	{
+		for (size_t i = 0; i < this->jobs.size(); i++)
+			if (this->jobs[i]->textureID == textureID)
+				this->jobs[i]->cancelled = true; // Finished normally, but skips the upload
+	}
+
+	// Call once per frame on the GL thread: hands decoded faces their PBOs and uploads completed textures
+	void Update()
+	{
+		vector<Stage> decoded, filled; // Work finished since last frame
+		{
+			lock_guard<mutex> lock(this->resultMutex); // Take finished work
+			decoded.swap(this->decodedFaces);
+			filled.swap(this->filledFaces);
+		}
+
+		// Decoded faces: map a PBO on the GL thread and let a worker stream the pixels into it
+		for (size_t i = 0; i < decoded.size(); i++)
+		{
+			shared_ptr<Job> job = decoded[i].job; // Owning job
+			Face& face = job->faces[decoded[i].face]; // Decoded face
+			if ((face.pixels || !face.compressed.empty()) && !job->cancelled) {
+				GLsizeiptr bytes = face.compressed.empty() ? (GLsizeiptr)face.width * face.height * job->channels : (GLsizeiptr)face.compressed.size(); // Image size
+				glGenBuffers(1, &face.pbo); // Create PBO
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, face.pbo); // Bind as unpack buffer
+				glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW); // Allocate storage
+				face.mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT); // Map for writing
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // Unbind
+				if (!face.mapped) { // Mapping refused: drop the PBO so finish() uploads (and frees) the client copy
+					glDeleteBuffers(1, &face.pbo);
+					face.pbo = 0;
+				}
+			}
+			size_t faceIndex = decoded[i].face; // Face index
+			if (face.mapped) // Copy off the GL thread
+				this->enqueue([this, job, faceIndex]() { this->fillFace(job, faceIndex); });
+			else // Failed decode, cancelled, or mapping refused: go straight to upload (fallback or CPU source)
+				filled.push_back(decoded[i]);
+		}
+
+		// Filled faces: once every face of a texture is ready, upload it
+		for (size_t i = 0; i < filled.size(); i++)
+		{
+			shared_ptr<Job> job = filled[i].job; // Owning job
+			if (++job->facesFilled == job->faces.size()) // Last face
+				this->finish(job);
+		}
+	}
+
+	// Blocks until every submitted texture has been uploaded (benchmarks, headless runs)
+	void Flush()
+	{
+		while (this->pending > 0)
+		{
+			this->Update(); // Drive the pipeline
+			this_thread::sleep_for(chrono::milliseconds(1)); // Let workers run
+		}
+	}
+
+	// Number of textures still decoding or waiting for upload
+	size_t PendingCount() const
+	{
+		return this->pending;
+	}
+
+private:
+	struct Face {
+		string path; // Image file
+		unsigned char* pixels = nullptr; // SOIL decode output (worker owned until filled)
+		int width = 0, height = 0; // Decoded size
+		GLuint pbo = 0; // Pixel-unpack buffer
+		void* mapped = nullptr; // Mapped PBO storage (written by a worker)
+		vector<unsigned char> compressed; // Baked mip chain (worker owned until filled)
+		vector<KtxLevel> levels; // Mip sizes and offsets into compressed, empty when decoded by SOIL
+		GLenum internalFormat = 0; // Compressed format of the baked image
+	};
+	struct Job {
+		GLuint textureID; // Destination texture
+		GLenum target; // GL_TEXTURE_2D or GL_TEXTURE_CUBE_MAP
+		int soilFormat; // SOIL_LOAD_RGB / SOIL_LOAD_L
+		int channels; // Bytes per pixel
+		bool flipRows; // Cubemap faces need row 0 at the bottom
+		bool mipmaps; // Generate mip maps after upload
+		bool bumpMap; // Expand decoded heights to normal/height RGB
+		bool cancelled; // Texture was released while loading (GL thread only)
+		size_t facesFilled; // Faces ready for upload (GL thread only)
+		vector<Face> faces; // One per image
+	};
+	struct Stage {
+		shared_ptr<Job> job; // Owning job
+		size_t face; // Face index within the job
+	};
+
+	vector<thread> workers; // Decode pool
+	deque<function<void()> > tasks; // Work for the pool
+	mutex taskMutex; // Guards tasks/stopping
+	condition_variable taskReady; // Signals new tasks
+	bool stopping; // Pool shutting down
+
+	mutex resultMutex; // Guards the two result lists
+	vector<Stage> decodedFaces; // Decoded, waiting for a PBO
+	vector<Stage> filledFaces; // Copied into their PBO (or failed), waiting for upload
+
+	vector<shared_ptr<Job> > jobs; // In-flight jobs (GL thread only)
+	size_t pending; // Jobs not yet uploaded (GL thread only)
+
+	// Starts one worker per core the first time something is submitted
+	void startWorkers()
+	{
+		if (!this->workers.empty())
+			return;
+		unsigned count = thread::hardware_concurrency(); // Core count
+		if (count == 0)
+			count = 4; // Unknown: pick a sensible default
+		for (unsigned i = 0; i < count; i++)
+			this->workers.push_back(thread([this]() { this->workerLoop(); }));
+	}
+
+	// Adds a task for the pool
+	void enqueue(function<void()> task)
+	{
+		{
+			lock_guard<mutex> lock(this->taskMutex); // Guard queue
+			this->tasks.push_back(task);
+		}
+		this->taskReady.notify_one(); // Wake one worker
+	}
+
+	// Worker thread body: run tasks until shutdown
+	void workerLoop()
+	{
+		for (;;)
+		{
+			function<void()> task; // Next task
+			{
+				unique_lock<mutex> lock(this->taskMutex); // Wait for work
+				this->taskReady.wait(lock, [this]() { return this->stopping || !this->tasks.empty(); });
+				if (this->stopping && this->tasks.empty())
+					return;
+				task = this->tasks.front();
+				this->tasks.pop_front();
+			}
+			task(); // Run outside the lock
+		}
+	}
+
+	// Queues a SOIL decode of every face in parallel
+	void decodeAll(shared_ptr<Job> job)
+	{
+		for (size_t i = 0; i < job->faces.size(); i++)
+			this->enqueue([this, job, i]() { this->decodeFace(job, i); });
+	}
+
+	// Worker: reads the baked file of every face. They are only used if all of them load, the driver supports the
+	// format, the channel count, row order and bump layout match what the caller asked for, and (for cubemaps) the faces agree.
+	// Otherwise the job falls back to decoding the source images.
+	void loadBaked(shared_ptr<Job> job)
+	{
+		vector<KtxImage> images(job->faces.size()); // One per face
+		const char* wantedOrientation = job->flipRows ? KTX_ROWS_UP : KTX_ROWS_DOWN; // Row order the upload expects
+		bool usable = true; // All faces fit
+		for (size_t i = 0; i < images.size() && usable; i++)
+		{
+			KtxImage& image = images[i]; // Baked face
+			usable = ReadKtx(KtxPath(job->faces[i].path), image) && KtxFormatSupported(image.internalFormat) &&
+				(job->channels == 1 ? image.baseFormat == GL_RED : image.baseFormat != GL_RED && (!job->bumpMap || image.baseFormat != GL_RG)) &&
+				image.orientation == wantedOrientation && image.bumpLayout == job->bumpMap && // Raw heights are no bump map
+				(i == 0 || (image.internalFormat == images[0].internalFormat && image.levels.size() == images[0].levels.size() &&
+					image.levels[0].width == images[0].levels[0].width && image.levels[0].height == images[0].levels[0].height));
+		}
+		if (!usable) {
+			cerr << "Baked texture " << KtxPath(job->faces[0].path) << " cannot be used - decoding the source instead" << endl;
+			this->decodeAll(job);
+			return;
+		}
+		for (size_t i = 0; i < images.size(); i++)
+		{
+			Face& face = job->faces[i]; // Face to fill
+			face.width = images[i].levels[0].width;
+			face.height = images[i].levels[0].height;
+			face.internalFormat = images[i].internalFormat;
+			face.levels.swap(images[i].levels);
+			face.compressed.swap(images[i].data);
+		}
+		lock_guard<mutex> lock(this->resultMutex); // Publish result
+		for (size_t i = 0; i < images.size(); i++)
+			this->decodedFaces.push_back(Stage{ job, i });
+	}
+
+	// Worker: decode one face with SOIL
+	void decodeFace(shared_ptr<Job> job, size_t faceIndex)
+	{
+		Face& face = job->faces[faceIndex]; // Face to decode
+		face.pixels = SOIL_load_image(face.path.c_str(), &face.width, &face.height, 0, job->soilFormat); // Decode
+		if (!face.pixels)
+			cerr << "Failed to load texture " << face.path << " - keeping fallback" << endl;
+		lock_guard<mutex> lock(this->resultMutex); // Publish result
+		this->decodedFaces.push_back(Stage{ job, faceIndex });
+	}
+
+	// Worker: copy the decoded face into its mapped PBO, flipping rows when asked
+	void fillFace(shared_ptr<Job> job, size_t faceIndex)
+	{
+		Face& face = job->faces[faceIndex]; // Face to copy
+		unsigned char* dst = (unsigned char*)face.mapped; // Destination PBO memory
+		if (!face.compressed.empty()) { // Baked: blocks are already stored in upload order
+			memcpy(dst, face.compressed.data(), face.compressed.size());
+			vector<unsigned char>().swap(face.compressed); // Free the file copy
+			lock_guard<mutex> lock(this->resultMutex); // Publish result
+			this->filledFaces.push_back(Stage{ job, faceIndex });
+			return;
+		}
+		convertFace(*job, face, dst);
+		SOIL_free_image_data(face.pixels); // Decoded copy no longer needed
+		face.pixels = nullptr;
+		lock_guard<mutex> lock(this->resultMutex); // Publish result
+		this->filledFaces.push_back(Stage{ job, faceIndex });
+	}
+
+	// Writes a decoded face to dst in upload layout (channels bytes per pixel): bump maps expanded, rows flipped if asked
+	static void convertFace(const Job& job, const Face& face, unsigned char* dst)
+	{
+		size_t rowBytes = (size_t)face.width * job.channels; // Bytes per row
+		if (job.bumpMap) { // Heights in, normal/height RGB out
+			BuildBumpMap(face.pixels, face.width, face.height, dst);
+		} else if (job.flipRows) { // SOIL loads row 0 at top, OpenGL expects row 0 at bottom
+			for (int row = 0; row < face.height; row++)
+				memcpy(dst + row * rowBytes, face.pixels + (size_t)(face.height - 1 - row) * rowBytes, rowBytes);
+		} else {
+			memcpy(dst, face.pixels, rowBytes * face.height); // Straight copy
+		}
+	}
+
+	// GL thread: uploads every mip level of a baked face, from the bound PBO (data == nullptr) or from client memory
+	void uploadCompressed(GLenum faceTarget, const Face& face, const unsigned char* data)
+	{
+		for (size_t level = 0; level < face.levels.size(); level++)
+		{
+			const KtxLevel& entry = face.levels[level]; // Level to upload
+			const GLvoid* source = data ? (const GLvoid*)(data + entry.offset) : (const GLvoid*)(uintptr_t)entry.offset; // Pointer or PBO offset
+			glCompressedTexImage2D(faceTarget, (GLint)level, face.internalFormat, entry.width, entry.height, 0, entry.size, source);
+		}
+	}
+
+	// GL thread: uploads every face of a completed job and retires it
+	void finish(shared_ptr<Job> job)
+	{
+		GLenum binding = job->target; // Bind point
+		if (!job->cancelled)
+			glBindTexture(binding, job->textureID); // Bind destination
+		GLenum format = (job->channels == 1) ? GL_RED : GL_RGB; // Pixel format
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // Rows of RGB/R8 images are not 4-byte aligned
+		bool anyLoaded = false; // Keep the placeholder if every face failed
+		bool baked = job->faces[0].internalFormat != 0; // Compressed mip chain instead of a decoded image
+		for (size_t i = 0; i < job->faces.size(); i++)
+			anyLoaded = anyLoaded || job->faces[i].pbo || job->faces[i].pixels || !job->faces[i].compressed.empty();
+		for (size_t i = 0; i < job->faces.size(); i++)
+		{
+			Face& face = job->faces[i]; // Face to upload
+			GLenum faceTarget = (binding == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + (GLenum)i : binding; // Image target
+			if (face.pbo) {
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, face.pbo); // Source from the PBO
+				glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER); // Hand the pixels to the driver
+				if (!job->cancelled && baked)
+					this->uploadCompressed(faceTarget, face, nullptr); // Every level from the PBO
+				else if (!job->cancelled)
+					glTexImage2D(faceTarget, 0, format, face.width, face.height, 0, format, GL_UNSIGNED_BYTE, (const GLvoid*)0); // Upload from PBO offset 0
+				glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0); // Unbind
+				glDeleteBuffers(1, &face.pbo); // Storage is freed once the copy retires
+				face.pbo = 0;
+			} else if (face.pixels) { // Mapping failed: upload from client memory instead
+				vector<unsigned char> converted; // Same layout fillFace would have written to the PBO
+				if (!job->cancelled) {
+					converted.resize((size_t)face.width * face.height * job->channels);
+					convertFace(*job, face, converted.data());
+					glTexImage2D(faceTarget, 0, format, face.width, face.height, 0, format, GL_UNSIGNED_BYTE, converted.data());
+				}
+				SOIL_free_image_data(face.pixels);
+				face.pixels = nullptr;
+			} else if (!face.compressed.empty()) { // Baked, mapping failed: upload from client memory
+				if (!job->cancelled)
+					this->uploadCompressed(faceTarget, face, face.compressed.data());
+				vector<unsigned char>().swap(face.compressed);
+			} else if (anyLoaded && binding == GL_TEXTURE_CUBE_MAP && !job->cancelled) {
+				// Missing cubemap face while others loaded: give it a solid face so the cubemap stays complete
+				unsigned char grayPixel[3] = { 100, 100, 100 };
+				glTexImage2D(faceTarget, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grayPixel);
+			}
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // Restore default
+		if (!job->cancelled) {
+			if (baked) // Mip chain came with the file
+				glTexParameteri(binding, GL_TEXTURE_MAX_LEVEL, (GLint)job->faces[0].levels.size() - 1);
+			else if (job->mipmaps && anyLoaded)
+				glGenerateMipmap(binding); // Mip chain for the real image
+			glBindTexture(binding, 0); // Unbind
+			cout << "Uploaded texture " << job->faces[0].path << (job->faces.size() > 1 ? " (+ faces)" : "")
+				<< (baked ? string(" (baked ") + KtxFormatName(job->faces[0].internalFormat) + ")" : string()) << endl;
+		}
+
+		for (size_t i = 0; i < this->jobs.size(); i++) // Retire job
+			if (this->jobs[i] == job) {
+				this->jobs.erase(this->jobs.begin() + i);
+				break;
+			}
+		this->pending--;
+	}
+};
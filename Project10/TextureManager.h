@@ -0,0 +1,205 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <vector> // Include vector
+#include <iostream> // Include iostream
+#include <unordered_map> // Include unordered_map
+#include <climits> // PATH_MAX
+#include <cstdlib> // realpath
+using namespace std; // Use namespace std
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+#include <SOIL/SOIL.h> // Include SOIL
+
+#include "TextureLoader.h" // Include async decode pipeline
+
+// Shared texture cache used by Model, main.cpp and the cubemap loader.
+// Textures are keyed by canonical path + SOIL load format, so the same image requested twice (two meshes
+// sharing a diffuse map, or a model and main.cpp using the same file) is decoded and uploaded only once.
+// Handles are reference counted: every Acquire must be paired with a Release, the GL texture is deleted
+// when the last user releases it.
+class TextureManager
+{
+public:
+	// Process-wide instance (textures are shared across every Model in the program)
+	static TextureManager& Instance()
+	{
+		static TextureManager instance; // Created on first use
+		return instance;
+	}
+
+	// Returns a 2D texture for path loaded with the given SOIL format (SOIL_LOAD_RGB or SOIL_LOAD_L).
+	// The handle is usable immediately: it holds a 1x1 placeholder (white for RGB, mid gray for height maps)
+	// until the TextureLoader has decoded the image on a worker thread and Update() uploaded it.
+	// Missing files simply keep the placeholder, so samplers stay valid.
+	GLuint Acquire2D(const string& path, int soilFormat)
+	{
+		string key = CanonicalPath(path) + "|" + to_string(soilFormat); // Cache key
+		if (GLuint id = this->addRef(key)) // Already loaded (or loading)
+			return id;
+
+		GLuint textureID; // New texture
+		glGenTextures(1, &textureID); // Gen texture
+		glBindTexture(GL_TEXTURE_2D, textureID); // Bind texture
+		GLenum format = (soilFormat == SOIL_LOAD_L) ? GL_RED : GL_RGB; // Single channel for height maps
+		unsigned char placeholder[3] = { 255, 255, 255 }; // White diffuse
+		if (format == GL_RED)
+			placeholder[0] = 128; // Flat height (0.5)
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // 1x1 upload
+		glTexImage2D(GL_TEXTURE_2D, 0, format, 1, 1, 0, format, GL_UNSIGNED_BYTE, placeholder); // Placeholder
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // Restore default
+
+		// Parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Set texture wrap s
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // Set texture wrap t
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // Set min filter
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Set mag filter
+		glBindTexture(GL_TEXTURE_2D, 0); // Unbind texture
+
+		this->insert(key, textureID); // Remember it
+		this->loader.Submit(textureID, GL_TEXTURE_2D, vector<string>(1, path), soilFormat, false, true); // Decode in background
+		return textureID;
+	}
+
+	// Returns a bump map built from a height map: tangent-space normal X/Y in red/green and the height in blue
+	// (see BumpMap.h), so shaders get the normal and the height from one fetch. A baked .ktx is used if it is
+	// fresh and has at least three channels. Until the map is ready it holds a flat normal at mid height.
+	GLuint AcquireBumpMap(const string& path)
+	{
+		string key = CanonicalPath(path) + "|bump"; // Cache key
+		if (GLuint id = this->addRef(key)) // Already loaded (or loading)
+			return id;
+
+		GLuint textureID; // New texture
+		glGenTextures(1, &textureID); // Gen texture
+		glBindTexture(GL_TEXTURE_2D, textureID); // Bind texture
+		unsigned char placeholder[3] = { 128, 128, 128 }; // Normal (0, 0, 1), height 0.5
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // 1x1 upload
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, placeholder); // Placeholder
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // Restore default
+
+		// Parameters
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT); // Set texture wrap s
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT); // Set texture wrap t
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR); // Set min filter
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Set mag filter
+		glBindTexture(GL_TEXTURE_2D, 0); // Unbind texture
+
+		this->insert(key, textureID); // Remember it
+		this->loader.Submit(textureID, GL_TEXTURE_2D, vector<string>(1, path), SOIL_LOAD_L, false, true, true); // Decode and convert in background
+		return textureID;
+	}
+
+	// Returns a cubemap built from six faces in GL order (+X, -X, +Y, -Y, +Z, -Z).
+	// Faces are decoded in parallel and flipped vertically on load: SOIL puts row 0 at the top, OpenGL expects
+	// it at the bottom. Until all six are ready the cubemap is a solid gray 1x1 placeholder.
+	GLuint AcquireCubemap(const vector<string>& faces)
+	{
+		string key = "cubemap"; // Cache key built from every face
+		for (size_t i = 0; i < faces.size(); i++)
+			key += "|" + CanonicalPath(faces[i]);
+		if (GLuint id = this->addRef(key)) // Already loaded (or loading)
+			return id;
+
+		GLuint textureID; // New cubemap
+		glGenTextures(1, &textureID); // Generate cubemap texture
+		glBindTexture(GL_TEXTURE_CUBE_MAP, textureID); // Bind as cubemap
+		unsigned char grayPixel[3] = { 100, 100, 100 }; // Placeholder color
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1); // 1x1 upload
+		for (GLuint i = 0; i < 6; i++)
+			glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grayPixel);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4); // Restore default
+		// Set cubemap texture parameters
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // Linear filtering
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Linear filtering
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // Clamp edges to avoid seams
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); // Clamp edges to avoid seams
+		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE); // Clamp edges to avoid seams (3rd axis for cubemaps)
+		glBindTexture(GL_TEXTURE_CUBE_MAP, 0); // Unbind cubemap
+
+		this->insert(key, textureID); // Remember it
+		this->loader.Submit(textureID, GL_TEXTURE_CUBE_MAP, faces, SOIL_LOAD_RGB, true, false); // Decode faces in background
+		return textureID;
+	}
+
+	// Uploads textures whose decode finished since the last call. Call once per frame on the GL thread.
+	void Update()
+	{
+		this->loader.Update(); // Drive the async pipeline
+	}
+
+	// Blocks until every requested texture is uploaded (benchmarks and headless runs)
+	void Flush()
+	{
+		this->loader.Flush(); // Wait for the async pipeline
+	}
+
+	// Number of textures still decoding or waiting for upload
+	size_t PendingCount() const
+	{
+		return this->loader.PendingCount();
+	}
+
+	// Drops one reference to a texture returned by Acquire*, deleting it when nobody uses it anymore
+	void Release(GLuint textureID)
+	{
+		unordered_map<GLuint, string>::iterator byId = this->keysById.find(textureID); // Find key for handle
+		if (byId == this->keysById.end()) // Not managed (or already deleted)
+			return;
+		Entry& entry = this->entries[byId->second]; // Entry for key
+		if (--entry.refCount > 0) // Still in use
+			return;
+		this->loader.Cancel(entry.id); // Skip any upload still in flight
+		glDeleteTextures(1, &entry.id); // Last user gone
+		this->entries.erase(byId->second);
+		this->keysById.erase(byId);
+	}
+
+	// Number of distinct GL textures currently alive
+	size_t LoadedCount() const
+	{
+		return this->entries.size();
+	}
+
+	// Canonical form of a path so "./a.jpg", "a.jpg" and "dir/../a.jpg" share one entry
+	static string CanonicalPath(const string& path)
+	{
+		char resolved[PATH_MAX]; // realpath output
+		if (realpath(path.c_str(), resolved)) // Only works for existing files
+			return string(resolved);
+		return path; // Missing file: fall back to the path as given
+	}
+
+private:
+	struct Entry {
+		GLuint id; // GL handle
+		int refCount; // Outstanding Acquire calls
+	};
+	unordered_map<string, Entry> entries; // Key -> texture
+	unordered_map<GLuint, string> keysById; // Handle -> key, for Release
+	TextureLoader loader; // Background decode + PBO upload pipeline
+
+	TextureManager() {}
+	TextureManager(const TextureManager&) = delete; // Singleton
+	TextureManager& operator=(const TextureManager&) = delete;
+
+	// Bumps the reference count of key and returns its handle, 0 when not loaded yet
+	GLuint addRef(const string& key)
+	{
+		unordered_map<string, Entry>::iterator it = this->entries.find(key); // Look up key
+		if (it == this->entries.end())
+			return 0;
+		it->second.refCount++; // One more user
+		return it->second.id;
+	}
+
+	// Registers a freshly created texture with one reference
+	void insert(const string& key, GLuint textureID)
+	{
+		Entry entry; // New entry
+		entry.id = textureID;
+		entry.refCount = 1;
+		this->entries[key] = entry;
+		this->keysById[textureID] = key;
+	}
+};
@@ -0,0 +1,73 @@
+// Startup benchmark for the binary mesh cache (MeshCache.h).
+// For every model it deletes the cache, times a cold load (Assimp + tangents + cache write),
+// then times a warm load (mapped cache straight into glBufferData) and prints both.
+//
+// Build: g++ -o bench_mesh_cache bench_mesh_cache.cpp -lGL -lGLEW -lglfw -lSOIL -lassimp -pthread
+// Run:   ./bench_mesh_cache [model.obj ...]   (defaults to cylinder.obj and sphere.obj)
+
+#include <iostream> // iostream include
+#include <chrono> // Timing
+#include <vector> // Include vector
+#include <string> // Include string
+#include <cstdio> // remove
+
+// GLEW
+#define GLEW_STATIC // Define glew_static
+#include <GL/glew.h> // glew include
+
+// GLFW
+#include <GLFW/glfw3.h> // glfw include
+
+// Other includes
+#include "shader.h" // Include shader class (used by Mesh::Draw)
+#include "Model.h" // Include Model class
+
+// Loads path once and returns the elapsed milliseconds, including a glFinish so uploads are counted
+double timeModelLoad(const string& path)
+{
+    auto start = chrono::high_resolution_clock::now(); // Start timer
+    {
+        Model model(path.c_str()); // Load through the normal Model path (cache on)
+        TextureManager::Instance().Flush(); // Wait for background texture decodes
+        glFinish(); // Wait for buffer uploads
+    }
+    auto end = chrono::high_resolution_clock::now(); // Stop timer
+    return chrono::duration<double, milli>(end - start).count(); // Elapsed ms
+}
+
+int main(int argc, char** argv) {
+    // Init GLFW with a hidden window, we only need a context for glBufferData
+    glfwInit(); // Initialize GLFW
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3); // Set major context version
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3); // Set minor context version
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE); // Set profiles
+    glfwWindowHint(GLFW_VISIBLE, GL_FALSE); // No visible window
+    GLFWwindow* window = glfwCreateWindow(64, 64, "Mesh cache benchmark", nullptr, nullptr); // Create window
+    if (!window) {
+        cerr << "Failed to create GL context" << endl;
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window); // Make context current
+    glewExperimental = GL_TRUE; // Set glew to experimental
+    glewInit(); // Initialize GLEW
+
+    vector<string> paths; // Models to benchmark
+    for (int i = 1; i < argc; i++)
+        paths.push_back(argv[i]);
+    if (paths.empty()) { // Default to the Project10 scene models
+        paths.push_back("cylinder.obj");
+        paths.push_back("sphere.obj");
+    }
+
+    cout << "model, cold_ms, warm_ms, speedup" << endl; // CSV header
+    for (size_t i = 0; i < paths.size(); i++) {
+        remove(MeshCachePath(paths[i]).c_str()); // Force a cold load
+        double cold = timeModelLoad(paths[i]); // Assimp path, writes the cache
+        double warm = timeModelLoad(paths[i]); // Cache path
+        cout << paths[i] << ", " << cold << ", " << warm << ", " << (warm > 0.0 ? cold / warm : 0.0) << "x" << endl;
+    }
+
+    glfwTerminate(); // Terminate window
+    return 0;
+}
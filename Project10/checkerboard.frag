@@ -3,11 +3,15 @@ out vec4 FragColor; // Returns frag color
 
 in vec3 Normal; // Takes in normal vec
 in vec3 FragPos; // Takes in fragpos vec
+flat in vec3 SquareColor; // Takes in tile color
 
-uniform vec3 lightPos; // Uniform loc for lightPos vec3
-uniform vec3 viewPos; // Uniform loc for viewPos vec3
-uniform vec3 lightColor; // Uniform loc for lightColor vec3
-uniform vec3 squareColor; // Uniform loc for squareColor vec3
+layout (std140) uniform FrameData { // Shared per-frame block (FrameUniforms in shader.h)
+    mat4 view; // View matrix
+    mat4 projection; // Projection matrix
+    vec3 viewPos; // Camera position
+    vec3 lightPos; // Light position
+    vec3 lightColor; // Light color
+};
 
 void main() {
     // ambient
@@ -27,6 +31,6 @@ void main() {
     float spec = pow(max(dot(viewDir, reflectDir), 0.0), 8); // Gets spec with dot product
     vec3 specular = specularStrength * spec * lightColor; // Sets specular
 
-    vec3 result = (ambient + diffuse + specular) * squareColor; // Calculates result
+    vec3 result = (ambient + diffuse + specular) * SquareColor; // Calculates result
     FragColor = vec4(result, 1.0f); // Sets fragcolor output
 }
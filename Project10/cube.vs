@@ -3,10 +3,16 @@ layout (location = 0) in vec3 aPos;
 
 out vec3 TexCoords; // Cubemap direction vector (vertex position)
 out vec3 FragPos;   // World space position
+invariant gl_Position; // Same depth in the pre-pass program (depth.frag) and the shading pass, for GL_EQUAL
 
 uniform mat4 model;      // Model matrix
-uniform mat4 view;       // View matrix
-uniform mat4 projection; // Projection matrix
+layout (std140) uniform FrameData { // Shared per-frame block (FrameUniforms in shader.h)
+    mat4 view; // View matrix
+    mat4 projection; // Projection matrix
+    vec3 viewPos; // Camera position
+    vec3 lightPos; // Light position
+    vec3 lightColor; // Light color
+};
 
 void main() {
     gl_Position = projection * view * model * vec4(aPos, 1.0f);
@@ -5,26 +5,21 @@ in vec3 FragPos; // Receives FragPos
 in vec2 TexCoord; // Receives texture coordinate
 in mat3 TBN; // Receives TBN matrix
   
-uniform vec3 lightPos; // Receives lightPos uniform
-uniform vec3 viewPos; // Receives viewPos uniform
-uniform vec3 lightColor; // Receives lightColor uniform
+layout (std140) uniform FrameData { // Shared per-frame block (FrameUniforms in shader.h)
+    mat4 view; // View matrix
+    mat4 projection; // Projection matrix
+    vec3 viewPos; // Camera position
+    vec3 lightPos; // Light position
+    vec3 lightColor; // Light color
+};
 uniform sampler2D diffuseTexture; // Receives diffuse texture sampler
-uniform sampler2D heightMap; // Receives height map sampler
+uniform sampler2D bumpMap; // Receives bump map sampler: normal X/Y in rg, height in b (BumpMap.h)
 uniform vec2 uvScale; // UV tiling amount for texture repeat
 
-vec3 BumpNormalFromHeight(vec2 texCoords)
+vec3 BumpNormal(vec4 bump)
 {
-    vec2 texel = 1.0 / vec2(textureSize(heightMap, 0)); // Texture-space step
-    float hL = texture(heightMap, texCoords - vec2(texel.x, 0.0)).r; // Left sample
-    float hR = texture(heightMap, texCoords + vec2(texel.x, 0.0)).r; // Right sample
-    float hD = texture(heightMap, texCoords - vec2(0.0, texel.y)).r; // Down sample
-    float hU = texture(heightMap, texCoords + vec2(0.0, texel.y)).r; // Up sample
-
-    float bumpScale = 5.0; // Stronger bump intensity (more obvious relief)
-    float dHdU = (hR - hL) * bumpScale; // Height derivative along U
-    float dHdV = (hU - hD) * bumpScale; // Height derivative along V
-
-    return normalize(vec3(-dHdU, -dHdV, 1.0)); // Tangent-space bumped normal
+    vec2 xy = bump.rg * 2.0 - 1.0; // Precomputed normal X/Y (Sobel of the height map, bump scale 5)
+    return vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))); // Tangent-space bumped normal, Z rebuilt
 }
 
 void main()
@@ -36,15 +31,15 @@ void main()
     vec3 tangentLightPos = TBN * lightPos; // Tangent-space light position
     vec3 tangentViewPos = TBN * viewPos; // Tangent-space view position
 
-    // Build bumped normal from the height map (bump mapping)
-    vec3 tangentNormal = BumpNormalFromHeight(tiledTexCoord); // Perturbed tangent-space normal
+    // One fetch gives the bumped normal and the height
+    vec4 bump = texture(bumpMap, tiledTexCoord); // Sample bump map
+    vec3 tangentNormal = BumpNormal(bump); // Perturbed tangent-space normal
 
     vec3 lightDir = normalize(tangentLightPos - tangentFragPos); // Tangent-space light direction
     vec3 viewDir = normalize(tangentViewPos - tangentFragPos); // Tangent-space view direction
 
-    // Sample height map and convert to grayscale luminance
-    vec3 mapSample = texture(heightMap, tiledTexCoord).rgb; // Sample texture
-    float luminance = dot(mapSample, vec3(0.299, 0.587, 0.114)); // Calculate luminance
+    // Grayscale luminance of the height (the old single-channel height map only had red, so only red's weight applies)
+    float luminance = bump.b * 0.299; // Calculate luminance
 
     // ambient
     float ambientStrength = 2.0; // Set ambient strength
@@ -1,30 +1,55 @@
 #version 330 core
 layout (location = 0) in vec3 aPos; // Receives aPos
-layout (location = 1) in vec3 aNormal; // Receives aNormal
+layout (location = 1) in vec3 aNormal; // Receives aNormal (packed: octahedral xy)
 layout (location = 2) in vec2 aTexCoord; // Receives aTexCoord
-layout (location = 3) in vec3 aTangent; // Receives aTangent
+layout (location = 3) in vec4 aTangent; // Receives aTangent (packed: octahedral xy, handedness in w)
 layout (location = 4) in vec3 aBitangent; // Receives aBitangent
 
 out vec3 FragPos; // Returns FragPos
 out vec3 Normal; // Returns Normal
 out vec2 TexCoord; // Returns TexCoord
 out mat3 TBN; // Returns TBN matrix
+invariant gl_Position; // Same depth in the pre-pass program (depth.frag) and the shading pass, for GL_EQUAL
 
 uniform mat4 model; // Receives model uniform
-uniform mat4 view; // Receives view uniform
-uniform mat4 projection; // Receives projection uniform
+uniform bool packedVertices; // Mesh uploaded as PackedVertex (set by Mesh::Draw)
+layout (std140) uniform FrameData { // Shared per-frame block (FrameUniforms in shader.h)
+    mat4 view; // View matrix
+    mat4 projection; // Projection matrix
+    vec3 viewPos; // Camera position
+    vec3 lightPos; // Light position
+    vec3 lightColor; // Light color
+};
+
+// Rebuilds a unit vector from its octahedral encoding (see OctahedralEncode in Mesh.h)
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y)); // Unfold onto the octahedron
+    float t = max(-n.z, 0.0); // Lower hemisphere overlap
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t); // Fold back
+    return normalize(n);
+}
 
 void main()
 {
+    vec3 normal = aNormal; // Object-space normal
+    vec3 tangent = aTangent.xyz; // Object-space tangent
+    vec3 bitangent = aBitangent; // Object-space bitangent
+    if (packedVertices) { // Decode the compact layout
+        normal = OctahedralDecode(aNormal.xy); // Unpack normal
+        tangent = OctahedralDecode(aTangent.xy); // Unpack tangent
+        bitangent = cross(normal, tangent) * (aTangent.w < 0.0 ? -1.0 : 1.0); // Rebuild bitangent from handedness
+    }
+
     gl_Position = projection * view * model * vec4(aPos, 1.0f); // Implements transformations
     FragPos = vec3(model * vec4(aPos, 1.0)); // Sets fragment position
     mat3 normalMatrix = transpose(inverse(mat3(model))); // Normal matrix for non-uniform scale
-    Normal = normalMatrix * aNormal; // Transform normal to world space
+    Normal = normalMatrix * normal; // Transform normal to world space
     TexCoord = aTexCoord; // Set texture coordinate
     
     // Transform tangent and bitangent to world space
-    vec3 T = normalize(normalMatrix * aTangent); // Transform tangent
-    vec3 Binput = normalize(normalMatrix * aBitangent); // Transform provided bitangent
+    vec3 T = normalize(normalMatrix * tangent); // Transform tangent
+    vec3 Binput = normalize(normalMatrix * bitangent); // Transform provided bitangent
     vec3 N = normalize(Normal); // Normalize transformed normal
     T = normalize(T - dot(T, N) * N); // Gram-Schmidt to keep T orthogonal to N
     float handedness = (dot(cross(N, T), Binput) < 0.0) ? -1.0 : 1.0; // Preserve handedness
@@ -0,0 +1,6 @@
+#version 330 core
+// Depth pre-pass: linked with each object's own vertex shader, so the depth matches the shading pass exactly.
+// Color writes are off while it draws; the fragment only has to exist for its depth to be written.
+
+void main() {
+}
@@ -1,5 +1,6 @@
 #include <iostream>  // iostream include
-#include <cstring>   // For std::memcpy
+#include <cstdio> // sscanf include
+#include <cstdlib> // atoi include
 
 // GLEW
 #define GLEW_STATIC // Define glew_static
@@ -17,27 +18,76 @@
 #include <glm/gtc/type_ptr.hpp> // glm gtc include
 
 // Other includes
-#include "shader.h" // Include shader class
 #include "Camera.h" // Include Camera class
-#include "Model.h" // Include Model class
+#include "Scene.h" // Include the scene (shaders, models, textures, Render)
+#include "Headless.h" // Include offscreen benchmark mode
+#include "DynamicResolution.h" // Include the scaled render target
 
 const GLuint WIDTH = 800, HEIGHT = 600; // Global variables for width and height of window
 
 // Function prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode); // key_callback method
-void do_movement(); // Movement method
+GLuint camera_keys(); // Camera_Key state from the held keys
 
 Camera camera(glm::vec3(0.0f, 0.0f, 0.0f)); // Sets iniital camera pos (0, 0, 0)
 GLfloat lastX = WIDTH / 2.0; // Used for camera motion
 GLfloat lastY = HEIGHT / 2.0; // Used for camera motion
 bool keys[1024]; // Allowable number of key strokes
 
-glm::vec3 lightPos(1.0f, 1.0f, -2.0f); // Sets light position
-
-GLfloat deltaTime = 0.0f; // Initialize deltaTime for camera movement
+GLfloat deltaTime = 0.0f; // Time since the last frame (the camera simulation consumes it in fixed ticks)
 GLfloat lastFrame = 0.0f; // Initialize lastFrame for camera movement
 
-int main() {
+bool toggleProfiler = false; // P pressed: show/hide the profiler overlay
+bool writeTrace = false; // T pressed: write the Chrome trace
+bool toggleParallax = false; // O pressed: switch between parallax occlusion and single-step parallax
+bool togglePrepass = false; // Z pressed: depth pre-pass on/off
+
+// Usage: ./run [--headless [--frames N] [--warmup N] [--size WxH] [--json path] [--csv path] [--trace path] [--parallax pom|offset] [--depth-prepass on|off]] [--dynamic-resolution on|off] [--resolution-scale MIN:MAX] [--target-ms N] [--record path] [--replay path]
+int main(int argc, char** argv) {
+    // Headless benchmark instead of a window (see Headless.h)
+    bool headless = false; // Run the benchmark
+    HeadlessOptions options; // Benchmark settings (the dynamic resolution ones apply to the window too)
+    bool dynamicResolution = false; // Off by default (window and benchmark): full size, straight into the framebuffer
+    string recordPath; // Camera input log to write on exit
+    for (int i = 1; i < argc; i++) { // Parse flags
+        string arg = argv[i]; // Current flag
+        bool hasValue = i + 1 < argc; // Flag is followed by a value
+        if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--frames" && hasValue) {
+            options.Frames = atoi(argv[++i]); // Recorded frames
+        } else if (arg == "--warmup" && hasValue) {
+            options.WarmupFrames = atoi(argv[++i]); // Unrecorded frames
+        } else if (arg == "--size" && hasValue) {
+            sscanf(argv[++i], "%ux%u", &options.Width, &options.Height); // FBO size
+        } else if (arg == "--json" && hasValue) {
+            options.JsonPath = argv[++i]; // JSON output ("" to skip)
+        } else if (arg == "--csv" && hasValue) {
+            options.CsvPath = argv[++i]; // CSV output ("" to skip)
+        } else if (arg == "--trace" && hasValue) {
+            options.TracePath = argv[++i]; // Chrome trace of the profiled passes
+        } else if (arg == "--parallax" && hasValue && (string(argv[i + 1]) == "pom" || string(argv[i + 1]) == "offset")) {
+            options.ParallaxOcclusion = string(argv[++i]) == "pom"; // Sphere parallax mode
+        } else if (arg == "--depth-prepass" && hasValue && (string(argv[i + 1]) == "on" || string(argv[i + 1]) == "off")) {
+            options.DepthPrepass = string(argv[++i]) == "on"; // Depth-only pass before shading
+        } else if (arg == "--dynamic-resolution" && hasValue && (string(argv[i + 1]) == "on" || string(argv[i + 1]) == "off")) {
+            dynamicResolution = options.DynamicScale = string(argv[++i]) == "on"; // Scale the render target from the GPU time
+        } else if (arg == "--resolution-scale" && hasValue) {
+            sscanf(argv[++i], "%f:%f", &options.MinScale, &options.MaxScale); // Scale bounds
+        } else if (arg == "--target-ms" && hasValue) {
+            options.TargetMs = (float)atof(argv[++i]); // GPU budget per frame
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i]; // Camera input log of this session
+        } else if (arg == "--replay" && hasValue) {
+            options.ReplayPath = argv[++i]; // Camera input log to fly instead of the keys (or of the benchmark orbit)
+        } else {
+            cout << "Usage: " << argv[0] << " [--headless [--frames N] [--warmup N] [--size WxH] [--json path] [--csv path] [--trace path] [--parallax pom|offset] [--depth-prepass on|off]] [--dynamic-resolution on|off] [--resolution-scale MIN:MAX] [--target-ms N] [--record path] [--replay path]" << endl;
+            return 1;
+        }
+    }
+    if (headless)
+        return RunHeadless(options); // Render the camera path offscreen and write the timings
+
     // Init GLFW
     glfwInit(); // Initialize GLFW
     // Set all the required options for GLFW
@@ -57,352 +107,79 @@ int main() {
 
     glewInit(); // Initialize GLEW
 
-    glViewport(0, 0, WIDTH, HEIGHT); // Define viewport dimensions
-
-    glEnable(GL_DEPTH_TEST); // Set up OpenGL options
-
-    // INSERT SHADERS HERE FOR PROJECT 10
-    Shader checkerboardShader("checkerboard.vs", "checkerboard.frag"); // Create shader for checkerboard
-    Shader cubeShader("cube.vs", "cube.frag"); // Create shader for cube object
-    Shader cylinderShader("cylinder.vs", "cylinder.frag"); // Create shader for cylinder object
-    Shader sphereShader("sphere.vs", "sphere.frag"); // Create shader for sphere object
-
-    // Models for Cylinder and Sphere
-    Model cylinderModel("cylinder.obj"); // Defines model for cylinder using obj
-    Model sphereModel("sphere.obj"); // Define model for sphere using obj
-
-    GLfloat vertices[] = {
-        // Coordinates: 3 Position, 3 Color, 2 TexCoord, 3 Tangent, 3 Bitangent
-        // Back face of cube (normal: 0, 0, -1)
-        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
-        0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom right
-        0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
-        0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
-        -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper left
-        -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
-
-        // Front face of cube (normal: 0, 0, 1)
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
-        0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom right
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
-        0.5f, 0.5f, 0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper right
-        -0.5f, 0.5f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper left
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Bottom left
-
-        // Left face (normal: -1, 0, 0)
-        -0.5f, 0.5f, 0.5f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
-        -0.5f, 0.5f, -0.5f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper far
-        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
-        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower close
-        -0.5f, 0.5f, 0.5f, 1.0f, 0.0f, -1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
-
-        // Right face (normal: 1, 0, 0)
-        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
-        0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper far
-        0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
-        0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower far
-        0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Lower close
-        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, // Upper close
-
-        // Bottom face (normal: 0, -1, 0)
-        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, // Left far
-        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, // Right far
-        0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, // Right close
-        0.5f, -0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, // Right close
-        -0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, // Left close
-        -0.5f, -0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, -1.0f, // Left far
-
-        // Top Face (normal: 0, 1, 0)
-        -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // Left far
-        0.5f, 0.5f, -0.5f, 1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, // Right far
-        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Right close
-        0.5f, 0.5f, 0.5f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Right close
-        -0.5f, 0.5f, 0.5f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, // Left close
-        -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f // Left far
-    };
-    GLuint VBO, VAO; // Initialize VBO, VAO
-    glGenVertexArrays(1, &VAO); // Generate VAO
-    glGenBuffers(1, &VBO); // Generate VBO
-
-    glBindVertexArray(VAO);  // Bind VAO
-
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);  // Bind VBO
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);  // Buffer Data
-
-    // Position attribute (location 0)
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)0);
-    glEnableVertexAttribArray(0);
-    
-    // Color attribute (location 1) - not used but kept for vertex data structure
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    
-    // TexCoord attribute (location 2)
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(6 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(2);
-    
-    // Tangent attribute (location 3)
-    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(8 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(3);
-    
-    // Bitangent attribute (location 4)
-    glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, 14 * sizeof(GLfloat), (GLvoid*)(11 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(4);
-
-    glBindVertexArray(0); // Unbind VAO
-
-    // LOAD TEXTURES FOR PARALLAX MAPPING
-    GLuint diffuseTexture, heightMap;
-    
-    // Load diffuse texture (Bump-Picture.jpg)
-    glGenTextures(1, &diffuseTexture);
-    glBindTexture(GL_TEXTURE_2D, diffuseTexture);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    int width, height;
-    unsigned char* image = SOIL_load_image("Bump-Picture.jpg", &width, &height, 0, SOIL_LOAD_RGB);
-    if (image) {
-        std::cout << "Successfully loaded Bump-Picture.jpg (" << width << "x" << height << ")" << std::endl;
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        SOIL_free_image_data(image);
-    } else {
-        std::cerr << "Failed to load Bump-Picture.jpg - texture will be white" << std::endl;
-        // Create a white default texture
-        unsigned char whitePixel[3] = {255, 255, 255};
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, whitePixel);
-    }
-    
-    // Load height map (Bump-Map.jpg)
-    glGenTextures(1, &heightMap);
-    glBindTexture(GL_TEXTURE_2D, heightMap);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    
-    image = SOIL_load_image("Bump-Map.jpg", &width, &height, 0, SOIL_LOAD_L);
-    if (image) {
-        std::cout << "Successfully loaded Bump-Map.jpg (" << width << "x" << height << ")" << std::endl;
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, width, height, 0, GL_RED, GL_UNSIGNED_BYTE, image);
-        glGenerateMipmap(GL_TEXTURE_2D);
-        SOIL_free_image_data(image);
-    } else {
-        std::cerr << "Failed to load Bump-Map.jpg - texture will be flat (no parallax)" << std::endl;
-        // Create a flat gray height map (0.5 height everywhere)
-        unsigned char grayPixel[1] = {128};
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RED, 1, 1, 0, GL_RED, GL_UNSIGNED_BYTE, grayPixel);
-    }
-
-    // LOAD CUBEMAP TEXTURE for skybox (6 face images)
-    GLuint cubemapTexture;
-    glGenTextures(1, &cubemapTexture); // Generate cubemap texture
-    glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture); // Bind as cubemap
-
-    // Face filenames in OpenGL cubemap order (posy and negy swapped to correct vertical orientation)
-    const char* cubemapFaces[6] = {
-        "posx.jpg", // GL_TEXTURE_CUBE_MAP_POSITIVE_X (right)
-        "negx.jpg", // GL_TEXTURE_CUBE_MAP_NEGATIVE_X (left)
-        "negy.jpg", // GL_TEXTURE_CUBE_MAP_POSITIVE_Y (top) - swapped
-        "posy.jpg", // GL_TEXTURE_CUBE_MAP_NEGATIVE_Y (bottom) - swapped
-        "posz.jpg", // GL_TEXTURE_CUBE_MAP_POSITIVE_Z (front)
-        "negz.jpg"  // GL_TEXTURE_CUBE_MAP_NEGATIVE_Z (back)
-    };
-    for (int i = 0; i < 6; i++) {
-        unsigned char* faceImage = SOIL_load_image(cubemapFaces[i], &width, &height, 0, SOIL_LOAD_RGB);
-        if (faceImage) {
-            // Flip image vertically: SOIL loads row 0 at top, OpenGL expects row 0 at bottom
-            unsigned char* flipped = new unsigned char[width * height * 3];
-            for (int row = 0; row < height; row++) {
-                std::memcpy(flipped + row * width * 3,
-                           faceImage + (height - 1 - row) * width * 3,
-                           width * 3);
+    {
+        // INSERT SHADERS HERE FOR PROJECT 10 (scene setup lives in Scene.h, shared with the headless benchmark)
+        Scene scene; // Shaders, models, cube buffers and textures
+        DynamicResolution resolution(WIDTH, HEIGHT, options.MinScale, options.MaxScale, options.TargetMs); // Offscreen target upscaled to the window (with --dynamic-resolution on)
+        CameraSimulation simulation(camera); // Fixed-rate camera updates, interpolated for rendering
+        CameraInputLog recording, playback; // Input logs for --record and --replay
+        if (!recordPath.empty())
+            simulation.Recording = &recording;
+        if (!options.ReplayPath.empty() && playback.Load(options.ReplayPath))
+            simulation.Playback = &playback;
+
+        // Game Loop
+        while (!glfwWindowShouldClose(window)) {
+            // Calculate deltaTime for camera movement
+            GLfloat currentFrame = glfwGetTime(); // Get current time
+            deltaTime = currentFrame - lastFrame; // Calculate change in time
+            lastFrame = currentFrame; // Set last frame to current frame
+
+            // Check for events
+            glfwPollEvents(); // Callback glfwPollEvents to check for events
+            TextureManager::Instance().Update(); // Upload textures that finished decoding in the background
+            scene.Update(); // Swap in shaders edited on disk once they compiled
+            bool replaying = simulation.Replaying(); // Still flying the recording
+            simulation.Advance(deltaTime, camera_keys()); // Camera ticks covered by the frame time
+            if (replaying && !simulation.Replaying())
+                cout << "Replay finished after " << playback.EndTick << " ticks" << endl;
+            if (toggleProfiler) { // P: per-pass timing bars
+                scene.Profile.ShowOverlay = !scene.Profile.ShowOverlay;
+                toggleProfiler = false;
             }
-            std::cout << "Loaded cubemap face: " << cubemapFaces[i] << " (" << width << "x" << height << ")" << std::endl;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, flipped);
-            delete[] flipped;
-            SOIL_free_image_data(faceImage);
-        } else {
-            std::cerr << "Failed to load cubemap face: " << cubemapFaces[i] << std::endl;
-            // Fill missing face with a solid color so the cubemap is still valid
-            unsigned char grayPixel[3] = {100, 100, 100};
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i, 0, GL_RGB, 1, 1, 0, GL_RGB, GL_UNSIGNED_BYTE, grayPixel);
-        }
-    }
-    // Set cubemap texture parameters
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR); // Linear filtering
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR); // Linear filtering
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); // Clamp edges to avoid seams
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE); // Clamp edges to avoid seams
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE); // Clamp edges to avoid seams (3rd axis for cubemaps)
-    glBindTexture(GL_TEXTURE_CUBE_MAP, 0); // Unbind cubemap
-
-    // Game Loop
-    while (!glfwWindowShouldClose(window)) {
-        // Calculate deltaTime for camera movement
-        GLfloat currentFrame = glfwGetTime(); // Get current time
-        deltaTime = currentFrame - lastFrame; // Calculate change in time
-        lastFrame = currentFrame; // Set last frame to current frame
-
-        // Check for events
-        glfwPollEvents(); // Callback glfwPollEvents to check for events
-        do_movement(); // Callback do_movement()
-
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f); // Set background color
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear buffers
-
-        
-        // Initialize Camera
-        glm::mat4 view = glm::mat4(1.0f); // Initialize view to identity
-        view = camera.GetViewMatrix(); // Set view based on camera
-        glm::mat4 projection = glm::perspective(45.0f, (GLfloat)WIDTH / (GLfloat)HEIGHT, 0.1f, 100.0f); // Initialize projection using initial values
-        glm::mat4 model = glm::mat4(1.0f); // Initialize model to be 4x4 identity
-
-        // CHECKERBOARD
-        checkerboardShader.Use(); // Use checkerboard shader
-
-        GLint squareColorLoc = glGetUniformLocation(checkerboardShader.Program, "squareColor"); // Retrieve uniform location for squareColor
-        GLint lightColorLoc = glGetUniformLocation(checkerboardShader.Program, "lightColor"); // Retrieve uniform location for lightColor
-        GLint lightPosLoc = glGetUniformLocation(checkerboardShader.Program, "lightPos"); // Retrieve uniform location for lightPos
-        GLint viewPosLoc = glGetUniformLocation(checkerboardShader.Program, "viewPos"); // Retrieve uniform location for viewPos
-
-        glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f); // Pass white color to lightColorLoc uniform
-        glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z); // Pass light position to lightPosLoc uniform
-        glUniform3f(viewPosLoc, camera.Position.x, camera.Position.y, camera.Position.z); // Pass camera position to viewPosLoc uniform
-
-        glm::mat4 view_square = view; // Create mat4 view_square equal to view generic defined above
-
-        GLint modelLoc = glGetUniformLocation(checkerboardShader.Program, "model"); // Retrieve model uniform location
-        GLint viewLoc = glGetUniformLocation(checkerboardShader.Program, "view"); // Retrieve view uniform location
-        GLint projLoc = glGetUniformLocation(checkerboardShader.Program, "projection"); // Retrieve projection uniform location
-
-        for (int i = 0; i < 8; i++) { // For 8 rows
-            for (int j = 0; j < 8; j++) { // For 8 columns
-                if ((i+j) % 2 == 0) { // Check if i+j is odd or even for color purposes
-                    glUniform3f(squareColorLoc, 1.0f, 0.0f, 1.0f); // If even square color is purple --> pass purple to uniform
-                } else {
-                    glUniform3f(squareColorLoc, 1.0f, 1.0f, 1.0f); // If even square color is white --> pas white to uniform
-                }
-                view_square = glm::translate(view_square, glm::vec3(j-4.0f, -0.5f, i-9.0f)); // Translate square to posiiton [setting x and z for grid]
-                view_square = glm::scale(view_square, glm::vec3(1.0f, 0.1f, 1.0f)); // Scale squares to be like tiles
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); // Pass model to uniform
-                glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view_square)); // Pass view_square to uniform
-                glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection)); // Pass projection to uniform
-                // Draw square
-                glBindVertexArray(VAO); // Bind vertex arrays
-                glDrawArrays(GL_TRIANGLES, 0, 36); // Draw arrays for cube
-                view_square = view; // Reset view_square to original view identity [i.e. Translations are independent]
-                
+            if (writeTrace) { // T: everything recorded so far, open in chrome://tracing
+                scene.Profile.WriteChromeTrace("profile_trace.json");
+                writeTrace = false;
+            }
+            if (toggleParallax) { // O: parallax occlusion on/off
+                scene.ParallaxOcclusion = !scene.ParallaxOcclusion;
+                cout << "Parallax: " << (scene.ParallaxOcclusion ? "occlusion mapping" : "single step") << endl;
+                toggleParallax = false;
+            }
+            if (togglePrepass) { // Z: depth pre-pass on/off
+                scene.DepthPrepass = !scene.DepthPrepass;
+                cout << "Depth pre-pass: " << (scene.DepthPrepass ? "on" : "off") << endl;
+                togglePrepass = false;
             }
-        }
-
-        // CUBE - environment mapped cube the camera can walk into
-        cubeShader.Use(); // Activate cube shader
-
-        // Bind cubemap texture for environment mapping
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_CUBE_MAP, cubemapTexture); // Bind the 6-face cubemap
-        glUniform1i(glGetUniformLocation(cubeShader.Program, "skybox"), 0); // Pass to skybox uniform
-
-        glm::mat4 model_cube = glm::mat4(1.0f); // Create cube model matrix
-        model_cube = glm::translate(model_cube, glm::vec3(0.0f, 0.0f, -5.5f)); // Place cube in world aligned with other shapes
-
-        // Get uniform locations
-        modelLoc = glGetUniformLocation(cubeShader.Program, "model"); // Reset modelLoc using cubeShader
-        viewLoc = glGetUniformLocation(cubeShader.Program, "view"); // Reset viewLoc using cubeShader
-        projLoc = glGetUniformLocation(cubeShader.Program, "projection"); // Reset projLoc using cubeShader
-
-        // Pass locations to shader
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model_cube)); // Pass cube model to shader
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view)); // Pass camera view to shader
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection)); // Pass projection to shader
-
-        glBindVertexArray(VAO); // Bind vertex arrays
-        glDrawArrays(GL_TRIANGLES, 0, 36); // Draw cube
-
-        // CYLINDER
-        cylinderShader.Use(); // Activate cylinder shader
-
-        lightColorLoc = glGetUniformLocation(cylinderShader.Program, "lightColor"); // Reset lightColor location
-        lightPosLoc = glGetUniformLocation(cylinderShader.Program, "lightPos"); // Reset lightPos location
-        viewPosLoc = glGetUniformLocation(cylinderShader.Program, "viewPos"); // Reset viewPos location
-
-        glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f); // Pass light color to uniform
-        glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z); // Pass light position to uniform
-        glUniform3f(viewPosLoc, camera.Position.x, camera.Position.y, camera.Position.z); // Pass camera position to uniform
-
-        // Bind textures for bump mapping on cylinder
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseTexture);
-        glUniform1i(glGetUniformLocation(cylinderShader.Program, "diffuseTexture"), 0);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, heightMap);
-        glUniform1i(glGetUniformLocation(cylinderShader.Program, "heightMap"), 1);
-        glUniform2f(glGetUniformLocation(cylinderShader.Program, "uvScale"), 3.0f, 2.0f); // Repeat texture on cylinder
-
-        modelLoc = glGetUniformLocation(cylinderShader.Program, "model"); // Reset model location for cylinderShader
-        viewLoc = glGetUniformLocation(cylinderShader.Program, "view"); // Reset view location for cylinderShader
-        projLoc = glGetUniformLocation(cylinderShader.Program, "projection"); // Reset projection location for cylinderShader
-
-        glm::mat4 model_cylinder = glm::mat4(1.0f); // Initialize cylinder model matrix
-        model_cylinder = glm::translate(model_cylinder, glm::vec3(-2.0f, -3.0f, -5.0f)); // Translate cylinder
-        model_cylinder = glm::scale(model_cylinder, glm::vec3(0.5f, 3.0f, 0.5f)); // Scale cylinder
-
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view)); // Pass camera view matrix
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection)); // Pass projection
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model_cylinder)); // Pass cylinder model matrix
-
-        cylinderModel.Draw(cylinderShader); // Draw obj model
-
-        
-        // SPHERE - bump mapped with height map
-        sphereShader.Use(); // Activate sphere shader
-
-        lightColorLoc = glGetUniformLocation(sphereShader.Program, "lightColor"); // Reset lightColor location
-        lightPosLoc = glGetUniformLocation(sphereShader.Program, "lightPos"); // Reset lightPos location
-        viewPosLoc = glGetUniformLocation(sphereShader.Program, "viewPos"); // Reset viewPos location
-
-        glUniform3f(lightColorLoc, 1.0f, 1.0f, 1.0f); // Pass light color to uniform
-        glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z); // Pass light position to uniform
-        glUniform3f(viewPosLoc, camera.Position.x, camera.Position.y, camera.Position.z); // Pass camera position to uniform
-
-        // Bind bump textures for sphere
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, diffuseTexture);
-        glUniform1i(glGetUniformLocation(sphereShader.Program, "diffuseTexture"), 0);
-
-        glActiveTexture(GL_TEXTURE1);
-        glBindTexture(GL_TEXTURE_2D, heightMap);
-        glUniform1i(glGetUniformLocation(sphereShader.Program, "heightMap"), 1);
-        glUniform2f(glGetUniformLocation(sphereShader.Program, "uvScale"), 2.0f, 2.0f); // Repeat texture on sphere
-
-        modelLoc = glGetUniformLocation(sphereShader.Program, "model"); // Reset model uniform location for sphereShader
-        viewLoc = glGetUniformLocation(sphereShader.Program, "view"); // Reset view uniform location for sphereShader
-        projLoc = glGetUniformLocation(sphereShader.Program, "projection"); // Reset projection uniform location for sphereShader
-
-        glm::mat4 model_sphere = glm::mat4(1.0f); // Initialize sphere model matrix
-        model_sphere = glm::translate(model_sphere, glm::vec3(1.5f, 0.0f, -5.5f)); // Translate sphere
-        model_sphere = glm::scale(model_sphere, glm::vec3(0.5f, 0.5f, 0.5f)); // Scale sphere
-
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view)); // Pass camera view matrix
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection)); // Pass projection
-        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model_sphere)); // Pass sphere model matrix
-
-        sphereModel.Draw(sphereShader); // Draw sphere obj model
 
-        glBindVertexArray(0); // Bind zero at end
-        glfwSwapBuffers(window); // Swap screen buffers
+            simulation.View(camera); // Between the last two ticks
+            GLuint renderWidth = WIDTH, renderHeight = HEIGHT; // Size the frame was drawn at
+            if (dynamicResolution) {
+                resolution.Begin(); // Pick the scale from the GPU time of earlier frames
+                renderWidth = resolution.Width();
+                renderHeight = resolution.Height();
+                scene.Render(camera, renderWidth, renderHeight); // Draw the frame at that size
+                resolution.End(0); // Upscale into the window
+            } else {
+                scene.Render(camera, WIDTH, HEIGHT); // Straight into the window: no offscreen target, blit or timer queries
+            }
+            scene.Profile.DrawOverlay(WIDTH, HEIGHT); // Pass timing bars when enabled, at window resolution after the upscale
+            glfwSwapBuffers(window); // Swap screen buffers
+
+            // Show the culling and draw counters in the title about once a second
+            if ((int)currentFrame != (int)(currentFrame - deltaTime)) { // Crossed a whole second
+                string title = "Project 10 - visible " + to_string(scene.Stats.Visible) + ", culled " + to_string(scene.Stats.Culled)
+                    + ", " + to_string(scene.Stats.DrawCalls) + " draws, " + to_string(scene.Stats.StateChanges) + " binds, " + to_string(scene.Stats.Triangles) + " tris, "
+                    + to_string(renderWidth) + "x" + to_string(renderHeight); // Stats
+                glfwSetWindowTitle(window, title.c_str()); // Update title
+                if (scene.Profile.ShowOverlay) // Numbers for the overlay bars
+                    cout << scene.Profile.Report();
+            }
 
-    }
-    // Deallocate resources
-    glDeleteVertexArrays(1, &VAO); // Deallocate vertex arrays
-    glDeleteBuffers(1, &VBO); // Deallocate buffers
-    glDeleteTextures(1, &cubemapTexture); // Deallocate cubemap texture
+        }
+        if (simulation.Recording && recording.Save(recordPath)) // Flythrough for --replay
+            cout << "Recorded " << recording.EndTick << " ticks to " << recordPath << endl;
+    } // Deallocate resources while the context still exists
     glfwTerminate(); // Terminate window
     return 0; // Returns 0 for end of int main()
 
@@ -412,6 +189,14 @@ int main() {
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode) {
     if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS) { // If ESC pressed
         glfwSetWindowShouldClose(window, GL_TRUE); // Close window
+    } if (key == GLFW_KEY_P && action == GLFW_PRESS) { // If P pressed
+        toggleProfiler = true; // Toggle overlay next frame
+    } if (key == GLFW_KEY_T && action == GLFW_PRESS) { // If T pressed
+        writeTrace = true; // Write trace next frame
+    } if (key == GLFW_KEY_O && action == GLFW_PRESS) { // If O pressed
+        toggleParallax = true; // Switch parallax mode next frame
+    } if (key == GLFW_KEY_Z && action == GLFW_PRESS) { // If Z pressed
+        togglePrepass = true; // Switch depth pre-pass next frame
     } if (key >= 0 && key < 1024) { // Allow for 1024 key presses
         if (action == GLFW_PRESS) { // If pressed
             keys[key] = true; // Set keys[key] = true [key pressed]
@@ -421,43 +206,17 @@ void key_callback(GLFWwindow* window, int key, int scancode, int action, int mod
     }
 }
 
-// Initiates movement based on keyboard input
-void do_movement() {
-    if (keys[GLFW_KEY_LEFT_SHIFT] || keys[GLFW_KEY_RIGHT_SHIFT]) { // If either shift keys are pressed
-        if (keys[GLFW_KEY_UP]) { // If up arrow
-            camera.ProcessKeyboard(FORWARD, deltaTime); // Move camera forward with callback
-        } else if (keys[GLFW_KEY_DOWN]) { // If down arrow
-            camera.ProcessKeyboard(BACKWARD, deltaTime); // Move camera backward with callback
-        } else if (keys[GLFW_KEY_COMMA]) { // If comma --> less than symbol
-            camera.ProcessKeyboard(UPROLL, deltaTime); // Move camera in positive roll with callback
-        } else if (keys[GLFW_KEY_PERIOD]) { // If period --> greater than symbol
-            camera.ProcessKeyboard(DOWNROLL, deltaTime); // Move camera in negative roll with callback
-        }
-    }
-    else if (keys[GLFW_KEY_LEFT_CONTROL] || keys[GLFW_KEY_RIGHT_CONTROL]) { // If either ctrl key is pressed
-        if (keys[GLFW_KEY_DOWN]) { // If down arrow
-            camera.ProcessKeyboard(UPPITCH, deltaTime); // Move camera in positive pitch with callback
-        } else if (keys[GLFW_KEY_UP]) { // If up arrow
-            camera.ProcessKeyboard(DOWNPITCH, deltaTime); // Move camera in negative pitch with callback
-        } else if (keys[GLFW_KEY_RIGHT]) { // If right arrow
-            camera.ProcessKeyboard(UPYAW, deltaTime); // Move camera in positive yaw with callback
-        } else if (keys[GLFW_KEY_LEFT]) { // If left arrow
-            camera.ProcessKeyboard(DOWNYAW, deltaTime); // Move camera in negative yaw with callback
-        }
-    }
-    else if (keys[GLFW_KEY_RIGHT]) { // If right arrow
-        camera.ProcessKeyboard(RIGHT, deltaTime); // Translate camera right with callback
-    }
-    else if (keys[GLFW_KEY_LEFT]) { // If left arrow
-        camera.ProcessKeyboard(LEFT, deltaTime); // Translate camera left with callback
-    }
-    else if (keys[GLFW_KEY_UP]) { // If up arrow
-        camera.ProcessKeyboard(UP, deltaTime); // Translate camera up with callback
-    }
-    else if (keys[GLFW_KEY_DOWN]) { // If down arrow
-        camera.ProcessKeyboard(DOWN, deltaTime); // Translate camera down with callback
-    }
-    else if (keys[GLFW_KEY_R]) { // If r is pressed
-        camera.ResetCamera(); // Reset camera with callback
-    }
+// Maps the held keys to the Camera_Key bits the camera simulation steps with (see Camera::Step)
+GLuint camera_keys() {
+    GLuint state = 0; // Camera_Key bits
+    if (keys[GLFW_KEY_LEFT]) state |= CAMERA_KEY_LEFT; // Left arrow
+    if (keys[GLFW_KEY_RIGHT]) state |= CAMERA_KEY_RIGHT; // Right arrow
+    if (keys[GLFW_KEY_UP]) state |= CAMERA_KEY_UP; // Up arrow
+    if (keys[GLFW_KEY_DOWN]) state |= CAMERA_KEY_DOWN; // Down arrow
+    if (keys[GLFW_KEY_LEFT_SHIFT] || keys[GLFW_KEY_RIGHT_SHIFT]) state |= CAMERA_KEY_SHIFT; // Either shift key
+    if (keys[GLFW_KEY_LEFT_CONTROL] || keys[GLFW_KEY_RIGHT_CONTROL]) state |= CAMERA_KEY_CONTROL; // Either ctrl key
+    if (keys[GLFW_KEY_COMMA]) state |= CAMERA_KEY_COMMA; // Comma --> less than symbol
+    if (keys[GLFW_KEY_PERIOD]) state |= CAMERA_KEY_PERIOD; // Period --> greater than symbol
+    if (keys[GLFW_KEY_R]) state |= CAMERA_KEY_RESET; // R resets the camera
+    return state;
 }
@@ -6,18 +6,142 @@
 #include <fstream> // Include fstream
 #include <sstream> // Include sstream
 #include <iostream> // Include iostream
+#include <unordered_map> // Include unordered_map
+#include <sys/inotify.h> // Include inotify for hot reload
+#include <unistd.h> // Include read/close
 
 #include <GL/glew.h> // Include glew
+#include <glm/glm.hpp> // Include glm
+#include <glm/gtc/type_ptr.hpp> // Include value_ptr
+
+#include "ProgramCache.h" // Include program binary cache
 
 using namespace std; // Use namespace std
 
+// Binding point of the shared per-frame uniform block (see FrameUniforms below)
+const GLuint FRAME_UNIFORM_BINDING = 0;
+
 class Shader {
 public:
     GLuint Program; // Initialize GLuint 
-    Shader(const GLchar* vertexPath, const GLchar* fragmentPath) { // Shader constructor
+    // With useCache the linked program is loaded from / stored to a binary cache next to the vertex shader
+    // (see ProgramCache.h), so only the first launch after a shader or driver change compiles GLSL.
+    // Both source files are watched with inotify; call Update() every frame to hot-reload them.
+    Shader(const GLchar* vertexPath, const GLchar* fragmentPath, bool useCache = true) : // Shader constructor
+        vertexPath(vertexPath), fragmentPath(fragmentPath), useCache(useCache), watchFd(-1),
+        pendingVertex(0), pendingFragment(0), pendingProgram(0), pendingFrames(0) {
         // Retrieve vertex/fragment code from path
         string vertexCode; // Initialize vertexCode string
         string fragmentCode; // Initialize fragmentCode string
+        this->readSources(vertexCode, fragmentCode); // Read both files
+        // Program binary cache: load the linked program, compile from source only when it misses
+        uint64_t cacheKey = useCache ? ProgramCacheKey(vertexCode, fragmentCode) : 0; // Sources + driver
+        string cachePath = ProgramCachePath(vertexPath, fragmentPath); // Next to the vertex shader
+        this->Program = useCache ? LoadProgramBinary(cachePath, cacheKey) : 0; // 0 on miss or rejected binary
+        if (this->Program == 0) {
+            ParallelShaderCompileSupported(); // Start the driver's compiler threads before the first compile
+            GLuint vertex, fragment; // Stages, deleted once linked
+            this->Program = this->build(vertexCode, fragmentCode, vertex, fragment); // Compile and link
+            this->checkBuild(vertex, fragment, this->Program); // Print errors if necessary
+            glDeleteShader(vertex); // Delete vertex shader
+            glDeleteShader(fragment); // Delete fragment shader
+            if (useCache)
+                WriteProgramBinary(cachePath, cacheKey, this->Program); // Store for the next launch
+        }
+        // Cache uniform locations and hook up the shared frame block
+        this->reflectUniforms(); // Build uniform table
+        this->watch(); // Hot reload
+    }
+    ~Shader() {
+        this->discardReload(); // Build in flight
+        glDeleteProgram(this->Program); // Delete program
+        if (this->watchFd >= 0)
+            close(this->watchFd); // Stop watching
+    }
+    Shader(const Shader&) = delete; // Owns the program and the watch, no copies
+    Shader& operator=(const Shader&) = delete;
+
+    // Uses the current shader
+    void Use() {
+        glUseProgram(this->Program); // Use program with shaders from method above
+    }
+
+    // Hot reload, call once per frame. When a source file changed it starts compiling the new program without
+    // waiting for it. With GL_KHR_parallel_shader_compile the driver compiles on its own threads and Update never
+    // blocks. Without it there is no way to ask whether the build is done, so the status is queried a frame later
+    // and that query can stall the frame until compiling finishes. Once linked the new program replaces Program
+    // and the uniform table is rebuilt; a failed build prints its log and keeps the old program. Returns true
+    // when Program was replaced, so the caller can set its constant uniforms (sampler units etc.) again.
+    bool Update() {
+        if (this->sourcesChanged()) // Saved in an editor
+            this->beginReload(); // Restarts a build already in flight
+        if (this->pendingProgram == 0) // Nothing compiling
+            return false;
+        this->pendingFrames++;
+        if (ParallelShaderCompileSupported()) {
+            GLint done = GL_FALSE; // Compile and link finished
+            glGetProgramiv(this->pendingProgram, GL_COMPLETION_STATUS_KHR, &done); // Never blocks
+            if (!done)
+                return false;
+        } else if (this->pendingFrames < 2) { // Give the driver a frame before asking (the query below may still block)
+            return false;
+        }
+        return this->finishReload(); // Swap or keep the old program
+    }
+
+    // Returns the location of a uniform from the table built at link time, -1 if the program has no such uniform
+    // (glUniform* ignores -1, so optional uniforms can be set unconditionally)
+    GLint Uniform(const string& name) const {
+        unordered_map<string, GLint>::const_iterator it = this->uniforms.find(name); // Look up name
+        return (it == this->uniforms.end()) ? -1 : it->second; // Location or -1
+    }
+
+    // Typed setters. They write to the currently bound program, so call Use() first.
+    void SetInt(const string& name, GLint value) const {
+        glUniform1i(this->Uniform(name), value); // Set int / sampler unit
+    }
+    void SetFloat(const string& name, GLfloat value) const {
+        glUniform1f(this->Uniform(name), value); // Set float
+    }
+    void SetVec2(const string& name, GLfloat x, GLfloat y) const {
+        glUniform2f(this->Uniform(name), x, y); // Set vec2
+    }
+    void SetVec3(const string& name, const glm::vec3& value) const {
+        glUniform3fv(this->Uniform(name), 1, glm::value_ptr(value)); // Set vec3
+    }
+    void SetMat4(const string& name, const glm::mat4& value) const {
+        glUniformMatrix4fv(this->Uniform(name), 1, GL_FALSE, glm::value_ptr(value)); // Set mat4
+    }
+
+    // Asks the driver for as many background compiler threads as it likes (GL_KHR_parallel_shader_compile).
+    // Called by the first Shader; harmless without the extension.
+    static bool ParallelShaderCompileSupported() {
+        static bool supported = false, initialized = false; // Checked once per process
+        if (!initialized) {
+            initialized = true;
+            if (GLEW_KHR_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu); // Implementation-chosen thread count
+                supported = true;
+            } else if (GLEW_ARB_parallel_shader_compile) {
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFFu); // Same thing, ARB flavor (same completion enum)
+                supported = true;
+            }
+        }
+        return supported;
+    }
+
+private:
+    unordered_map<string, GLint> uniforms; // Active uniform name -> location
+    string vertexPath; // Vertex shader source
+    string fragmentPath; // Fragment shader source
+    bool useCache; // Read/write the program binary cache
+    int watchFd; // inotify descriptor, -1 when not watching
+    GLuint pendingVertex, pendingFragment, pendingProgram; // Reload in flight, 0 when idle
+    GLuint pendingFrames; // Update calls since the reload started
+    string pendingVertexCode, pendingFragmentCode; // Sources of the reload in flight (its program cache key)
+
+    // Reads both source files
+    bool readSources(string& vertexCode, string& fragmentCode) const {
         ifstream vShaderFile; // Initialize file for vertex shader
         ifstream fShaderFile; // Initialize file for fragment shader
         // Allows for exceptions
@@ -26,8 +150,8 @@ public:
         // Read Shaders
         try {
             // Open Files
-            vShaderFile.open(vertexPath); // Try opening .vs using path
-            fShaderFile.open(fragmentPath); // Try opening .frag using path
+            vShaderFile.open(this->vertexPath.c_str()); // Try opening .vs using path
+            fShaderFile.open(this->fragmentPath.c_str()); // Try opening .frag using path
             stringstream vShaderStream, fShaderStream; // Initalize stringstream for both
             // Read file's buffer contents into streams
             vShaderStream << vShaderFile.rdbuf(); // Read in .vs
@@ -41,50 +165,214 @@ public:
         }
         catch (ifstream::failure e) {
             cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ" << endl; // Error message if catch
+            return false;
         }
+        return true;
+    }
+
+    // Issues compile and link without asking for the result, so with parallel compile nothing waits here
+    GLuint build(const string& vertexCode, const string& fragmentCode, GLuint& vertex, GLuint& fragment) const {
         // Compilation
         const GLchar* vShaderCode = vertexCode.c_str(); // Initialize GLchar* for vs
         const GLchar* fShaderCode = fragmentCode.c_str(); // Initalize GLchar* for frag
-        GLuint vertex, fragment; // Initalize GLuint for vs and frag
-        GLint success; // Initalize GLint for success
-        GLchar infoLog[512]; // Initialize infoLog
         // Vertex Shader
         vertex = glCreateShader(GL_VERTEX_SHADER); // Set vertex = shader
         glShaderSource(vertex, 1, &vShaderCode, NULL); // Get source
         glCompileShader(vertex); // Compile vertex shader
+        // Fragment Shader
+        fragment = glCreateShader(GL_FRAGMENT_SHADER); // Initalize gragment as shader
+        glShaderSource(fragment, 1, &fShaderCode, NULL); // Get source
+        glCompileShader(fragment); // Compile fragment shader
+        // Linking Shader Program
+        GLuint program = glCreateProgram(); // Set program to createProgram output
+        if (ProgramCacheSupported())
+            glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE); // Allow glGetProgramBinary
+        glAttachShader(program, vertex); // Attach vertex shader
+        glAttachShader(program, fragment); // Attach frag shader
+        glLinkProgram(program); // Link program
+        return program;
+    }
+
+    // Prints compile and link errors, true if the program linked
+    bool checkBuild(GLuint vertex, GLuint fragment, GLuint program) const {
+        GLint success; // Initalize GLint for success
+        GLchar infoLog[512]; // Initialize infoLog
         // Print compile errors if necessary
         glGetShaderiv(vertex, GL_COMPILE_STATUS, &success); // Get status
         if (!success) { // If failure
             glGetShaderInfoLog(vertex, 512, NULL, infoLog); // Get info on failure
             cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << endl; // Print error message if catch
         }
-        // Fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER); // Initalize gragment as shader
-        glShaderSource(fragment, 1, &fShaderCode, NULL); // Get source
-        glCompileShader(fragment); // Compile fragment shader
-        // Print compile errors if necessary
         glGetShaderiv(fragment, GL_COMPILE_STATUS, &success); // Get status
         if (!success) { // If failure
             glGetShaderInfoLog(fragment, 512, NULL, infoLog); // Get info on failure
             cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << endl; // Print error message if catch
         }
-        // Linking Shader Program
-        this->Program = glCreateProgram(); // Set program to createProgram output
-        glAttachShader(this->Program, vertex); // Attach vertex shader
-        glAttachShader(this->Program, fragment); // Attach frag shader
-        glLinkProgram(this->Program); // Link program
         // Print linking errors if necessary
-        glGetProgramiv(this->Program, GL_LINK_STATUS, &success); // Get linking status
+        glGetProgramiv(program, GL_LINK_STATUS, &success); // Get linking status
         if (!success) { // If failure
-            glGetProgramInfoLog(this->Program, 512, NULL, infoLog); // Get info on failure
+            glGetProgramInfoLog(program, 512, NULL, infoLog); // Get info on failure
             cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << endl; // Print error message if catch
         }
-        // Delete shaders
-        glDeleteShader(vertex); // Delete vertex shader
-        glDeleteShader(fragment); // Delete fragment shader
+        return success == GL_TRUE;
     }
-    // Uses the current shader
-    void Use() {
-        glUseProgram(this->Program); // Use program with shaders from method above
+
+    // Watches the directories of both sources (editors often save by writing a new file and renaming it over
+    // the old one, which a watch on the file itself would lose)
+    void watch() {
+        this->watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC); // Non-blocking reads
+        if (this->watchFd < 0)
+            return; // No hot reload, everything else works
+        const string* paths[2] = { &this->vertexPath, &this->fragmentPath };
+        for (int i = 0; i < 2; i++) {
+            size_t slash = paths[i]->find_last_of('/'); // Directory of the file
+            string directory = (slash == string::npos) ? "." : paths[i]->substr(0, slash);
+            inotify_add_watch(this->watchFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO); // Same directory twice is one watch
+        }
+    }
+
+    // Drains pending inotify events, true if one of them is for a source file
+    bool sourcesChanged() {
+        if (this->watchFd < 0)
+            return false;
+        bool changed = false; // Event for vertexPath or fragmentPath
+        char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event)))); // Event buffer
+        ssize_t length; // Bytes read
+        while ((length = read(this->watchFd, buffer, sizeof(buffer))) > 0) { // Until EAGAIN
+            for (char* p = buffer; p < buffer + length; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+                const struct inotify_event* event = (const struct inotify_event*)p;
+                if (event->len == 0)
+                    continue;
+                string name(event->name); // File name inside the watched directory
+                if (this->matches(this->vertexPath, name) || this->matches(this->fragmentPath, name))
+                    changed = true;
+            }
+        }
+        return changed;
+    }
+
+    // True if path names the file called name
+    static bool matches(const string& path, const string& name) {
+        size_t slash = path.find_last_of('/'); // File name part of path
+        return ((slash == string::npos) ? path : path.substr(slash + 1)) == name;
+    }
+
+    // Starts compiling the changed sources
+    void beginReload() {
+        this->discardReload(); // A newer save wins
+        string vertexCode, fragmentCode; // New sources
+        if (!this->readSources(vertexCode, fragmentCode))
+            return;
+        this->pendingProgram = this->build(vertexCode, fragmentCode, this->pendingVertex, this->pendingFragment); // Returns immediately
+        this->pendingFrames = 0;
+        this->pendingVertexCode.swap(vertexCode); // Kept for the cache key: the files may change again while compiling
+        this->pendingFragmentCode.swap(fragmentCode);
+    }
+
+    // Swaps in the finished program, or prints why it failed and keeps the current one
+    bool finishReload() {
+        bool linked = this->checkBuild(this->pendingVertex, this->pendingFragment, this->pendingProgram); // Logs on failure
+        if (!linked) {
+            cout << "ERROR::SHADER::RELOAD_FAILED " << this->vertexPath << " + " << this->fragmentPath << " (keeping the old program)" << endl;
+            this->discardReload();
+            return false;
+        }
+        glDeleteShader(this->pendingVertex); // Stages are no longer needed
+        glDeleteShader(this->pendingFragment);
+        glDeleteProgram(this->Program); // Old program
+        this->Program = this->pendingProgram; // Swap
+        this->pendingVertex = this->pendingFragment = this->pendingProgram = 0;
+        this->reflectUniforms(); // Locations may have moved
+        if (this->useCache) // Next launch starts with the edited program, keyed by the sources actually compiled
+            WriteProgramBinary(ProgramCachePath(this->vertexPath, this->fragmentPath), ProgramCacheKey(this->pendingVertexCode, this->pendingFragmentCode), this->Program);
+        this->pendingVertexCode.clear();
+        this->pendingFragmentCode.clear();
+        cout << "Reloaded shader " << this->vertexPath << " + " << this->fragmentPath << endl;
+        return true;
+    }
+
+    // Deletes a build in flight
+    void discardReload() {
+        if (this->pendingProgram == 0)
+            return;
+        glDeleteShader(this->pendingVertex);
+        glDeleteShader(this->pendingFragment);
+        glDeleteProgram(this->pendingProgram);
+        this->pendingVertex = this->pendingFragment = this->pendingProgram = 0;
+        this->pendingVertexCode.clear();
+        this->pendingFragmentCode.clear();
+    }
+
+    // Queries every active uniform once so the render loop never asks the driver for a location by string.
+    // Uniforms living in a block (FrameData) have no location and are skipped; the block itself is bound
+    // to FRAME_UNIFORM_BINDING so every program reads the same buffer.
+    void reflectUniforms() {
+        this->uniforms.clear(); // Start fresh (also used after relinking)
+        GLint count = 0; // Number of active uniforms
+        glGetProgramiv(this->Program, GL_ACTIVE_UNIFORMS, &count); // Get count
+        GLchar name[256]; // Uniform name buffer
+        for (GLint i = 0; i < count; i++) { // Iterate over active uniforms
+            GLsizei length = 0; // Name length
+            GLint size = 0; // Array size
+            GLenum type = 0; // Uniform type
+            glGetActiveUniform(this->Program, (GLuint)i, sizeof(name), &length, &size, &type, name); // Get name
+            GLint location = glGetUniformLocation(this->Program, name); // Resolve location once
+            if (location < 0) // Block member
+                continue;
+            string key(name, length); // Name as string
+            this->uniforms[key] = location; // Store location
+            if (key.size() > 3 && key.compare(key.size() - 3, 3, "[0]") == 0) // Arrays are reported as name[0]
+                this->uniforms[key.substr(0, key.size() - 3)] = location; // Also store plain name
+        }
+        GLuint frameBlock = glGetUniformBlockIndex(this->Program, "FrameData"); // Shared frame block
+        if (frameBlock != GL_INVALID_INDEX)
+            glUniformBlockBinding(this->Program, frameBlock, FRAME_UNIFORM_BINDING); // Bind to shared slot
+    }
+};
+
+// Camera and light data shared by every program through the std140 "FrameData" uniform block:
+//     layout (std140) uniform FrameData { mat4 view; mat4 projection; vec3 viewPos; vec3 lightPos; vec3 lightColor; };
+// std140 puts each vec3 on a 16 byte boundary, hence the padding floats.
+struct FrameData {
+    glm::mat4 view; // View matrix (offset 0)
+    glm::mat4 projection; // Projection matrix (offset 64)
+    glm::vec3 viewPos; // Camera position (offset 128)
+    GLfloat pad0; // std140 padding
+    glm::vec3 lightPos; // Light position (offset 144)
+    GLfloat pad1; // std140 padding
+    glm::vec3 lightColor; // Light color (offset 160)
+    GLfloat pad2; // std140 padding
+};
+
+// Owns the uniform buffer behind FrameData. Upload once per frame; every program reads it from FRAME_UNIFORM_BINDING.
+class FrameUniforms {
+public:
+    GLuint UBO; // Uniform buffer object
+
+    FrameUniforms() {
+        glGenBuffers(1, &this->UBO); // Create buffer
+        glBindBuffer(GL_UNIFORM_BUFFER, this->UBO); // Bind as uniform buffer
+        glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameData), NULL, GL_DYNAMIC_DRAW); // Allocate storage
+        glBindBuffer(GL_UNIFORM_BUFFER, 0); // Unbind
+        glBindBufferBase(GL_UNIFORM_BUFFER, FRAME_UNIFORM_BINDING, this->UBO); // Attach to shared binding point
+    }
+    ~FrameUniforms() {
+        glDeleteBuffers(1, &this->UBO); // Delete buffer
+    }
+    FrameUniforms(const FrameUniforms&) = delete; // Owns a GL buffer, no copies
+    FrameUniforms& operator=(const FrameUniforms&) = delete;
+
+    // Uploads this frame's camera and light data (one upload for all programs)
+    void Update(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPos, const glm::vec3& lightPos, const glm::vec3& lightColor) {
+        FrameData data; // CPU copy in std140 layout
+        data.view = view; // Set view
+        data.projection = projection; // Set projection
+        data.viewPos = viewPos; // Set camera position
+        data.lightPos = lightPos; // Set light position
+        data.lightColor = lightColor; // Set light color
+        data.pad0 = data.pad1 = data.pad2 = 0.0f; // Clear padding
+        glBindBuffer(GL_UNIFORM_BUFFER, this->UBO); // Bind buffer
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameData), &data); // Upload
+        glBindBuffer(GL_UNIFORM_BUFFER, 0); // Unbind
     }
 };
@@ -5,52 +5,101 @@ in vec3 FragPos;    // World-space position
 in vec2 TexCoord;   // Texture coordinate
 in mat3 TBN;        // Tangent-Bitangent-Normal matrix
 
-uniform vec3 lightPos;       // Light position in world space
-uniform vec3 viewPos;        // Camera position in world space
-uniform vec3 lightColor;     // Light color
+layout (std140) uniform FrameData { // Shared per-frame block (FrameUniforms in shader.h)
+    mat4 view; // View matrix
+    mat4 projection; // Projection matrix
+    vec3 viewPos; // Camera position
+    vec3 lightPos; // Light position
+    vec3 lightColor; // Light color
+};
 uniform sampler2D diffuseTexture; // Diffuse texture sampler
-uniform sampler2D heightMap;      // Height map sampler
+uniform sampler2D bumpMap;        // Bump map sampler: normal X/Y in rg, height in b (BumpMap.h)
 uniform vec2 uvScale;        // UV tiling amount
+uniform bool parallaxOcclusion; // Adaptive parallax occlusion mapping (false: single-step offset only)
+
+const float heightScale = 0.05;      // Control height offset strength
+const float POM_MIN_STEPS = 8.0;     // March steps when the surface faces the camera
+const float POM_MAX_STEPS = 32.0;    // March steps at grazing angles
+const float POM_FADE_START = 6.0;    // Distance where the step count starts dropping
+const float POM_LOD_DISTANCE = 10.0; // Beyond this only the single-step offset runs
+const float POM_MAX_MIP = 2.0;       // Coarser height map mips hide the relief, so the march is skipped
+const int POM_REFINE_STEPS = 5;      // Binary search iterations after the march
 
 vec2 ParallaxMapping(vec2 texCoords, vec3 viewDir)
 {
-    float heightScale = 0.05; // Control height offset strength
-    float height = texture(heightMap, texCoords).r; // Sample height
+    float height = texture(bumpMap, texCoords).b; // Sample height
     vec2 p = viewDir.xy / max(viewDir.z, 0.1) * (height * heightScale); // Parallax offset
     return texCoords - p;
 }
 
-vec3 BumpNormalFromHeight(vec2 texCoords)
+// Marches the view ray through the height field (same depth convention as ParallaxMapping) and refines the hit
+// with a binary search. The step count goes from 8 head-on to 32 at grazing angles and fades out with distance.
+// Far away, once the height map is sampled from a coarse mip, or with parallaxOcclusion off, it returns the
+// single-step offset. The mip level is computed once from the unshifted coordinate's derivatives (dx, dy) and
+// every fetch in the loops uses textureLod with it, so the march needs no per-sample derivatives.
+// Skipping is expressed as a zero step count rather than a branch around the loops: SIMD rasterizers (llvmpipe)
+// otherwise keep looping for lanes masked off by the branch, and the skipped case costs as much as a full march.
+vec2 ParallaxOcclusionMapping(vec2 texCoords, vec3 viewDir, float distance, vec2 dx, vec2 dy)
 {
-    vec2 texel = 1.0 / vec2(textureSize(heightMap, 0)); // Texture-space step
-    float hL = texture(heightMap, texCoords - vec2(texel.x, 0.0)).r; // Left sample
-    float hR = texture(heightMap, texCoords + vec2(texel.x, 0.0)).r; // Right sample
-    float hD = texture(heightMap, texCoords - vec2(0.0, texel.y)).r; // Down sample
-    float hU = texture(heightMap, texCoords + vec2(0.0, texel.y)).r; // Up sample
-
-    float bumpScale = 5.0; // Bump intensity
-    float dHdU = (hR - hL) * bumpScale; // Height derivative along U
-    float dHdV = (hU - hD) * bumpScale; // Height derivative along V
+    vec2 texels = vec2(textureSize(bumpMap, 0)); // Level 0 size
+    float mip = 0.5 * log2(max(dot(dx * texels, dx * texels), dot(dy * texels, dy * texels))); // Mip the sampler picks
+    float steps = mix(POM_MAX_STEPS, POM_MIN_STEPS, abs(viewDir.z)) * (1.0 - smoothstep(POM_FADE_START, POM_LOD_DISTANCE, distance)); // Adaptive step count
+    int stepCount = (parallaxOcclusion && mip <= POM_MAX_MIP && steps >= 1.0) ? int(ceil(steps)) : 0; // 0: relief too small on screen to march
+
+    float layerDepth = 1.0 / max(float(stepCount), 1.0); // Depth per step
+    vec2 deltaUV = viewDir.xy / max(viewDir.z, 0.1) * heightScale * layerDepth; // UV shift per step
+    vec2 uv = texCoords; // Current sample
+    float layer = 0.0; // Current ray depth
+    for (int i = 0; i < stepCount; i++) { // Linear march, exits at the first sample below the surface
+        if (layer >= textureLod(bumpMap, uv, mip).b)
+            break;
+        uv -= deltaUV;
+        layer += layerDepth;
+    }
+
+    vec2 aboveUV = uv + deltaUV; // Last sample above the surface
+    float aboveLayer = layer - layerDepth;
+    int refineSteps = (layer > 0.0) ? POM_REFINE_STEPS : 0; // Nothing to refine without a march, or on a first-sample hit
+    for (int i = 0; i < refineSteps; i++) { // Binary search between the last two samples
+        vec2 midUV = 0.5 * (aboveUV + uv);
+        float midLayer = 0.5 * (aboveLayer + layer);
+        if (midLayer >= textureLod(bumpMap, midUV, mip).b) {
+            uv = midUV; // Still below
+            layer = midLayer;
+        } else {
+            aboveUV = midUV; // Above
+            aboveLayer = midLayer;
+        }
+    }
+    if (stepCount == 0)
+        uv = ParallaxMapping(texCoords, viewDir); // Single-step offset
+    return uv;
+}
 
-    return normalize(vec3(-dHdU, -dHdV, 1.0)); // Tangent-space bumped normal
+vec3 BumpNormal(vec2 texCoords)
+{
+    vec2 xy = texture(bumpMap, texCoords).rg * 2.0 - 1.0; // Precomputed normal X/Y (Sobel of the height map, bump scale 5)
+    return vec3(xy, sqrt(max(1.0 - dot(xy, xy), 0.0))); // Tangent-space bumped normal, Z rebuilt
 }
 
 void main()
 {
     vec2 tiledTexCoord = TexCoord * uvScale; // Repeat UVs across sphere
+    vec2 dx = dFdx(tiledTexCoord), dy = dFdy(tiledTexCoord); // UV footprint of the unshifted coordinate
 
-    // Transform positions from world space to tangent space
-    vec3 tangentFragPos = TBN * FragPos;     // Tangent-space fragment position
-    vec3 tangentViewPos = TBN * viewPos;     // Tangent-space view position
-    vec3 tangentLightPos = TBN * lightPos;   // Tangent-space light position
+    // Transform positions from world space to tangent space (TBN maps tangent -> world, its transpose the inverse)
+    mat3 worldToTangent = transpose(TBN);              // Orthonormal basis: transpose = inverse
+    vec3 tangentFragPos = worldToTangent * FragPos;    // Tangent-space fragment position
+    vec3 tangentViewPos = worldToTangent * viewPos;    // Tangent-space view position
+    vec3 tangentLightPos = worldToTangent * lightPos;  // Tangent-space light position
 
     vec3 viewDir = normalize(tangentViewPos - tangentFragPos); // Tangent-space view direction
 
     // Apply parallax mapping to offset texture coordinates
-    vec2 parallaxTexCoord = ParallaxMapping(tiledTexCoord, viewDir);
+    vec2 parallaxTexCoord = ParallaxOcclusionMapping(tiledTexCoord, viewDir, length(viewPos - FragPos), dx, dy);
 
-    // Build bumped normal from the parallax-offset height map
-    vec3 tangentNormal = BumpNormalFromHeight(parallaxTexCoord);
+    // Bumped normal at the parallax-offset coordinate
+    vec3 tangentNormal = BumpNormal(parallaxTexCoord);
 
     vec3 lightDir = normalize(tangentLightPos - tangentFragPos); // Tangent-space light direction
 
@@ -1,28 +1,54 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;      // Sphere position
-layout (location = 1) in vec3 aNormal;   // Sphere normal
+layout (location = 1) in vec3 aNormal;   // Sphere normal (packed: octahedral xy)
 layout (location = 2) in vec2 aTexCoord; // Texture coordinate
-layout (location = 3) in vec3 aTangent;  // Tangent vector
+layout (location = 3) in vec4 aTangent;  // Tangent vector (packed: octahedral xy, handedness in w)
 layout (location = 4) in vec3 aBitangent; // Bitangent vector
 
 out vec3 FragPos;   // World-space position
 out vec2 TexCoord;  // Texture coordinate
 out mat3 TBN;       // Tangent-Bitangent-Normal matrix
+invariant gl_Position; // Same depth in the pre-pass program (depth.frag) and the shading pass, for GL_EQUAL
 
 uniform mat4 model;       // Model matrix
-uniform mat4 view;        // View matrix
-uniform mat4 projection;  // Projection matrix
+uniform bool packedVertices; // Mesh uploaded as PackedVertex (set by Mesh::Draw)
+layout (std140) uniform FrameData { // Shared per-frame block (FrameUniforms in shader.h)
+    mat4 view; // View matrix
+    mat4 projection; // Projection matrix
+    vec3 viewPos; // Camera position
+    vec3 lightPos; // Light position
+    vec3 lightColor; // Light color
+};
+
+// Rebuilds a unit vector from its octahedral encoding (see OctahedralEncode in Mesh.h)
+vec3 OctahedralDecode(vec2 e)
+{
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y)); // Unfold onto the octahedron
+    float t = max(-n.z, 0.0); // Lower hemisphere overlap
+    n.xy += vec2(n.x >= 0.0 ? -t : t, n.y >= 0.0 ? -t : t); // Fold back
+    return normalize(n);
+}
 
 void main() {
+    vec3 normal = aNormal;           // Object-space normal
+    vec3 tangent = aTangent.xyz;     // Object-space tangent
+    vec3 bitangent = aBitangent;     // Object-space bitangent
+    if (packedVertices) {            // Decode the compact layout
+        normal = OctahedralDecode(aNormal.xy);   // Unpack normal
+        tangent = OctahedralDecode(aTangent.xy); // Unpack tangent
+        bitangent = cross(normal, tangent) * (aTangent.w < 0.0 ? -1.0 : 1.0); // Rebuild bitangent from handedness
+    }
+
+
     vec4 worldPos = model * vec4(aPos, 1.0f);        // Object -> world
     FragPos = worldPos.xyz;                          // Pass world position
     TexCoord = aTexCoord;                            // Pass texture coordinate
 
     // Build TBN matrix for tangent space transformations
     mat3 normalMatrix = transpose(inverse(mat3(model))); // Correct normal transform
-    vec3 T = normalize(normalMatrix * aTangent);         // World-space tangent
-    vec3 B = normalize(normalMatrix * aBitangent);       // World-space bitangent
-    vec3 N = normalize(normalMatrix * aNormal);          // World-space normal
+    vec3 T = normalize(normalMatrix * tangent);          // World-space tangent
+    vec3 B = normalize(normalMatrix * bitangent);        // World-space bitangent
+    vec3 N = normalize(normalMatrix * normal);           // World-space normal
     TBN = mat3(T, B, N);                                 // Build TBN matrix
 
     gl_Position = projection * view * worldPos;      // Final clip-space position
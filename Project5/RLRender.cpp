@@ -3,6 +3,7 @@
 * * 1.1 Set up camera
 * * 1.2 Set up materials
 * * 1.3 Set up lighting
+* * 1.4 Retained-mode recording (rl* wrappers)
 * 2. Draw Object Functions
 * * 2.1 Draw Ground Plane
 * * 2.2 Draw Cube
@@ -24,6 +25,8 @@
 
 
 
+#define GL_GLEXT_PROTOTYPES // Declares the buffer object functions (glGenBuffers, glBufferData, ...)
+
 #ifdef __APPLE_CC__
 #include <GLUT/glut.h>
 #else
@@ -35,6 +38,9 @@
 #include <cmath>        // For sin(), cos(), M_PI - used in camera calculations
 #include <cstdio>       // For printf() - console output
 #include <cstdlib>      // For exit() - program termination
+#include <cstddef>      // For offsetof() - vertex buffer layout
+#include <vector>       // For std::vector - recorded vertex streams
+#include <algorithm>    // For std::stable_sort() - batch draw order
 
 
 GLfloat cameraX = -1.0f;
@@ -52,6 +58,9 @@ GLuint carpetTexture;
 int windowWidth = 800;
 int windowHeight = 600;
 
+bool retainedScene = true;  // Draw the recorded vertex buffers (false: immediate mode every frame)
+GLfloat glassAlpha = 0.5f;  // Window glass opacity; a scene parameter, so changing it re-records the scene
+
 struct Color {
     GLfloat r, g, b;
 };
@@ -81,7 +90,7 @@ Color winColor3 = { 201.0f/255.0f, 206.0f/255.0f, 242.0f/255.0f }; // gray
 Color winColor4 = { 201.0f/255.0f, 242.0f/255.0f, 233.0f/255.0f };
 Color winColor5 = {155.0f/255.0f, 189.0f/255.0f, 181.0f/255.0f};
 
-void setMaterial(GLfloat r, GLfloat g, GLfloat b, GLfloat shininess = 50.0f) {
+void applyMaterial(GLfloat r, GLfloat g, GLfloat b, GLfloat shininess) {
     GLfloat ambient[] = { r * 0.2f, g * 0.2f, b * 0.2f, 1.0f };
     GLfloat diffuse[] = { r, g, b, 1.0f };
     GLfloat specular[] = { 1.0f, 1.0f, 1.0f, 1.0f };
@@ -120,6 +129,338 @@ void setupLighting() {
     glEnable(GL_LIGHT0); // Activate the light source
 }
 
+/**
+ * Retained-Mode Scene
+ * -------------------
+ * Everything in the scene except the camera is static, so the draw functions below go through the rl*
+ * wrappers instead of calling glBegin/glVertex3f/glPushMatrix/... directly. Normally a wrapper just makes
+ * the GL call (immediate mode). While compileScene() runs drawScene() once, the wrappers record instead:
+ * vertices are transformed to world space on the CPU, quads and quad strips are split into triangles, and
+ * every triangle goes into the batch for its render state (material, texture, lighting, blending, color).
+ * The batches are uploaded as vertex buffers, and display() then draws a few dozen buffers per frame
+ * instead of making thousands of immediate-mode calls.
+ *
+ * Draw order: blended geometry (the window glass and curtain overlays) does not write depth, so opaque
+ * geometry drawn after it still covers it. To keep that look, the recording starts a new layer whenever an
+ * opaque triangle follows a blended one, and each layer draws its opaque batches before its blended ones.
+ *
+ * Call invalidateScene() after changing anything drawScene() reads; the next frame records it again.
+ */
+struct RecordedVertex {
+    GLfloat position[3];   // World space
+    GLfloat normal[3];     // World space, unit length
+    GLfloat texCoord[2];
+};
+
+struct RenderState {
+    GLfloat material[4];   // setMaterial() r, g, b, shininess (lit geometry only)
+    GLfloat color[4];      // Current color (unlit geometry only)
+    bool texture2D;        // GL_TEXTURE_2D enabled
+    GLuint texture;        // Bound 2D texture
+    bool lighting;         // GL_LIGHTING enabled
+    bool blend;            // GL_BLEND enabled (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+    bool depthWrite;       // glDepthMask
+};
+
+struct SceneBatch {
+    RenderState state;
+    int layer;                              // Draw order group (see above)
+    std::vector<RecordedVertex> vertices;   // Triangles, freed once uploaded
+    GLuint buffer;                          // Vertex buffer object
+    GLsizei vertexCount;
+};
+
+struct Matrix4 {
+    GLfloat m[16];         // Column major, like OpenGL
+};
+
+struct SceneRecorder {
+    bool recording;                             // Wrappers record instead of drawing
+    RenderState state;                          // Current state
+    std::vector<RenderState> stateStack;        // rlPushAttrib / rlPopAttrib
+    Matrix4 matrix;                             // Current model matrix
+    std::vector<Matrix4> matrixStack;           // rlPushMatrix / rlPopMatrix
+    GLenum primitive;                           // Mode of the open rlBegin
+    std::vector<RecordedVertex> primitiveVertices; // Vertices of the open primitive not emitted yet
+    GLfloat normal[3];                          // Current normal (object space)
+    GLfloat texCoord[2];                        // Current texture coordinate
+    int layer;                                  // Current draw order group
+    bool lastBlended;                           // Last triangle was blended
+    int lastBatch;                              // Batch of the last triangle, -1 for none
+    long replacedCalls;                         // GL calls one immediate-mode frame makes
+};
+
+SceneRecorder recorder;                 // Recording state (recorder.recording is false outside compileScene)
+std::vector<SceneBatch> sceneBatches;   // Recorded scene, in draw order
+bool sceneDirty = true;                 // Record again before the next retained-mode frame
+
+// Points the modelview matrix at the camera (the current matrix must be identity)
+void applyCameraView() {
+    GLfloat lookX = cameraX + cosf(cameraAngleX * M_PI / 180.0f) * sinf(cameraAngleY * M_PI / 180.0f);
+    GLfloat lookY = cameraY + sinf(cameraAngleX * M_PI / 180.0f);
+    GLfloat lookZ = cameraZ - cosf(cameraAngleX * M_PI / 180.0f) * cosf(cameraAngleY * M_PI / 180.0f);
+    gluLookAt(cameraX, cameraY, cameraZ,
+              lookX, lookY, lookZ,
+              0.0f, 1.0f, 0.0f);
+}
+
+Matrix4 identityMatrix() {
+    Matrix4 identity = { { 1.0f, 0.0f, 0.0f, 0.0f,  0.0f, 1.0f, 0.0f, 0.0f,
+                           0.0f, 0.0f, 1.0f, 0.0f,  0.0f, 0.0f, 0.0f, 1.0f } };
+    return identity;
+}
+
+// recorder.matrix = recorder.matrix * other (the order glMultMatrix uses)
+void multiplyRecorderMatrix(const Matrix4& other) {
+    Matrix4 result;
+    for (int col = 0; col < 4; col++) {
+        for (int row = 0; row < 4; row++) {
+            GLfloat sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += recorder.matrix.m[k * 4 + row] * other.m[col * 4 + k];
+            }
+            result.m[col * 4 + row] = sum;
+        }
+    }
+    recorder.matrix = result;
+}
+
+bool sameState(const RenderState& a, const RenderState& b) {
+    for (int i = 0; i < 4; i++) {
+        if (a.material[i] != b.material[i] || a.color[i] != b.color[i]) return false;
+    }
+    return a.texture2D == b.texture2D && a.texture == b.texture && a.lighting == b.lighting &&
+           a.blend == b.blend && a.depthWrite == b.depthWrite;
+}
+
+// The current state with the parts that don't affect the result cleared, so equal-looking triangles share a batch
+RenderState effectiveState() {
+    RenderState s = recorder.state;
+    if (!s.texture2D) s.texture = 0;
+    if (s.lighting) {
+        s.color[0] = s.color[1] = s.color[2] = s.color[3] = 1.0f; // Ignored by fixed-function lighting
+    } else {
+        s.material[0] = s.material[1] = s.material[2] = s.material[3] = 0.0f;
+    }
+    return s;
+}
+
+void emitTriangle(const RecordedVertex& a, const RecordedVertex& b, const RecordedVertex& c) {
+    RenderState s = effectiveState();
+    if (!s.blend && recorder.lastBlended) {
+        recorder.layer++; // Opaque after blended: must draw after it
+    }
+    recorder.lastBlended = s.blend;
+
+    int index = recorder.lastBatch;
+    if (index < 0 || sceneBatches[index].layer != recorder.layer || !sameState(sceneBatches[index].state, s)) {
+        index = -1;
+        for (size_t i = 0; i < sceneBatches.size(); i++) {
+            if (sceneBatches[i].layer == recorder.layer && sameState(sceneBatches[i].state, s)) {
+                index = (int)i;
+                break;
+            }
+        }
+        if (index < 0) {
+            SceneBatch batch;
+            batch.state = s;
+            batch.layer = recorder.layer;
+            batch.buffer = 0;
+            batch.vertexCount = 0;
+            sceneBatches.push_back(batch);
+            index = (int)sceneBatches.size() - 1;
+        }
+        recorder.lastBatch = index;
+    }
+    std::vector<RecordedVertex>& vertices = sceneBatches[index].vertices;
+    vertices.push_back(a);
+    vertices.push_back(b);
+    vertices.push_back(c);
+}
+
+// ******** rl* wrappers: immediate-mode GL calls, recorded while compileScene() runs ******** //
+
+void rlBegin(GLenum mode) {
+    if (!recorder.recording) { glBegin(mode); return; }
+    recorder.replacedCalls++;
+    recorder.primitive = mode; // GL_QUADS, GL_QUAD_STRIP or GL_TRIANGLES
+    recorder.primitiveVertices.clear();
+}
+
+void rlEnd() {
+    if (!recorder.recording) { glEnd(); return; }
+    recorder.replacedCalls++;
+    recorder.primitiveVertices.clear(); // Drop an incomplete quad/triangle, like GL does
+}
+
+void rlNormal3f(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recorder.recording) { glNormal3f(x, y, z); return; }
+    recorder.replacedCalls++;
+    recorder.normal[0] = x;
+    recorder.normal[1] = y;
+    recorder.normal[2] = z;
+}
+
+void rlTexCoord2f(GLfloat s, GLfloat t) {
+    if (!recorder.recording) { glTexCoord2f(s, t); return; }
+    recorder.replacedCalls++;
+    recorder.texCoord[0] = s;
+    recorder.texCoord[1] = t;
+}
+
+void rlVertex3f(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recorder.recording) { glVertex3f(x, y, z); return; }
+    recorder.replacedCalls++;
+    const GLfloat* m = recorder.matrix.m;
+    RecordedVertex v;
+    v.position[0] = m[0] * x + m[4] * y + m[8]  * z + m[12];
+    v.position[1] = m[1] * x + m[5] * y + m[9]  * z + m[13];
+    v.position[2] = m[2] * x + m[6] * y + m[10] * z + m[14];
+
+    // Normals transform by the inverse transpose of the upper 3x3, which is its cofactor matrix up to scale
+    GLfloat c[9] = {
+        m[5] * m[10] - m[6] * m[9],  m[6] * m[8] - m[4] * m[10], m[4] * m[9] - m[5] * m[8],
+        m[2] * m[9]  - m[1] * m[10], m[0] * m[10] - m[2] * m[8], m[1] * m[8] - m[0] * m[9],
+        m[1] * m[6]  - m[2] * m[5],  m[2] * m[4] - m[0] * m[6],  m[0] * m[5] - m[1] * m[4]
+    };
+    const GLfloat* n = recorder.normal;
+    GLfloat nx = c[0] * n[0] + c[3] * n[1] + c[6] * n[2];
+    GLfloat ny = c[1] * n[0] + c[4] * n[1] + c[7] * n[2];
+    GLfloat nz = c[2] * n[0] + c[5] * n[1] + c[8] * n[2];
+    GLfloat length = sqrtf(nx * nx + ny * ny + nz * nz);
+    if (length > 0.0f) {
+        nx /= length; ny /= length; nz /= length; // What GL_NORMALIZE did per frame
+    }
+    v.normal[0] = nx;
+    v.normal[1] = ny;
+    v.normal[2] = nz;
+    v.texCoord[0] = recorder.texCoord[0];
+    v.texCoord[1] = recorder.texCoord[1];
+
+    std::vector<RecordedVertex>& p = recorder.primitiveVertices;
+    p.push_back(v);
+    if (recorder.primitive == GL_QUADS && p.size() == 4) {
+        emitTriangle(p[0], p[1], p[2]);
+        emitTriangle(p[0], p[2], p[3]);
+        p.clear();
+    } else if (recorder.primitive == GL_QUAD_STRIP && p.size() == 4) {
+        emitTriangle(p[0], p[1], p[3]); // Strip quad 0-1-3-2
+        emitTriangle(p[0], p[3], p[2]);
+        p.erase(p.begin(), p.begin() + 2); // Last edge starts the next quad
+    } else if (recorder.primitive == GL_TRIANGLES && p.size() == 3) {
+        emitTriangle(p[0], p[1], p[2]);
+        p.clear();
+    }
+}
+
+void rlPushMatrix() {
+    if (!recorder.recording) { glPushMatrix(); return; }
+    recorder.replacedCalls++;
+    recorder.matrixStack.push_back(recorder.matrix);
+}
+
+void rlPopMatrix() {
+    if (!recorder.recording) { glPopMatrix(); return; }
+    recorder.replacedCalls++;
+    recorder.matrix = recorder.matrixStack.back();
+    recorder.matrixStack.pop_back();
+}
+
+void rlTranslatef(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recorder.recording) { glTranslatef(x, y, z); return; }
+    recorder.replacedCalls++;
+    Matrix4 t = identityMatrix();
+    t.m[12] = x;
+    t.m[13] = y;
+    t.m[14] = z;
+    multiplyRecorderMatrix(t);
+}
+
+void rlScalef(GLfloat x, GLfloat y, GLfloat z) {
+    if (!recorder.recording) { glScalef(x, y, z); return; }
+    recorder.replacedCalls++;
+    Matrix4 s = identityMatrix();
+    s.m[0] = x;
+    s.m[5] = y;
+    s.m[10] = z;
+    multiplyRecorderMatrix(s);
+}
+
+// Replaces the modelview matrix with the camera view alone (recorded as world space, i.e. identity)
+void rlLoadViewMatrix() {
+    if (!recorder.recording) {
+        glLoadIdentity();
+        applyCameraView();
+        return;
+    }
+    recorder.replacedCalls += 2;
+    recorder.matrix = identityMatrix();
+}
+
+void rlEnable(GLenum cap) {
+    if (!recorder.recording) { glEnable(cap); return; }
+    recorder.replacedCalls++;
+    if (cap == GL_LIGHTING) recorder.state.lighting = true;
+    if (cap == GL_TEXTURE_2D) recorder.state.texture2D = true;
+    if (cap == GL_BLEND) recorder.state.blend = true;
+}
+
+void rlDisable(GLenum cap) {
+    if (!recorder.recording) { glDisable(cap); return; }
+    recorder.replacedCalls++;
+    if (cap == GL_LIGHTING) recorder.state.lighting = false;
+    if (cap == GL_TEXTURE_2D) recorder.state.texture2D = false;
+    if (cap == GL_BLEND) recorder.state.blend = false;
+}
+
+void rlBindTexture(GLenum target, GLuint texture) {
+    if (!recorder.recording) { glBindTexture(target, texture); return; }
+    recorder.replacedCalls++;
+    recorder.state.texture = texture;
+}
+
+void rlColor4f(GLfloat r, GLfloat g, GLfloat b, GLfloat a) {
+    if (!recorder.recording) { glColor4f(r, g, b, a); return; }
+    recorder.replacedCalls++;
+    recorder.state.color[0] = r;
+    recorder.state.color[1] = g;
+    recorder.state.color[2] = b;
+    recorder.state.color[3] = a;
+}
+
+void rlColor3f(GLfloat r, GLfloat g, GLfloat b) {
+    rlColor4f(r, g, b, 1.0f);
+}
+
+void rlDepthMask(GLboolean flag) {
+    if (!recorder.recording) { glDepthMask(flag); return; }
+    recorder.replacedCalls++;
+    recorder.state.depthWrite = (flag == GL_TRUE);
+}
+
+// Recording saves the whole state whatever the mask; every push in this file covers what it changes.
+void rlPushAttrib(GLbitfield mask) {
+    if (!recorder.recording) { glPushAttrib(mask); return; }
+    recorder.replacedCalls++;
+    recorder.stateStack.push_back(recorder.state);
+}
+
+void rlPopAttrib() {
+    if (!recorder.recording) { glPopAttrib(); return; }
+    recorder.replacedCalls++;
+    recorder.state = recorder.stateStack.back();
+    recorder.stateStack.pop_back();
+}
+
+void setMaterial(GLfloat r, GLfloat g, GLfloat b, GLfloat shininess = 50.0f) {
+    if (!recorder.recording) { applyMaterial(r, g, b, shininess); return; }
+    recorder.replacedCalls += 4;
+    recorder.state.material[0] = r;
+    recorder.state.material[1] = g;
+    recorder.state.material[2] = b;
+    recorder.state.material[3] = shininess;
+}
+
 void drawBitmapText(const char* text, GLfloat x, GLfloat y, void* font = GLUT_BITMAP_HELVETICA_18) {
     glRasterPos2f(x, y);
     for (const char* c = text; *c != '\0'; ++c) {
@@ -172,8 +513,8 @@ void drawGroundPlane(GLfloat minX, GLfloat maxX, GLfloat y, GLfloat minZ, GLfloa
     GLfloat stepX = (maxX - minX) / divisions;
     GLfloat stepZ = (maxZ - minZ) / divisions;
 
-    glBegin(GL_QUADS);
-    glNormal3f(0.0f, 1.0f, 0.0f);
+    rlBegin(GL_QUADS);
+    rlNormal3f(0.0f, 1.0f, 0.0f);
 
     for (int i = 0; i < divisions; i++) {
         for (int j = 0; j < divisions; j++) {
@@ -186,18 +527,18 @@ void drawGroundPlane(GLfloat minX, GLfloat maxX, GLfloat y, GLfloat minZ, GLfloa
                 setMaterial(0.2f, 0.2f, 0.2f, 10.0f);  // Dark gray
             }
 
-            glVertex3f(x,         y, z);
-            glVertex3f(x + stepX, y, z);
-            glVertex3f(x + stepX, y, z + stepZ);
-            glVertex3f(x,         y, z + stepZ);
+            rlVertex3f(x,         y, z);
+            rlVertex3f(x + stepX, y, z);
+            rlVertex3f(x + stepX, y, z + stepZ);
+            rlVertex3f(x,         y, z + stepZ);
         }
     }
-    glEnd();
+    rlEnd();
 }
 
 void drawCube(GLfloat size) {
     GLfloat half = size / 2.0f;  // Half-size for centering at origin
-    glBegin(GL_QUADS);
+    rlBegin(GL_QUADS);
 
     /**
      * FRONT FACE (Z = +half)
@@ -205,67 +546,67 @@ void drawCube(GLfloat size) {
      * This face is toward the viewer (positive Z direction).
      * Normal points outward: (0, 0, 1)
      */
-    glNormal3f(0.0f, 0.0f, 1.0f);           // Normal points toward viewer
-    glVertex3f(-half, -half,  half);         // Bottom-left
-    glVertex3f( half, -half,  half);         // Bottom-right
-    glVertex3f( half,  half,  half);         // Top-right
-    glVertex3f(-half,  half,  half);         // Top-left
+    rlNormal3f(0.0f, 0.0f, 1.0f);           // Normal points toward viewer
+    rlVertex3f(-half, -half,  half);         // Bottom-left
+    rlVertex3f( half, -half,  half);         // Bottom-right
+    rlVertex3f( half,  half,  half);         // Top-right
+    rlVertex3f(-half,  half,  half);         // Top-left
 
     /**
      * BACK FACE (Z = -half)
      * Normal points outward (away from viewer): (0, 0, -1)
      */
-    glNormal3f(0.0f, 0.0f, -1.0f);
-    glVertex3f(-half, -half, -half);
-    glVertex3f(-half,  half, -half);
-    glVertex3f( half,  half, -half);
-    glVertex3f( half, -half, -half);
+    rlNormal3f(0.0f, 0.0f, -1.0f);
+    rlVertex3f(-half, -half, -half);
+    rlVertex3f(-half,  half, -half);
+    rlVertex3f( half,  half, -half);
+    rlVertex3f( half, -half, -half);
 
     /**
      * TOP FACE (Y = +half)
      * --------------------
      * Normal points upward: (0, 1, 0)
      */
-    glNormal3f(0.0f, 1.0f, 0.0f);
-    glVertex3f(-half,  half, -half);
-    glVertex3f(-half,  half,  half);
-    glVertex3f( half,  half,  half);
-    glVertex3f( half,  half, -half);
+    rlNormal3f(0.0f, 1.0f, 0.0f);
+    rlVertex3f(-half,  half, -half);
+    rlVertex3f(-half,  half,  half);
+    rlVertex3f( half,  half,  half);
+    rlVertex3f( half,  half, -half);
 
     /**
      * BOTTOM FACE (Y = -half)
      * -----------------------
      * Normal points downward: (0, -1, 0)
      */
-    glNormal3f(0.0f, -1.0f, 0.0f);
-    glVertex3f(-half, -half, -half);
-    glVertex3f( half, -half, -half);
-    glVertex3f( half, -half,  half);
-    glVertex3f(-half, -half,  half);
+    rlNormal3f(0.0f, -1.0f, 0.0f);
+    rlVertex3f(-half, -half, -half);
+    rlVertex3f( half, -half, -half);
+    rlVertex3f( half, -half,  half);
+    rlVertex3f(-half, -half,  half);
 
     /**
      * RIGHT FACE (X = +half)
      * ----------------------
      * Normal points right: (1, 0, 0)
      */
-    glNormal3f(1.0f, 0.0f, 0.0f);
-    glVertex3f( half, -half, -half);
-    glVertex3f( half,  half, -half);
-    glVertex3f( half,  half,  half);
-    glVertex3f( half, -half,  half);
+    rlNormal3f(1.0f, 0.0f, 0.0f);
+    rlVertex3f( half, -half, -half);
+    rlVertex3f( half,  half, -half);
+    rlVertex3f( half,  half,  half);
+    rlVertex3f( half, -half,  half);
 
     /**
      * LEFT FACE (X = -half)
      * ---------------------
      * Normal points left: (-1, 0, 0)
      */
-    glNormal3f(-1.0f, 0.0f, 0.0f);
-    glVertex3f(-half, -half, -half);
-    glVertex3f(-half, -half,  half);
-    glVertex3f(-half,  half,  half);
-    glVertex3f(-half,  half, -half);
+    rlNormal3f(-1.0f, 0.0f, 0.0f);
+    rlVertex3f(-half, -half, -half);
+    rlVertex3f(-half, -half,  half);
+    rlVertex3f(-half,  half,  half);
+    rlVertex3f(-half,  half, -half);
 
-    glEnd();
+    rlEnd();
 }
 
 void drawWindowFrame(GLfloat centerX, GLfloat centerY, GLfloat frontFaceZ,
@@ -289,43 +630,43 @@ void drawWindowFrame(GLfloat centerX, GLfloat centerY, GLfloat frontFaceZ,
 
     if (drawLeftBorder) {
         // Left vertical bar
-        glPushMatrix();
-            glTranslatef(centerX - halfW + borderThickness * 0.5f, centerY, centerZ);
-            glScalef(borderThickness, frameHeight, frameDepth);
+        rlPushMatrix();
+            rlTranslatef(centerX - halfW + borderThickness * 0.5f, centerY, centerZ);
+            rlScalef(borderThickness, frameHeight, frameDepth);
             drawCube(1.0f);
-        glPopMatrix();
+        rlPopMatrix();
     }
 
     if (drawRightBorder) {
         // Right vertical bar
-        glPushMatrix();
-            glTranslatef(centerX + halfW - borderThickness * 0.5f, centerY, centerZ);
-            glScalef(borderThickness, frameHeight, frameDepth);
+        rlPushMatrix();
+            rlTranslatef(centerX + halfW - borderThickness * 0.5f, centerY, centerZ);
+            rlScalef(borderThickness, frameHeight, frameDepth);
             drawCube(1.0f);
-        glPopMatrix();
+        rlPopMatrix();
     }
 
     // Top horizontal bar
-    glPushMatrix();
-        glTranslatef(centerX, centerY + halfH - borderThickness * 0.5f, centerZ);
-        glScalef(frameWidth, borderThickness, frameDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY + halfH - borderThickness * 0.5f, centerZ);
+        rlScalef(frameWidth, borderThickness, frameDepth);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Bottom horizontal bar
-    glPushMatrix();
-        glTranslatef(centerX, centerY - halfH + borderThickness * 0.5f, centerZ);
-        glScalef(frameWidth, borderThickness, frameDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY - halfH + borderThickness * 0.5f, centerZ);
+        rlScalef(frameWidth, borderThickness, frameDepth);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     if (includeMiddleSection) {
         // Center divider (gives the two-panel frame look)
-        glPushMatrix();
-            glTranslatef(centerX, centerY, centerZ);
-            glScalef(dividerThickness, innerHeight, frameDepth);
+        rlPushMatrix();
+            rlTranslatef(centerX, centerY, centerZ);
+            rlScalef(dividerThickness, innerHeight, frameDepth);
             drawCube(1.0f);
-        glPopMatrix();
+        rlPopMatrix();
     }
 }
 
@@ -339,21 +680,21 @@ void drawWindowTextureOverlay(GLfloat centerX, GLfloat centerY, GLfloat frontFac
     GLfloat halfH = frameHeight * 0.5f;
     GLfloat overlayZ = frontFaceZ + frameDepth + forwardOffset;
 
-    glPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
+    rlPushAttrib(GL_ENABLE_BIT | GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT |
                  GL_CURRENT_BIT | GL_TEXTURE_BIT | GL_LIGHTING_BIT);
 
-    glDisable(GL_LIGHTING);
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, windowTexture);
+    rlDisable(GL_LIGHTING);
+    rlEnable(GL_TEXTURE_2D);
+    rlBindTexture(GL_TEXTURE_2D, windowTexture);
     glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
 
-    glEnable(GL_BLEND);
+    rlEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     // Keep depth testing on so the pane still respects occluders,
     // but do not write depth for this transparent pass.
-    glDepthMask(GL_FALSE);
-    glColor4f(1.0f, 1.0f, 1.0f, alpha);
+    rlDepthMask(GL_FALSE);
+    rlColor4f(1.0f, 1.0f, 1.0f, alpha);
 
     GLfloat texScale = 1.0f;
     GLfloat texU = (halfW * 2.0f) / texScale;
@@ -361,17 +702,17 @@ void drawWindowTextureOverlay(GLfloat centerX, GLfloat centerY, GLfloat frontFac
     GLfloat texVTopScaled = texVTop * texV;
     GLfloat texVBottomScaled = texVBottom * texV;
 
-    glBegin(GL_QUADS);
-        glNormal3f(0.0f, 0.0f, 1.0f);
-        glTexCoord2f(0.0f, texVTopScaled);    glVertex3f(centerX - halfW, centerY + halfH, overlayZ);
-        glTexCoord2f(texU,  texVTopScaled);    glVertex3f(centerX + halfW, centerY + halfH, overlayZ);
-        glTexCoord2f(texU,  texVBottomScaled); glVertex3f(centerX + halfW, centerY - halfH, overlayZ);
-        glTexCoord2f(0.0f, texVBottomScaled); glVertex3f(centerX - halfW, centerY - halfH, overlayZ);
-    glEnd();
-
-    glDepthMask(GL_TRUE);
-    glBindTexture(GL_TEXTURE_2D, 0);
-    glPopAttrib();
+    rlBegin(GL_QUADS);
+        rlNormal3f(0.0f, 0.0f, 1.0f);
+        rlTexCoord2f(0.0f, texVTopScaled);    rlVertex3f(centerX - halfW, centerY + halfH, overlayZ);
+        rlTexCoord2f(texU,  texVTopScaled);    rlVertex3f(centerX + halfW, centerY + halfH, overlayZ);
+        rlTexCoord2f(texU,  texVBottomScaled); rlVertex3f(centerX + halfW, centerY - halfH, overlayZ);
+        rlTexCoord2f(0.0f, texVBottomScaled); rlVertex3f(centerX - halfW, centerY - halfH, overlayZ);
+    rlEnd();
+
+    rlDepthMask(GL_TRUE);
+    rlBindTexture(GL_TEXTURE_2D, 0);
+    rlPopAttrib();
 }
 
 void drawCurtainSegment(GLfloat leftX, GLfloat width,
@@ -390,12 +731,12 @@ void drawCurtainSegment(GLfloat leftX, GLfloat width,
     GLfloat centerY = topY - height * 0.5f; // Top-aligned curtains: varying heights drop downward.
 
     // Main curtain panel in dark gray, slightly darker than the frame metal color.
-    glPushMatrix();
-        glTranslatef(centerX, centerY, centerZ);
-        glScalef(width, height, depth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY, centerZ);
+        rlScalef(width, height, depth);
         setMaterial(90.0f/255.0f, 94.0f/255.0f, 98.0f/255.0f, 30.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     GLfloat bandHeight = bottomBandHeight;
     if (bandHeight > height) {
@@ -412,12 +753,12 @@ void drawCurtainSegment(GLfloat leftX, GLfloat width,
     }
     // This intentionally leaves a gap between the main curtain and the lower band.
     GLfloat bandCenterY = clampedBandBottomY + bandHeight * 0.5f;
-    glPushMatrix();
-        glTranslatef(centerX, bandCenterY, centerZ + 0.01f);
-        glScalef(width, bandHeight, depth);
+    rlPushMatrix();
+        rlTranslatef(centerX, bandCenterY, centerZ + 0.01f);
+        rlScalef(width, bandHeight, depth);
         setMaterial(90.0f/255.0f, 94.0f/255.0f, 98.0f/255.0f, 30.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Map both curtain planes into one shared V range so the texture continues downward.
     GLfloat mainTopY = centerY + height * 0.5f;
@@ -469,18 +810,18 @@ void drawSphere(GLfloat cx, GLfloat cy, GLfloat cz,
         GLfloat r0 = cosf(lat0);
         GLfloat r1 = cosf(lat1);
 
-        glBegin(GL_QUAD_STRIP);
+        rlBegin(GL_QUAD_STRIP);
         for (int j = 0; j <= slices; j++) {
             GLfloat lng = 2.0f * M_PI * j / slices;
             GLfloat lx = cosf(lng);
             GLfloat lz = sinf(lng);
 
-            glNormal3f(lx * r0, y0, lz * r0);
-            glVertex3f(cx + r * lx * r0, cy + r * y0, cz + r * lz * r0);
-            glNormal3f(lx * r1, y1, lz * r1);
-            glVertex3f(cx + r * lx * r1, cy + r * y1, cz + r * lz * r1);
+            rlNormal3f(lx * r0, y0, lz * r0);
+            rlVertex3f(cx + r * lx * r0, cy + r * y0, cz + r * lz * r0);
+            rlNormal3f(lx * r1, y1, lz * r1);
+            rlVertex3f(cx + r * lx * r1, cy + r * y1, cz + r * lz * r1);
         }
-        glEnd();
+        rlEnd();
     }
 }
 
@@ -520,75 +861,75 @@ void drawElectricalOutlet(GLfloat centerX, GLfloat centerY, GLfloat wallFrontZ)
     GLfloat detailDepth = 0.01f;
 
     // Outer wall plate.
-    glPushMatrix();
-        glTranslatef(centerX, centerY, wallFrontZ + plateDepth * 0.5f);
-        glScalef(plateWidth, plateHeight, plateDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY, wallFrontZ + plateDepth * 0.5f);
+        rlScalef(plateWidth, plateHeight, plateDepth);
         setMaterial(0.90f, 0.89f, 0.85f, 30.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Inner raised face.
-    glPushMatrix();
-        glTranslatef(centerX, centerY, wallFrontZ + plateDepth + insetDepth * 0.5f);
-        glScalef(insetWidth, insetHeight, insetDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY, wallFrontZ + plateDepth + insetDepth * 0.5f);
+        rlScalef(insetWidth, insetHeight, insetDepth);
         setMaterial(0.95f, 0.94f, 0.90f, 20.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Top and bottom screws.
-    glPushMatrix();
-        glTranslatef(centerX, centerY + 0.32f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.05f, 0.05f, detailDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY + 0.32f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.05f, 0.05f, detailDepth);
         setMaterial(0.45f, 0.45f, 0.45f, 60.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
-    glPushMatrix();
-        glTranslatef(centerX, centerY - 0.32f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.05f, 0.05f, detailDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY - 0.32f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.05f, 0.05f, detailDepth);
         setMaterial(0.45f, 0.45f, 0.45f, 60.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Upper receptacle slots.
-    glPushMatrix();
-        glTranslatef(centerX - 0.08f, centerY + 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.03f, 0.14f, detailDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX - 0.08f, centerY + 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.03f, 0.14f, detailDepth);
         setMaterial(0.08f, 0.08f, 0.08f, 5.0f);
         drawCube(1.0f);
-    glPopMatrix();
-    glPushMatrix();
-        glTranslatef(centerX + 0.08f, centerY + 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.03f, 0.14f, detailDepth);
+    rlPopMatrix();
+    rlPushMatrix();
+        rlTranslatef(centerX + 0.08f, centerY + 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.03f, 0.14f, detailDepth);
         setMaterial(0.08f, 0.08f, 0.08f, 5.0f);
         drawCube(1.0f);
-    glPopMatrix();
-    glPushMatrix();
-        glTranslatef(centerX, centerY + 0.08f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.07f, 0.05f, detailDepth);
+    rlPopMatrix();
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY + 0.08f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.07f, 0.05f, detailDepth);
         setMaterial(0.08f, 0.08f, 0.08f, 5.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Lower receptacle slots.
-    glPushMatrix();
-        glTranslatef(centerX - 0.08f, centerY - 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.03f, 0.14f, detailDepth);
+    rlPushMatrix();
+        rlTranslatef(centerX - 0.08f, centerY - 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.03f, 0.14f, detailDepth);
         setMaterial(0.08f, 0.08f, 0.08f, 5.0f);
         drawCube(1.0f);
-    glPopMatrix();
-    glPushMatrix();
-        glTranslatef(centerX + 0.08f, centerY - 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.03f, 0.14f, detailDepth);
+    rlPopMatrix();
+    rlPushMatrix();
+        rlTranslatef(centerX + 0.08f, centerY - 0.16f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.03f, 0.14f, detailDepth);
         setMaterial(0.08f, 0.08f, 0.08f, 5.0f);
         drawCube(1.0f);
-    glPopMatrix();
-    glPushMatrix();
-        glTranslatef(centerX, centerY - 0.24f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
-        glScalef(0.07f, 0.05f, detailDepth);
+    rlPopMatrix();
+    rlPushMatrix();
+        rlTranslatef(centerX, centerY - 0.24f, wallFrontZ + plateDepth + insetDepth + detailDepth * 0.5f);
+        rlScalef(0.07f, 0.05f, detailDepth);
         setMaterial(0.08f, 0.08f, 0.08f, 5.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 }
 
 void drawWindows(int rows, int cols,
@@ -628,15 +969,9 @@ void drawWindows(int rows, int cols,
     // Slightly in front of the building face to avoid z-fighting
     GLfloat frontZ = buildingZ + buildingD + 0.01f;
 
-    glPushMatrix();
-    glLoadIdentity();
+    rlPushMatrix();
     // Reapply the view matrix (camera) but no building scale
-    GLfloat lookX = cameraX + cosf(cameraAngleX * M_PI / 180.0f) * sinf(cameraAngleY * M_PI / 180.0f);
-    GLfloat lookY = cameraY + sinf(cameraAngleX * M_PI / 180.0f);
-    GLfloat lookZ = cameraZ - cosf(cameraAngleX * M_PI / 180.0f) * cosf(cameraAngleY * M_PI / 180.0f);
-    gluLookAt(cameraX, cameraY, cameraZ,
-              lookX, lookY, lookZ,
-              0.0f, 1.0f, 0.0f);
+    rlLoadViewMatrix();
 
     // Default style if none provided: solid blue
     WindowStyle defaultStyle = { 0.3f, 0.5f, 0.8f, 1.0f, 0.3f, 0.5f, 0.8f };
@@ -645,11 +980,11 @@ void drawWindows(int rows, int cols,
         styleCount = 1;
     }
 
-    glEnable(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, windowTexture);
+    rlEnable(GL_TEXTURE_2D);
+    rlBindTexture(GL_TEXTURE_2D, windowTexture);
 
-    glBegin(GL_QUADS);
-    glNormal3f(0.0f, 0.0f, 1.0f);
+    rlBegin(GL_QUADS);
+    rlNormal3f(0.0f, 0.0f, 1.0f);
 
     int windowIndex = 0;
     for (int r = 0; r < rows; r++) {
@@ -674,25 +1009,25 @@ void drawWindows(int rows, int cols,
 
             // Top section
             setMaterial(s.r, s.g, s.b, 80.0f);
-            glTexCoord2f(0.0f, texVSplit); glVertex3f(x1, ySplit, frontZ);
-            glTexCoord2f(texU, texVSplit); glVertex3f(x2, ySplit, frontZ);
-            glTexCoord2f(texU, 0.0f);     glVertex3f(x2, y2, frontZ);
-            glTexCoord2f(0.0f, 0.0f);     glVertex3f(x1, y2, frontZ);
+            rlTexCoord2f(0.0f, texVSplit); rlVertex3f(x1, ySplit, frontZ);
+            rlTexCoord2f(texU, texVSplit); rlVertex3f(x2, ySplit, frontZ);
+            rlTexCoord2f(texU, 0.0f);     rlVertex3f(x2, y2, frontZ);
+            rlTexCoord2f(0.0f, 0.0f);     rlVertex3f(x1, y2, frontZ);
 
             // Bottom section (only if there is a split)
             if (s.splitRatio < 1.0f) {
                 setMaterial(s.r2, s.g2, s.b2, 80.0f);
-                glTexCoord2f(0.0f, texV);      glVertex3f(x1, y1, frontZ);
-                glTexCoord2f(texU, texV);      glVertex3f(x2, y1, frontZ);
-                glTexCoord2f(texU, texVSplit); glVertex3f(x2, ySplit, frontZ);
-                glTexCoord2f(0.0f, texVSplit); glVertex3f(x1, ySplit, frontZ);
+                rlTexCoord2f(0.0f, texV);      rlVertex3f(x1, y1, frontZ);
+                rlTexCoord2f(texU, texV);      rlVertex3f(x2, y1, frontZ);
+                rlTexCoord2f(texU, texVSplit); rlVertex3f(x2, ySplit, frontZ);
+                rlTexCoord2f(0.0f, texVSplit); rlVertex3f(x1, ySplit, frontZ);
             }
         }
     }
-    glEnd();
+    rlEnd();
 
-    glDisable(GL_TEXTURE_2D);
-    glPopMatrix();
+    rlDisable(GL_TEXTURE_2D);
+    rlPopMatrix();
 }
 
 void drawBuilding(GLfloat posX, GLfloat posY, GLfloat posZ)
@@ -706,12 +1041,12 @@ void drawBuilding(GLfloat posX, GLfloat posY, GLfloat posZ)
     GLfloat buildingD = halfCube * sz;
 
     // ******** Building ******** //
-    glPushMatrix();
-        glTranslatef(posX, posY, posZ);
-        glScalef(sx, sy, sz);
+    rlPushMatrix();
+        rlTranslatef(posX, posY, posZ);
+        rlScalef(sx, sy, sz);
         setMaterial(255/255.0f, 245/255.0f, 227/255.0f);
         drawCube(cubeSize);
-    glPopMatrix();
+    rlPopMatrix();
 
     // ******** Windows ******** //
     WindowStyle row1Styles[] = {
@@ -765,20 +1100,20 @@ void drawBuilding(GLfloat posX, GLfloat posY, GLfloat posZ)
     GLfloat buildingTopY = posY + buildingH;
 
     // First roof layer (flush with building top)
-    glPushMatrix();
-        glTranslatef(posX, buildingTopY + halfCube * 0.15f, posZ);
-        glScalef(12.0f, 0.15f, 4.0f);
+    rlPushMatrix();
+        rlTranslatef(posX, buildingTopY + halfCube * 0.15f, posZ);
+        rlScalef(12.0f, 0.15f, 4.0f);
         setMaterial(255/255.0f, 245/255.0f, 227/255.0f);
         drawCube(cubeSize);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Second roof layer (trim band on top)
-    glPushMatrix();
-        glTranslatef(posX, buildingTopY + 0.25f + halfCube * 0.15f, posZ);
-        glScalef(12.0f, 0.15f, 4.0f);
+    rlPushMatrix();
+        rlTranslatef(posX, buildingTopY + 0.25f + halfCube * 0.15f, posZ);
+        rlScalef(12.0f, 0.15f, 4.0f);
         setMaterial(65/255.0f, 65/255.0f, 65/255.0f);
         drawCube(cubeSize);
-    glPopMatrix();
+    rlPopMatrix();
 }
 
 void drawScene()
@@ -839,7 +1174,6 @@ void drawScene()
     GLfloat frameRowRightEdgeX = frameRightEdges[frameCount - 1];
     GLfloat frameRowWidth = frameRowRightEdgeX - frameRowLeftEdgeX; // 5.5 * standard width
 
-    GLfloat glassAlpha = 0.5f;
     GLfloat glassForwardOffset = 0.02f;
     for (int i = 0; i < frameCount; ++i) {
         // Seam de-duplication (Option B): shared boundaries are emitted once via right borders.
@@ -994,12 +1328,12 @@ void drawScene()
     GLfloat wallSectionCenterY = wallSectionBottomY + wallSectionHeight * 0.5f;
     GLfloat wallSectionCenterZ = (frameFrontFaceZ - 0.01f) + frameDepth * 0.5f;
 
-    glPushMatrix();
-        glTranslatef(wallSectionCenterX, wallSectionCenterY, wallSectionCenterZ);
-        glScalef(wallSectionWidth, wallSectionHeight, frameDepth); // Same depth as frame thickness.
+    rlPushMatrix();
+        rlTranslatef(wallSectionCenterX, wallSectionCenterY, wallSectionCenterZ);
+        rlScalef(wallSectionWidth, wallSectionHeight, frameDepth); // Same depth as frame thickness.
         setMaterial(225.0f/255.0f, 184.0f/255.0f, 142.0f/255.0f); // Warm orange-beige wall color from reference.
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Rubber baseboard at the bottom of the lower wall: curtain color, full wall width,
     // and slightly protruding forward from the wall face.
@@ -1009,12 +1343,12 @@ void drawScene()
     GLfloat baseboardCenterY = wallSectionBottomY + baseboardHeight * 0.5f;
     GLfloat baseboardCenterZ = wallSectionCenterZ + baseboardProtrude * 0.5f;
 
-    glPushMatrix();
-        glTranslatef(wallSectionCenterX, baseboardCenterY, baseboardCenterZ);
-        glScalef(wallSectionWidth, baseboardHeight, baseboardDepth);
+    rlPushMatrix();
+        rlTranslatef(wallSectionCenterX, baseboardCenterY, baseboardCenterZ);
+        rlScalef(wallSectionWidth, baseboardHeight, baseboardDepth);
         setMaterial(90.0f/255.0f, 94.0f/255.0f, 98.0f/255.0f, 20.0f);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Surrounding shell: two side walls, one back wall, floor, and ceiling.
     // Side-wall span uses half the lower wall width; back wall uses full lower wall width.
@@ -1043,40 +1377,40 @@ void drawScene()
     }
 
     // Left side wall
-    glPushMatrix();
-        glTranslatef(wallSectionLeftX + shellThickness * 0.5f,
+    rlPushMatrix();
+        rlTranslatef(wallSectionLeftX + shellThickness * 0.5f,
                      shellCenterY,
                      wallSectionCenterZ + sideWallSpan * 0.5f);
-        glScalef(shellThickness, shellHeight, sideWallSpan);
+        rlScalef(shellThickness, shellHeight, sideWallSpan);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Right side wall
-    glPushMatrix();
-        glTranslatef(wallSectionRightX - shellThickness * 0.5f,
+    rlPushMatrix();
+        rlTranslatef(wallSectionRightX - shellThickness * 0.5f,
                      shellCenterY,
                      wallSectionCenterZ + sideWallSpan * 0.5f);
-        glScalef(shellThickness, shellHeight, sideWallSpan);
+        rlScalef(shellThickness, shellHeight, sideWallSpan);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Back wall
-    glPushMatrix();
-        glTranslatef(wallSectionCenterX,
+    rlPushMatrix();
+        rlTranslatef(wallSectionCenterX,
                      shellCenterY,
                      wallSectionCenterZ + sideWallSpan);
-        glScalef(backWallWidth, shellHeight, shellThickness);
+        rlScalef(backWallWidth, shellHeight, shellThickness);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Floor
-    glPushMatrix();
-        glTranslatef(wallSectionCenterX,
+    rlPushMatrix();
+        rlTranslatef(wallSectionCenterX,
                      shellBottomY + shellThickness * 0.5f,
                      wallSectionCenterZ + sideWallSpan * 0.5f);
-        glScalef(backWallWidth, shellThickness, sideWallSpan);
+        rlScalef(backWallWidth, shellThickness, sideWallSpan);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Carpet texture on the floor top, tiled so it repeats instead of stretching.
     if (carpetTexture != 0) {
@@ -1090,33 +1424,33 @@ void drawScene()
         GLfloat tileU = backWallWidth / carpetTileWorldSize;
         GLfloat tileV = sideWallSpan / carpetTileWorldSize;
 
-        glPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT);
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, carpetTexture);
+        rlPushAttrib(GL_ENABLE_BIT | GL_TEXTURE_BIT | GL_CURRENT_BIT | GL_LIGHTING_BIT);
+        rlEnable(GL_TEXTURE_2D);
+        rlBindTexture(GL_TEXTURE_2D, carpetTexture);
         glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
         setMaterial(0.68f, 0.68f, 0.68f, 8.0f);
-        glColor3f(1.0f, 1.0f, 1.0f);
-
-        glBegin(GL_QUADS);
-            glNormal3f(0.0f, 1.0f, 0.0f);
-            glTexCoord2f(0.0f, 0.0f);  glVertex3f(floorLeftX,  floorTopY, floorNearZ);
-            glTexCoord2f(tileU, 0.0f); glVertex3f(floorRightX, floorTopY, floorNearZ);
-            glTexCoord2f(tileU, tileV);glVertex3f(floorRightX, floorTopY, floorFarZ);
-            glTexCoord2f(0.0f, tileV); glVertex3f(floorLeftX,  floorTopY, floorFarZ);
-        glEnd();
-
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glPopAttrib();
+        rlColor3f(1.0f, 1.0f, 1.0f);
+
+        rlBegin(GL_QUADS);
+            rlNormal3f(0.0f, 1.0f, 0.0f);
+            rlTexCoord2f(0.0f, 0.0f);  rlVertex3f(floorLeftX,  floorTopY, floorNearZ);
+            rlTexCoord2f(tileU, 0.0f); rlVertex3f(floorRightX, floorTopY, floorNearZ);
+            rlTexCoord2f(tileU, tileV);rlVertex3f(floorRightX, floorTopY, floorFarZ);
+            rlTexCoord2f(0.0f, tileV); rlVertex3f(floorLeftX,  floorTopY, floorFarZ);
+        rlEnd();
+
+        rlBindTexture(GL_TEXTURE_2D, 0);
+        rlPopAttrib();
     }
 
     // Ceiling
-    glPushMatrix();
-        glTranslatef(wallSectionCenterX,
+    rlPushMatrix();
+        rlTranslatef(wallSectionCenterX,
                      shellTopY - shellThickness * 0.5f,
                      wallSectionCenterZ + sideWallSpan * 0.5f);
-        glScalef(backWallWidth, shellThickness, sideWallSpan);
+        rlScalef(backWallWidth, shellThickness, sideWallSpan);
         drawCube(1.0f);
-    glPopMatrix();
+    rlPopMatrix();
 
     // Wall outlet positioned low on the wall like the reference image.
     GLfloat wallFrontZ = wallSectionCenterZ + frameDepth * 0.5f;
@@ -1130,6 +1464,106 @@ void drawScene()
 
 }
 
+// ******** Retained-mode scene: record, upload, draw ******** //
+
+void releaseScene() {
+    for (size_t i = 0; i < sceneBatches.size(); i++) {
+        if (sceneBatches[i].buffer != 0) glDeleteBuffers(1, &sceneBatches[i].buffer);
+    }
+    sceneBatches.clear();
+}
+
+// Marks the recorded scene stale; display() records it again before the next retained-mode frame
+void invalidateScene() {
+    sceneDirty = true;
+}
+
+bool batchDrawsBefore(const SceneBatch& a, const SceneBatch& b) {
+    if (a.layer != b.layer) return a.layer < b.layer;
+    return !a.state.blend && b.state.blend;
+}
+
+// Runs drawScene() once into per-state vertex streams and uploads each as a vertex buffer
+void compileScene() {
+    releaseScene();
+
+    recorder = SceneRecorder();
+    recorder.recording = true;
+    recorder.matrix = identityMatrix(); // World space
+    RenderState initial = { { 0.8f, 0.8f, 0.8f, 0.0f }, { 1.0f, 1.0f, 1.0f, 1.0f }, false, 0, true, false, true }; // As setupLighting() leaves it
+    recorder.state = initial;
+    recorder.normal[0] = 0.0f; recorder.normal[1] = 0.0f; recorder.normal[2] = 1.0f;
+    recorder.texCoord[0] = 0.0f; recorder.texCoord[1] = 0.0f;
+    recorder.lastBatch = -1;
+    drawScene();
+    recorder.recording = false;
+
+    std::stable_sort(sceneBatches.begin(), sceneBatches.end(), batchDrawsBefore);
+
+    long triangles = 0;
+    for (size_t i = 0; i < sceneBatches.size(); i++) {
+        SceneBatch& batch = sceneBatches[i];
+        batch.vertexCount = (GLsizei)batch.vertices.size();
+        triangles += batch.vertexCount / 3;
+        glGenBuffers(1, &batch.buffer);
+        glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+        glBufferData(GL_ARRAY_BUFFER, batch.vertices.size() * sizeof(RecordedVertex), &batch.vertices[0], GL_STATIC_DRAW);
+        std::vector<RecordedVertex>().swap(batch.vertices); // The GPU copy is all that's needed
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    sceneDirty = false;
+
+    printf("Scene recorded: %ld immediate-mode calls per frame -> %d buffer draws (%ld triangles)\n",
+           recorder.replacedCalls, (int)sceneBatches.size(), triangles);
+}
+
+void drawRecordedScene() {
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_NORMAL_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    for (size_t i = 0; i < sceneBatches.size(); i++) {
+        const SceneBatch& batch = sceneBatches[i];
+        const RenderState& s = batch.state;
+
+        if (s.lighting) {
+            glEnable(GL_LIGHTING);
+            applyMaterial(s.material[0], s.material[1], s.material[2], s.material[3]);
+        } else {
+            glDisable(GL_LIGHTING);
+            glColor4fv(s.color);
+        }
+        if (s.texture != 0) {
+            glEnable(GL_TEXTURE_2D);
+            glBindTexture(GL_TEXTURE_2D, s.texture);
+        } else {
+            glDisable(GL_TEXTURE_2D);
+        }
+        if (s.blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+        glDepthMask(s.depthWrite ? GL_TRUE : GL_FALSE);
+
+        glBindBuffer(GL_ARRAY_BUFFER, batch.buffer);
+        glVertexPointer(3, GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof(RecordedVertex, position));
+        glNormalPointer(GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof(RecordedVertex, normal));
+        glTexCoordPointer(2, GL_FLOAT, sizeof(RecordedVertex), (const GLvoid*)offsetof(RecordedVertex, texCoord));
+        glDrawArrays(GL_TRIANGLES, 0, batch.vertexCount);
+    }
+
+    // Leave the state the immediate-mode path expects
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glDisableClientState(GL_NORMAL_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnable(GL_LIGHTING);
+    glDisable(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_BLEND);
+    glDepthMask(GL_TRUE);
+    glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
 void display() 
 {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -1137,15 +1571,17 @@ void display()
     glMatrixMode(GL_MODELVIEW);
     glLoadIdentity();
     // Camera Look Direction Calculation
-    GLfloat lookX = cameraX + cosf(cameraAngleX * M_PI / 180.0f) * sinf(cameraAngleY * M_PI / 180.0f);
-    GLfloat lookY = cameraY + sinf(cameraAngleX * M_PI / 180.0f);
-    GLfloat lookZ = cameraZ - cosf(cameraAngleX * M_PI / 180.0f) * cosf(cameraAngleY * M_PI / 180.0f);
-    gluLookAt(cameraX, cameraY, cameraZ,
-              lookX, lookY, lookZ,
-              0.0f, 1.0f, 0.0f);
+    applyCameraView();
 
     setupLighting();
-    drawScene();
+    if (retainedScene) {
+        if (sceneDirty) {
+            compileScene(); // First frame, or a scene parameter changed
+        }
+        drawRecordedScene(); // Only the camera changes per frame
+    } else {
+        drawScene();
+    }
     //drawCameraCoordinatesOverlay();
     glutSwapBuffers();
 }
@@ -1201,6 +1637,25 @@ void keyboard(unsigned char key, int x, int y)
             cameraY -= MOVE_SPEED;
             break;
 
+        // toggle retained mode (recorded vertex buffers) / immediate mode
+        case 'i':
+        case 'I':
+            retainedScene = !retainedScene;
+            printf("Scene: %s\n", retainedScene ? "retained (vertex buffers)" : "immediate mode");
+            break;
+
+        // window glass opacity (re-records the scene)
+        case '+':
+        case '=':
+            glassAlpha = fminf(glassAlpha + 0.1f, 1.0f);
+            invalidateScene();
+            break;
+        case '-':
+        case '_':
+            glassAlpha = fmaxf(glassAlpha - 0.1f, 0.0f);
+            invalidateScene();
+            break;
+
         // reset position
         case 'r':
         case 'R':
@@ -48,6 +48,14 @@ public:
         this->setupMesh(); // Call class setupMesh() method
     }
 
+    // Constructor for pre-baked geometry (e.g. a mapped mesh cache). Uploads straight from the given
+    // pointers and keeps no CPU copy, so vertices/indices stay empty for meshes built this way.
+    Mesh(const Vertex* vertexData, GLuint vertexCount, const GLuint* indexData, GLuint indexCount, vector<Texture> textures)
+    {
+        this->textures = textures; // Set textures equal to input
+        this->setupMesh(vertexData, vertexCount, indexData, indexCount); // Upload directly from the given data
+    }
+
     // Render the mesh
     void Draw(Shader shader) 
     {
@@ -77,7 +85,7 @@ public:
 
         // Draw mesh
         glBindVertexArray(this->VAO); // Bind VAO
-        glDrawElements(GL_TRIANGLES, this->indices.size(), GL_UNSIGNED_INT, 0); // Draw GL_TRIANGLES
+        glDrawElements(GL_TRIANGLES, this->indexCount, GL_UNSIGNED_INT, 0); // Draw GL_TRIANGLES
         glBindVertexArray(0); // Bind 0
 
         // Always good practice to set everything back to defaults once configured.
@@ -91,11 +99,19 @@ public:
 private:
     /*  Render data  */
     GLuint VAO, VBO, EBO; // Initialize VAO, VBO, EBO
+    GLuint indexCount; // Number of indices uploaded to the EBO
 
     /*  Functions    */
-    // Initializes all the buffer objects/arrays
+    // Initializes all the buffer objects/arrays from the member vectors
     void setupMesh()
     {
+        this->setupMesh(this->vertices.data(), this->vertices.size(), this->indices.data(), this->indices.size()); // Upload member data
+    }
+
+    // Initializes all the buffer objects/arrays from raw vertex/index data
+    void setupMesh(const Vertex* vertexData, GLuint vertexCount, const GLuint* indexData, GLuint indexCount)
+    {
+        this->indexCount = indexCount; // Remember index count for Draw
         // Create buffers/arrays
         glGenVertexArrays(1, &this->VAO); // Create VAO array
         glGenBuffers(1, &this->VBO); // Create VBO buffer
@@ -107,10 +123,10 @@ private:
         // A great thing about structs is that their memory layout is sequential for all its items.
         // The effect is that we can simply pass a pointer to the struct and it translates perfectly to a glm::vec3/2 array which
         // again translates to 3/2 floats which translates to a byte array.
-        glBufferData(GL_ARRAY_BUFFER, this->vertices.size() * sizeof(Vertex), &this->vertices[0], GL_STATIC_DRAW);   // Set buffer data
+        glBufferData(GL_ARRAY_BUFFER, vertexCount * sizeof(Vertex), vertexData, GL_STATIC_DRAW);   // Set buffer data
 
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->EBO); // Bind EBO buffer
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, this->indices.size() * sizeof(GLuint), &this->indices[0], GL_STATIC_DRAW); // Set buffer data
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, indexCount * sizeof(GLuint), indexData, GL_STATIC_DRAW); // Set buffer data
 
         // Set the vertex attribute pointers
         // Vertex Positions
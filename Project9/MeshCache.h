@@ -0,0 +1,263 @@
+#pragma once
+// Std. Includes
+#include <string> // Include string
+#include <fstream> // Include fstream
+#include <iostream> // Include iostream
+#include <vector> // Include vector
+#include <cstdio> // Include cstdio for rename/remove
+#include <cstring> // Include cstring for memcmp/memcpy
+#include <cstdint> // Include fixed width integer types
+using namespace std; // Use namespace std
+// POSIX Includes
+#include <sys/mman.h> // mmap/munmap
+#include <sys/stat.h> // stat for source mtime/size
+#include <fcntl.h> // open
+#include <unistd.h> // close
+// GL Includes
+#include <GL/glew.h> // Contains all the necessery OpenGL includes
+
+#include "Mesh.h" // Include Mesh.h for Vertex
+
+// Binary mesh cache written next to a model (e.g. sphere.obj -> sphere.obj.meshcache).
+// It holds the final interleaved Vertex array, index buffer and texture list of every mesh so a warm
+// launch can map the file and hand it straight to glBufferData instead of running Assimp again.
+// Layout: MeshCacheHeader, source path, then per mesh: MeshCacheEntry, vertices, indices, texture records.
+// Strings are padded to 4 bytes so the vertex and index arrays that follow stay aligned inside the mapping.
+
+const char MESH_CACHE_MAGIC[8] = { 'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H' }; // File identifier
+const uint32_t MESH_CACHE_VERSION = 1; // Bump whenever the file layout or the Model processing changes
+
+struct MeshCacheHeader {
+	char magic[8]; // MESH_CACHE_MAGIC
+	uint32_t version; // MESH_CACHE_VERSION
+	uint32_t vertexSize; // sizeof(Vertex) when written, catches Vertex layout changes
+	uint32_t postProcessFlags; // Assimp post-process flags used for the cold load
+	uint32_t meshCount; // Number of meshes that follow
+	int64_t sourceMtime; // Source file modification time in nanoseconds
+	uint64_t sourceSize; // Source file size in bytes
+	uint32_t pathLength; // Length of the source path that follows the header
+	uint32_t reserved; // Keeps the header 8-byte aligned
+};
+
+struct MeshCacheEntry {
+	uint32_t vertexCount; // Number of Vertex structs that follow
+	uint32_t indexCount; // Number of GLuint indices after the vertices
+	uint32_t textureCount; // Number of texture records after the indices
+	uint32_t reserved; // Padding
+};
+
+// A texture record as stored in the cache (type is e.g. "texture_diffuse", path is relative to the model directory)
+struct CachedTexture {
+	string type; // Texture type name
+	string path; // Texture path from the material
+};
+
+// A mesh as seen through the mapping; the pointers stay valid while the MeshCacheFile is alive
+struct CachedMesh {
+	const Vertex* vertices; // Interleaved vertex data
+	GLuint vertexCount; // Number of vertices
+	const GLuint* indices; // Index data
+	GLuint indexCount; // Number of indices
+	vector<CachedTexture> textures; // Material textures
+};
+
+// Returns the cache path used for a source model
+inline string MeshCachePath(const string& sourcePath)
+{
+	return sourcePath + ".meshcache"; // Cache lives next to the source file
+}
+
+// Reads the modification time (ns) and size of the source file, false if it cannot be stat'ed
+inline bool MeshCacheSourceStamp(const string& sourcePath, int64_t& mtime, uint64_t& size)
+{
+	struct stat st; // Stat buffer
+	if (stat(sourcePath.c_str(), &st) != 0) // Source missing
+		return false;
+	mtime = (int64_t)st.st_mtim.tv_sec * 1000000000LL + (int64_t)st.st_mtim.tv_nsec; // Nanosecond mtime
+	size = (uint64_t)st.st_size; // File size
+	return true;
+}
+
+// Read-only memory mapping of a cache file. Validates the header against the source file on Open().
+class MeshCacheFile
+{
+public:
+	vector<CachedMesh> meshes; // Meshes found in the cache
+
+	MeshCacheFile() : data(nullptr), length(0) {}
+	~MeshCacheFile() { this->Close(); }
+	MeshCacheFile(const MeshCacheFile&) = delete; // Mapping is owned, no copies
+	MeshCacheFile& operator=(const MeshCacheFile&) = delete;
+
+	// Maps the cache for sourcePath; returns false when missing, stale, or built with different flags
+	bool Open(const string& sourcePath, GLuint postProcessFlags)
+	{
+		int64_t mtime; // Source modification time
+		uint64_t size; // Source size
+		if (!MeshCacheSourceStamp(sourcePath, mtime, size)) // No source -> nothing to validate against
+			return false;
+
+		int fd = open(MeshCachePath(sourcePath).c_str(), O_RDONLY); // Open cache
+		if (fd < 0) // No cache yet
+			return false;
+		struct stat st; // Cache stat
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(MeshCacheHeader)) { // Too small to be a cache
+			close(fd);
+			return false;
+		}
+		this->length = (size_t)st.st_size; // Mapping length
+		void* mapped = mmap(nullptr, this->length, PROT_READ, MAP_PRIVATE, fd, 0); // Map whole file
+		close(fd); // Mapping keeps the file alive
+		if (mapped == MAP_FAILED) {
+			this->length = 0;
+			return false;
+		}
+		this->data = (const unsigned char*)mapped; // Keep base pointer
+
+		if (!this->parse(sourcePath, postProcessFlags, mtime, size)) { // Stale or corrupt
+			this->Close();
+			return false;
+		}
+		return true;
+	}
+
+	// Releases the mapping
+	void Close()
+	{
+		if (this->data)
+			munmap((void*)this->data, this->length); // Unmap file
+		this->data = nullptr;
+		this->length = 0;
+		this->meshes.clear();
+	}
+
+private:
+	const unsigned char* data; // Mapped bytes
+	size_t length; // Mapped length
+
+	// Walks the mapped file and fills meshes, checking every read stays inside the mapping
+	bool parse(const string& sourcePath, GLuint postProcessFlags, int64_t mtime, uint64_t size)
+	{
+		size_t offset = 0; // Read cursor
+		const MeshCacheHeader* header = (const MeshCacheHeader*)this->data; // Header at start
+		offset += sizeof(MeshCacheHeader);
+		if (memcmp(header->magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) != 0 // Not a cache file
+			|| header->version != MESH_CACHE_VERSION // Older layout
+			|| header->vertexSize != sizeof(Vertex) // Vertex struct changed
+			|| header->postProcessFlags != postProcessFlags // Different Assimp processing
+			|| header->sourceMtime != mtime || header->sourceSize != size) // Source edited since bake
+			return false;
+
+		string storedPath; // Source path stored in the cache
+		if (!this->readString(offset, header->pathLength, storedPath) || storedPath != sourcePath)
+			return false;
+
+		for (uint32_t m = 0; m < header->meshCount; m++) // Iterate over meshes
+		{
+			if (offset + sizeof(MeshCacheEntry) > this->length)
+				return false;
+			const MeshCacheEntry* entry = (const MeshCacheEntry*)(this->data + offset); // Mesh entry
+			offset += sizeof(MeshCacheEntry);
+
+			CachedMesh mesh; // Mesh view
+			size_t vertexBytes = (size_t)entry->vertexCount * sizeof(Vertex); // Size of vertex block
+			size_t indexBytes = (size_t)entry->indexCount * sizeof(GLuint); // Size of index block
+			if (offset + vertexBytes + indexBytes > this->length)
+				return false;
+			mesh.vertices = (const Vertex*)(this->data + offset); // Vertices point into mapping
+			mesh.vertexCount = entry->vertexCount;
+			offset += vertexBytes;
+			mesh.indices = (const GLuint*)(this->data + offset); // Indices point into mapping
+			mesh.indexCount = entry->indexCount;
+			offset += indexBytes;
+
+			for (uint32_t t = 0; t < entry->textureCount; t++) // Iterate over texture records
+			{
+				if (offset + 2 * sizeof(uint32_t) > this->length)
+					return false;
+				uint32_t typeLength, pathLength; // String lengths
+				memcpy(&typeLength, this->data + offset, sizeof(uint32_t));
+				memcpy(&pathLength, this->data + offset + sizeof(uint32_t), sizeof(uint32_t));
+				offset += 2 * sizeof(uint32_t);
+				CachedTexture texture; // Texture record
+				if (!this->readString(offset, typeLength, texture.type) || !this->readString(offset, pathLength, texture.path))
+					return false;
+				mesh.textures.push_back(texture);
+			}
+			this->meshes.push_back(mesh); // Store view
+		}
+		return true;
+	}
+
+	// Reads a 4-byte padded string at offset and advances it
+	bool readString(size_t& offset, uint32_t stringLength, string& out)
+	{
+		size_t padded = (stringLength + 3u) & ~3u; // Strings are padded to 4 bytes
+		if (offset + padded > this->length)
+			return false;
+		out.assign((const char*)this->data + offset, stringLength);
+		offset += padded;
+		return true;
+	}
+};
+
+// Writes a 4-byte padded string
+inline void MeshCacheWriteString(ofstream& out, const string& value)
+{
+	static const char zeros[4] = { 0, 0, 0, 0 }; // Padding bytes
+	out.write(value.data(), value.size());
+	out.write(zeros, ((value.size() + 3u) & ~(size_t)3u) - value.size());
+}
+
+// Writes the cache for sourcePath from freshly processed meshes. Writes to a temp file and renames it so
+// a crash mid-write never leaves a truncated cache behind. Failures are reported but not fatal.
+inline bool WriteMeshCache(const string& sourcePath, GLuint postProcessFlags, const vector<Mesh>& meshes)
+{
+	MeshCacheHeader header; // File header
+	memset(&header, 0, sizeof(header));
+	if (!MeshCacheSourceStamp(sourcePath, header.sourceMtime, header.sourceSize))
+		return false;
+	memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+	header.version = MESH_CACHE_VERSION;
+	header.vertexSize = sizeof(Vertex);
+	header.postProcessFlags = postProcessFlags;
+	header.meshCount = (uint32_t)meshes.size();
+	header.pathLength = (uint32_t)sourcePath.size();
+
+	string cachePath = MeshCachePath(sourcePath); // Final location
+	string tempPath = cachePath + ".tmp"; // Written first, renamed on success
+	ofstream out(tempPath.c_str(), ios::binary | ios::trunc); // Open temp file
+	if (!out) {
+		cout << "ERROR::MESHCACHE::CANNOT_WRITE " << tempPath << endl;
+		return false;
+	}
+	out.write((const char*)&header, sizeof(header)); // Header
+	MeshCacheWriteString(out, sourcePath); // Source path
+	for (GLuint i = 0; i < meshes.size(); i++) // Iterate over meshes
+	{
+		const Mesh& mesh = meshes[i];
+		MeshCacheEntry entry; // Mesh entry
+		entry.vertexCount = (uint32_t)mesh.vertices.size();
+		entry.indexCount = (uint32_t)mesh.indices.size();
+		entry.textureCount = (uint32_t)mesh.textures.size();
+		entry.reserved = 0;
+		out.write((const char*)&entry, sizeof(entry));
+		out.write((const char*)mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex)); // Vertex block
+		out.write((const char*)mesh.indices.data(), mesh.indices.size() * sizeof(GLuint)); // Index block
+		for (GLuint t = 0; t < mesh.textures.size(); t++) // Texture records
+		{
+			string path = mesh.textures[t].path.C_Str(); // Material path
+			uint32_t lengths[2] = { (uint32_t)mesh.textures[t].type.size(), (uint32_t)path.size() };
+			out.write((const char*)lengths, sizeof(lengths));
+			MeshCacheWriteString(out, mesh.textures[t].type);
+			MeshCacheWriteString(out, path);
+		}
+	}
+	out.close(); // Flush
+	if (!out || rename(tempPath.c_str(), cachePath.c_str()) != 0) { // Publish atomically
+		cout << "ERROR::MESHCACHE::CANNOT_WRITE " << cachePath << endl;
+		remove(tempPath.c_str());
+		return false;
+	}
+	return true;
+}
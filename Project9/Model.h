@@ -17,6 +17,7 @@ using namespace std; // Use namespace std
 #include <assimp/postprocess.h> // Include assimp postprocess
 
 #include "Mesh.h" // Include Mesh.h
+#include "MeshCache.h" // Include binary mesh cache
 
 GLint TextureFromFile(const char* path, string directory); // Texture from file
 
@@ -24,8 +25,9 @@ class Model  // Provided in class
 {
 public:
 	/*  Functions   */
-	// Constructor, expects a filepath to a 3D model.
-	Model(GLchar* path) // Model constructor using path
+	// Constructor, expects a filepath to a 3D model. With useCache the processed meshes are read from / written to
+	// a binary cache next to the model (see MeshCache.h), so only the first launch after an edit runs Assimp.
+	Model(const GLchar* path, bool useCache = true) : useCache(useCache) // Model constructor using path
 	{
 		this->loadModel(path); // Load model with callback and path
 	}
@@ -41,25 +43,59 @@ private:
 	/*  Model Data  */
 	vector<Mesh> meshes; // Vector of meshes
 	string directory; // String for directory
+	bool useCache; // Read/write the binary mesh cache
 	
 	/*  Functions   */
 	// Loads a model with supported ASSIMP extensions from file and stores the resulting meshes in the meshes vector.
 	void loadModel(string path)
 	{
+		const GLuint postProcessFlags = aiProcess_Triangulate | aiProcess_FlipUVs; // Assimp processing, part of the cache key
+		// Retrieve the directory path of the filepath
+		this->directory = path.substr(0, path.find_last_of('/')); // Get directory
+
+		// Warm path: upload straight from the mapped cache
+		if(this->useCache && this->loadFromCache(path, postProcessFlags))
+			return;
+
 		// Read file via ASSIMP
 		Assimp::Importer importer; // Initialize importer
-		const aiScene* scene = importer.ReadFile(path, aiProcess_Triangulate | aiProcess_FlipUVs); // Read model
+		const aiScene* scene = importer.ReadFile(path, postProcessFlags); // Read model
 		// Check for errors
 		if(!scene || scene->mFlags == AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) // if is Not Zero
 		{
 			cout << "ERROR::ASSIMP:: " << importer.GetErrorString() << endl; // Write error message
 			return;
 		}
-		// Retrieve the directory path of the filepath
-		this->directory = path.substr(0, path.find_last_of('/')); // Get directory
 		
 		// Process ASSIMP's root node recursively
 		this->processNode(scene->mRootNode, scene); // Process nodes using callback
+
+		// Bake the processed meshes for the next launch
+		if(this->useCache)
+			WriteMeshCache(path, postProcessFlags, this->meshes); // Write cache next to the model
+	}
+
+	// Builds the meshes from a valid binary cache; returns false when the cache is missing or stale
+	bool loadFromCache(const string& path, GLuint postProcessFlags)
+	{
+		MeshCacheFile cache; // Mapped cache, unmapped when it goes out of scope
+		if(!cache.Open(path, postProcessFlags)) // Missing, stale or different flags
+			return false;
+		for(GLuint i = 0; i < cache.meshes.size(); i++) // Iterate over cached meshes
+		{
+			const CachedMesh& cached = cache.meshes[i]; // Cached mesh view
+			vector<Texture> textures; // Textures for this mesh
+			for(GLuint t = 0; t < cached.textures.size(); t++) // Reload material textures
+			{
+				Texture texture; // Initialize texture
+				texture.id = TextureFromFile(cached.textures[t].path.c_str(), this->directory); // Assign id
+				texture.type = cached.textures[t].type; // Assign type
+				texture.path = aiString(cached.textures[t].path); // Assign path
+				textures.push_back(texture); // Push back texture
+			}
+			this->meshes.push_back(Mesh(cached.vertices, cached.vertexCount, cached.indices, cached.indexCount, textures)); // Upload from mapping
+		}
+		return true;
 	}
 	
 	// Processes a node in a recursive fashion. Processes each individual mesh located at the node and repeats this process on its children nodes (if any).
@@ -4,13 +4,24 @@ layout (location = 1) in vec3 aNormal; // aNormal layout for loc 1
 
 out vec3 FragPos; // Returns FragPos
 out vec3 Normal; // Returns Normal
+flat out vec3 SquareColor; // Returns tile color
 
-uniform mat4 model; // Receives model uniform
 uniform mat4 view; // Receives view uniform
 uniform mat4 projection; // Receives projection uniform
 
+// The whole board is one instanced draw: gl_InstanceID picks the tile, so no per-tile uniforms or buffers
+uniform int boardColumns; // Tiles per row
+uniform vec3 boardOrigin; // World position of tile (0, 0)
+uniform vec3 tileScale; // Scale applied to the unit cube to make a tile
+uniform vec3 evenColor; // Color when row + column is even
+uniform vec3 oddColor; // Color when row + column is odd
+
 void main() {
-    gl_Position = projection * view * vec4(aPos, 1.0f);  // Implements transformations - multiplies transformation vectors
-    FragPos = vec3(model * vec4(aPos, 1.0));  // Sets fragment position
-    Normal = mat3(transpose(inverse(model))) * aNormal;  // Normalizes
+    int column = gl_InstanceID % boardColumns; // Tile column
+    int row = gl_InstanceID / boardColumns; // Tile row
+    vec3 worldPos = aPos * tileScale + boardOrigin + vec3(column, 0.0, row); // Scale then translate to the tile
+    gl_Position = projection * view * vec4(worldPos, 1.0f);  // Implements transformations - multiplies transformation vectors
+    FragPos = aPos;  // Lighting input stays the untransformed cube position (the per-tile loop drew with an identity model)
+    Normal = aNormal;  // Identity model: normal unchanged
+    SquareColor = ((row + column) % 2 == 0) ? evenColor : oddColor; // Alternate tile colors
 }
\ No newline at end of file
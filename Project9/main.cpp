@@ -21,6 +21,7 @@
 #include "Model.h" // Include Model class
 
 const GLuint WIDTH = 800, HEIGHT = 600; // Global variables for width and height of window
+const GLint BOARD_COLUMNS = 8, BOARD_ROWS = 8; // Checkerboard size in tiles (drawn instanced, so 256x256 costs the same CPU time)
 
 // Function prototypes
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mode); // key_callback method
@@ -66,6 +67,14 @@ int main() {
     Shader cylinderShader("cylinder.vs", "cylinder.frag"); // Create shader for cylinder object
     Shader sphereShader("sphere.vs", "sphere.frag"); // Create shader for sphere object
 
+    // Checkerboard layout never changes, so set it once
+    checkerboardShader.Use(); // Use checkerboard shader
+    glUniform1i(glGetUniformLocation(checkerboardShader.Program, "boardColumns"), BOARD_COLUMNS); // Tiles per row
+    glUniform3f(glGetUniformLocation(checkerboardShader.Program, "boardOrigin"), -4.0f, -0.5f, -9.0f); // Corner tile position
+    glUniform3f(glGetUniformLocation(checkerboardShader.Program, "tileScale"), 1.0f, 0.1f, 1.0f); // Scale squares to be like tiles
+    glUniform3f(glGetUniformLocation(checkerboardShader.Program, "evenColor"), 1.0f, 0.0f, 1.0f); // Purple
+    glUniform3f(glGetUniformLocation(checkerboardShader.Program, "oddColor"), 1.0f, 1.0f, 1.0f); // White
+
     // Models for Cylinder and Sphere
     Model cylinderModel("cylinder.obj"); // Defines model for cylinder using obj
     Model sphereModel("sphere.obj"); // Define model for sphere using obj
@@ -169,7 +178,6 @@ int main() {
         // CHECKERBOARD
         checkerboardShader.Use(); // Use checkerboard shader
 
-        GLint squareColorLoc = glGetUniformLocation(checkerboardShader.Program, "squareColor"); // Retrieve uniform location for squareColor
         GLint lightColorLoc = glGetUniformLocation(checkerboardShader.Program, "lightColor"); // Retrieve uniform location for lightColor
         GLint lightPosLoc = glGetUniformLocation(checkerboardShader.Program, "lightPos"); // Retrieve uniform location for lightPos
         GLint viewPosLoc = glGetUniformLocation(checkerboardShader.Program, "viewPos"); // Retrieve uniform location for viewPos
@@ -178,31 +186,14 @@ int main() {
         glUniform3f(lightPosLoc, lightPos.x, lightPos.y, lightPos.z); // Pass light position to lightPosLoc uniform
         glUniform3f(viewPosLoc, camera.Position.x, camera.Position.y, camera.Position.z); // Pass camera position to viewPosLoc uniform
 
-        glm::mat4 view_square = view; // Create mat4 view_square equal to view generic defined above
-
-        GLint modelLoc = glGetUniformLocation(checkerboardShader.Program, "model"); // Retrieve model uniform location
         GLint viewLoc = glGetUniformLocation(checkerboardShader.Program, "view"); // Retrieve view uniform location
         GLint projLoc = glGetUniformLocation(checkerboardShader.Program, "projection"); // Retrieve projection uniform location
+        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view)); // Pass view to uniform
+        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection)); // Pass projection to uniform
 
-        for (int i = 0; i < 8; i++) { // For 8 rows
-            for (int j = 0; j < 8; j++) { // For 8 columns
-                if ((i+j) % 2 == 0) { // Check if i+j is odd or even for color purposes
-                    glUniform3f(squareColorLoc, 1.0f, 0.0f, 1.0f); // If even square color is purple --> pass purple to uniform
-                } else {
-                    glUniform3f(squareColorLoc, 1.0f, 1.0f, 1.0f); // If even square color is white --> pas white to uniform
-                }
-                view_square = glm::translate(view_square, glm::vec3(j-4.0f, -0.5f, i-9.0f)); // Translate square to posiiton [setting x and z for grid]
-                view_square = glm::scale(view_square, glm::vec3(1.0f, 0.1f, 1.0f)); // Scale squares to be like tiles
-                glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model)); // Pass model to uniform
-                glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view_square)); // Pass view_square to uniform
-                glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection)); // Pass projection to uniform
-                // Draw square
-                glBindVertexArray(VAO); // Bind vertex arrays
-                glDrawArrays(GL_TRIANGLES, 0, 36); // Draw arrays for cube
-                view_square = view; // Reset view_square to original view identity [i.e. Translations are independent]
-                
-            }
-        }
+        // Draw the whole board in one instanced call (tile position and color come from gl_InstanceID)
+        glBindVertexArray(VAO); // Bind vertex arrays
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 36, BOARD_COLUMNS * BOARD_ROWS); // Draw every tile
 
         // CUBE
         cubeShader.Use(); // Activate cube shader
@@ -223,7 +214,7 @@ int main() {
         view_cube = glm::translate(view_cube, glm::vec3(0.0f, 0.0f, -5.0f)); // Translate cube back
 
         // Get uniform location
-        modelLoc = glGetUniformLocation(cubeShader.Program, "model"); // Reset modelLoc using cubeShader
+        GLint modelLoc = glGetUniformLocation(cubeShader.Program, "model"); // Retrieve modelLoc using cubeShader
         viewLoc = glGetUniformLocation(cubeShader.Program, "view"); // Reset viewLoc using cubeShader
         projLoc = glGetUniformLocation(cubeShader.Program, "projection"); // Reset projLoc using cubeShader
         // Pass locations to shader
@@ -366,6 +366,16 @@ int main() {
     delete[] vertices;
     delete[] indices;
     
+    // LOOK UP UNIFORM LOCATIONS ONCE
+    // Locations never change after linking, so asking the driver by string every frame is wasted work
+    GLint modelLoc = glGetUniformLocation(shaderProgram, "model");
+    GLint viewLoc = glGetUniformLocation(shaderProgram, "view");
+    GLint projectionLoc = glGetUniformLocation(shaderProgram, "projection");
+    GLint lightPosLoc = glGetUniformLocation(shaderProgram, "lightPos");
+    GLint viewPosLoc = glGetUniformLocation(shaderProgram, "viewPos");
+    GLint lightColorLoc = glGetUniformLocation(shaderProgram, "lightColor");
+    GLint objectColorLoc = glGetUniformLocation(shaderProgram, "objectColor");
+    
     /* ========================================================================
        RENDER LOOP
        
@@ -421,9 +431,9 @@ int main() {
         
         // UPLOAD MATRICES TO SHADER
         // Uniforms are variables that stay constant for all vertices/fragments in a draw call
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "model"), 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "view"), 1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(shaderProgram, "projection"), 1, GL_FALSE, glm::value_ptr(projection));
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(projectionLoc, 1, GL_FALSE, glm::value_ptr(projection));
         
         // LIGHTING PROPERTIES
         glm::vec3 lightPos(3.0f, 3.0f, 3.0f);       // Light position (upper-right-front)
@@ -432,10 +442,10 @@ int main() {
         glm::vec3 objectColor(0.6f, 0.6f, 0.65f);   // Grey curtain
         
         // Upload lighting data to shader
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightPos"), 1, glm::value_ptr(lightPos));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "viewPos"), 1, glm::value_ptr(viewPos));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "lightColor"), 1, glm::value_ptr(lightColor));
-        glUniform3fv(glGetUniformLocation(shaderProgram, "objectColor"), 1, glm::value_ptr(objectColor));
+        glUniform3fv(lightPosLoc, 1, glm::value_ptr(lightPos));
+        glUniform3fv(viewPosLoc, 1, glm::value_ptr(viewPos));
+        glUniform3fv(lightColorLoc, 1, glm::value_ptr(lightColor));
+        glUniform3fv(objectColorLoc, 1, glm::value_ptr(objectColor));
         
         // DRAW THE CURTAIN
         glBindVertexArray(VAO);  // Use our vertex configuration